@@ -17,6 +17,8 @@
 // Definitions od I2C pins -> ADXL345 communication
 #define I2C_PIN_SCL (gpio_num_t)7
 #define I2C_PIN_SDA (gpio_num_t)6
+#define I2C_CH_PORT I2C_NUM_0
+#define ACCEL_PIN_INT1 (gpio_num_t)5 // FIFO watermark interrupt
 
 // Definition of buttons pins -> system controll
 #define BUTTON_PIN_1 (gpio_num_t)3
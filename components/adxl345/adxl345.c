@@ -0,0 +1,65 @@
+#include "adxl345.h"
+#include "adxl345_config.h"
+#include "adxl345_regs.h"
+#include "adxl345_transport.h"
+#include <assert.h>
+#include <stdint.h>
+
+typedef struct {
+  uint8_t reg;
+  uint8_t value;
+} adxl345_reg_write_t;
+
+bool adxl345_init(adxl345_handle_t dev, uint8_t watermark) {
+  assert(watermark > 0 && watermark <= ADXL345_FIFO_SAMPLES_MASK);
+  uint8_t devid = 0;
+  adxl345_transport_read(dev, ADXL345_REG_DEVID, &devid, 1);
+  if(ADXL345_DEVID_VAL != devid) {
+    return false;
+  }
+  // Configured in standby, bypass mode clears the FIFO before the stream mode starts
+  const adxl345_reg_write_t init_seq[] = {
+      {ADXL345_REG_POWER_CTL, 0},
+      {ADXL345_REG_INT_ENABLE, 0},
+      {ADXL345_REG_BW_RATE, ADXL345_BW_RATE_100HZ},
+      {ADXL345_REG_DATA_FORMAT, ADXL345_DATA_FORMAT_FULL_RES | ADXL345_DATA_FORMAT_RANGE_4G},
+      {ADXL345_REG_FIFO_CTL, ADXL345_FIFO_MODE_BYPASS},
+      {ADXL345_REG_FIFO_CTL, (uint8_t)(ADXL345_FIFO_MODE_STREAM | watermark)},
+      {ADXL345_REG_INT_MAP, 0},
+      {ADXL345_REG_INT_ENABLE, ADXL345_INT_WATERMARK},
+      {ADXL345_REG_POWER_CTL, ADXL345_POWER_CTL_MEASURE},
+  };
+  for(size_t i = 0; i < sizeof(init_seq) / sizeof(init_seq[0]); i++) {
+    adxl345_transport_write(dev, init_seq[i].reg, init_seq[i].value);
+  }
+  return true;
+}
+
+uint8_t adxl345_fifo_entries(adxl345_handle_t dev) {
+  uint8_t status = 0;
+  adxl345_transport_read(dev, ADXL345_REG_FIFO_STATUS, &status, 1);
+  return status & ADXL345_FIFO_ENTRIES_MASK;
+}
+
+size_t adxl345_read_fifo(adxl345_handle_t dev, adxl345_sample_t *samples, size_t max_samples) {
+  size_t entries = adxl345_fifo_entries(dev);
+  if(entries > ADXL345_FIFO_SIZE) {
+    entries = ADXL345_FIFO_SIZE;
+  }
+  if(entries > max_samples) {
+    entries = max_samples;
+  }
+  if(0 == entries) {
+    return 0;
+  }
+  uint8_t buf[ADXL345_FIFO_SIZE * ADXL345_SAMPLE_BYTES];
+  adxl345_transport_read_fifo(dev, buf, entries);
+  // Data registers are little endian, X0 is the lower byte of X
+  for(size_t i = 0; i < entries; i++) {
+    const uint8_t *entry = &buf[i * ADXL345_SAMPLE_BYTES];
+    samples[i].x = (int16_t)(entry[0] | (entry[1] << 8));
+    samples[i].y = (int16_t)(entry[2] | (entry[3] << 8));
+    samples[i].z = (int16_t)(entry[4] | (entry[5] << 8));
+  }
+  return entries;
+}
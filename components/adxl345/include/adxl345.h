@@ -0,0 +1,63 @@
+#ifndef ADXL345_H
+#define ADXL345_H
+
+#include "adxl345_config.h"
+#include "adxl345_port.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Single accelerometer sample, raw values in ADXL345_LSB_PER_G units;
+ */
+typedef struct {
+  int16_t x;
+  int16_t y;
+  int16_t z;
+} adxl345_sample_t;
+
+/**
+ * @brief Initialization of the accelerometer in FIFO stream mode.
+ *
+ * The sensor samples at ADXL345_SAMPLE_RATE_HZ in full resolution, the FIFO keeps the last 32 samples and the
+ * watermark interrupt is mapped to the INT1 pin. Samples are read in batches with adxl345_read_fifo().
+ *
+ * @param dev sensor handle
+ * @param watermark number of FIFO entries that raises the watermark interrupt -> 1 - 31
+ *
+ * @return true on success; false if the device ID doesn't match
+ */
+bool adxl345_init(adxl345_handle_t dev, uint8_t watermark);
+
+/**
+ * @brief Reads the number of samples waiting in the FIFO.
+ *
+ * @param dev sensor handle
+ *
+ * @return number of entries -> 0 - ADXL345_FIFO_SIZE
+ */
+uint8_t adxl345_fifo_entries(adxl345_handle_t dev);
+
+/**
+ * @brief Drains the FIFO, oldest samples first.
+ *
+ * Reads the FIFO status once and then all waiting entries in one batch. Reading the FIFO below the watermark clears
+ * the watermark interrupt.
+ *
+ * @param dev sensor handle
+ * @param samples destination of the samples
+ * @param max_samples capacity of the destination, ADXL345_FIFO_SIZE drains the whole FIFO
+ *
+ * @return number of read samples
+ */
+size_t adxl345_read_fifo(adxl345_handle_t dev, adxl345_sample_t *samples, size_t max_samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADXL345_H
@@ -0,0 +1,26 @@
+#ifndef ADXL345_CONFIG_H
+#define ADXL345_CONFIG_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 7-bit address with the ALT ADDRESS pin grounded
+enum { ADXL345_I2C_ADDR = 0x53 };
+
+// FIFO depth and size of one entry (X, Y, Z as little endian int16_t)
+enum { ADXL345_FIFO_SIZE = 32, ADXL345_SAMPLE_BYTES = 6 };
+
+// At 100 Hz a watermark of 25 samples wakes the CPU every 250 ms and leaves 70 ms until the FIFO overruns
+enum { ADXL345_SAMPLE_RATE_HZ = 100, ADXL345_WATERMARK = 25 };
+
+// Full resolution at +-4 g
+enum { ADXL345_LSB_PER_G = 256 };
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADXL345_CONFIG_H
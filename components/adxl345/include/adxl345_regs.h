@@ -0,0 +1,49 @@
+#ifndef ADXL345_REGS_H
+#define ADXL345_REGS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ---------------------------- Register map ----------------------------
+#define ADXL345_REG_DEVID ((uint8_t)0x00)       // Device ID, reads ADXL345_DEVID_VAL;
+#define ADXL345_REG_BW_RATE ((uint8_t)0x2C)     // Output data rate and low power mode;
+#define ADXL345_REG_POWER_CTL ((uint8_t)0x2D)   // Standby or measurement mode;
+#define ADXL345_REG_INT_ENABLE ((uint8_t)0x2E)  // Interrupt enable, bits of ADXL345_INT_*;
+#define ADXL345_REG_INT_MAP ((uint8_t)0x2F)     // Interrupt pin mapping, 0 -> INT1, 1 -> INT2;
+#define ADXL345_REG_INT_SOURCE ((uint8_t)0x30)  // Interrupt source, read only;
+#define ADXL345_REG_DATA_FORMAT ((uint8_t)0x31) // Range, resolution and interrupt polarity;
+#define ADXL345_REG_DATAX0 ((uint8_t)0x32)      // First of 6 data registers X0, X1, Y0, Y1, Z0, Z1 -> reading them pops a FIFO entry;
+#define ADXL345_REG_FIFO_CTL ((uint8_t)0x38)    // FIFO mode and number of samples of the watermark;
+#define ADXL345_REG_FIFO_STATUS ((uint8_t)0x39) // Number of entries in the FIFO, read only;
+
+// ---------------------------- Register values ----------------------------
+#define ADXL345_DEVID_VAL ((uint8_t)0xE5)
+
+#define ADXL345_BW_RATE_25HZ ((uint8_t)0x08)  // Output data rate 25 Hz;
+#define ADXL345_BW_RATE_50HZ ((uint8_t)0x09)  // Output data rate 50 Hz;
+#define ADXL345_BW_RATE_100HZ ((uint8_t)0x0A) // Output data rate 100 Hz;
+
+#define ADXL345_POWER_CTL_MEASURE ((uint8_t)0x08) // Measurement mode, 0 -> standby;
+
+#define ADXL345_INT_DATA_READY ((uint8_t)0x80) // New data in the data registers;
+#define ADXL345_INT_WATERMARK ((uint8_t)0x02)  // FIFO entries reached the samples of FIFO_CTL;
+#define ADXL345_INT_OVERRUN ((uint8_t)0x01)    // Unread data were replaced by new samples;
+
+#define ADXL345_DATA_FORMAT_FULL_RES ((uint8_t)0x08) // Full resolution, 3.9 mg/LSB in every range;
+#define ADXL345_DATA_FORMAT_RANGE_2G ((uint8_t)0x00) // +-2 g;
+#define ADXL345_DATA_FORMAT_RANGE_4G ((uint8_t)0x01) // +-4 g;
+#define ADXL345_DATA_FORMAT_RANGE_8G ((uint8_t)0x02) // +-8 g;
+
+#define ADXL345_FIFO_MODE_BYPASS ((uint8_t)0x00)  // FIFO is bypassed and cleared;
+#define ADXL345_FIFO_MODE_FIFO ((uint8_t)0x40)    // FIFO stops collecting when full;
+#define ADXL345_FIFO_MODE_STREAM ((uint8_t)0x80)  // FIFO holds the last 32 samples, the oldest are replaced when full;
+#define ADXL345_FIFO_MODE_MASK ((uint8_t)0xC0)    // Mode bits of FIFO_CTL;
+#define ADXL345_FIFO_SAMPLES_MASK ((uint8_t)0x1F) // Watermark bits of FIFO_CTL -> 0x00 - 0x1F;
+#define ADXL345_FIFO_ENTRIES_MASK ((uint8_t)0x3F) // Entries bits of FIFO_STATUS -> 0x00 - 0x20;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADXL345_REGS_H
@@ -0,0 +1,54 @@
+#ifndef ADXL345_TRANSPORT_H
+#define ADXL345_TRANSPORT_H
+
+#include "adxl345_port.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sensor transport used by the driver core. Every port implements these functions:
+// port/esp  - I2C master;
+// port/host - simulated ADXL345 with its FIFO for tests and benchmarks on PC.
+
+/**
+ * @brief Writes a single register.
+ *
+ * @param dev sensor handle
+ * @param reg register address
+ * @param value register value
+ *
+ * @return void
+ */
+void adxl345_transport_write(adxl345_handle_t dev, uint8_t reg, uint8_t value);
+
+/**
+ * @brief Reads consecutive registers in a single multi-byte read.
+ *
+ * @param dev sensor handle
+ * @param reg address of the first register
+ * @param buf destination of the register values
+ * @param len number of registers
+ *
+ * @return void
+ */
+void adxl345_transport_read(adxl345_handle_t dev, uint8_t reg, uint8_t *buf, size_t len);
+
+/**
+ * @brief Reads FIFO entries, every entry is a multi-byte read of the 6 data registers from DATAX0.
+ *
+ * @param dev sensor handle
+ * @param buf destination of entries * ADXL345_SAMPLE_BYTES bytes
+ * @param entries number of entries, at most ADXL345_FIFO_SIZE
+ *
+ * @return void
+ */
+void adxl345_transport_read_fifo(adxl345_handle_t dev, uint8_t *buf, size_t entries);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADXL345_TRANSPORT_H
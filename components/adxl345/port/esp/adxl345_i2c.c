@@ -0,0 +1,63 @@
+#include "adxl345.h"
+#include "adxl345_config.h"
+#include "adxl345_regs.h"
+#include "adxl345_transport.h"
+#include "driver/gpio.h"
+#include "driver/i2c_master.h"
+#include "esp_err.h"
+#include <assert.h>
+#include <stddef.h>
+
+// Interrupt state
+static adxl345_watermark_cb_t adxl345_watermark_cb = NULL;
+static void *adxl345_watermark_arg = NULL;
+
+static void adxl345_int1_isr(void *arg) { adxl345_watermark_cb(adxl345_watermark_arg); }
+
+void adxl345_transport_write(adxl345_handle_t dev, uint8_t reg, uint8_t value) {
+  const uint8_t buf[] = {reg, value};
+  esp_err_t ret = i2c_master_transmit(dev.i2c, buf, sizeof(buf), ADXL345_I2C_TIMEOUT_MS);
+  ESP_ERROR_CHECK(ret);
+}
+
+void adxl345_transport_read(adxl345_handle_t dev, uint8_t reg, uint8_t *buf, size_t len) {
+  // Register address is written and the values are read after a repeated start, the address auto-increments
+  esp_err_t ret = i2c_master_transmit_receive(dev.i2c, &reg, 1, buf, len, ADXL345_I2C_TIMEOUT_MS);
+  ESP_ERROR_CHECK(ret);
+}
+
+void adxl345_transport_read_fifo(adxl345_handle_t dev, uint8_t *buf, size_t entries) {
+  // The sensor pops one FIFO entry per read of the data registers, a longer burst would continue with FIFO_CTL instead
+  // of the next entry. Entries are read back to back in one call, the address phase of each read keeps the 5 us gap
+  // the FIFO needs to pop the entry.
+  const uint8_t reg = ADXL345_REG_DATAX0;
+  for(size_t i = 0; i < entries; i++) {
+    esp_err_t ret = i2c_master_transmit_receive(dev.i2c, &reg, 1, &buf[i * ADXL345_SAMPLE_BYTES], ADXL345_SAMPLE_BYTES, ADXL345_I2C_TIMEOUT_MS);
+    ESP_ERROR_CHECK(ret);
+  }
+}
+
+void adxl345_int_start(adxl345_handle_t dev, adxl345_watermark_cb_t watermark_cb, void *arg) {
+  assert(NULL != watermark_cb);
+  adxl345_watermark_cb = watermark_cb;
+  adxl345_watermark_arg = arg;
+
+  gpio_config_t io_conf = {};
+  io_conf.pin_bit_mask = 1ULL << dev.int1;
+  io_conf.mode = GPIO_MODE_INPUT;
+  io_conf.intr_type = GPIO_INTR_POSEDGE;
+  esp_err_t ret = gpio_config(&io_conf);
+  ESP_ERROR_CHECK(ret);
+
+  // The service may be installed by another driver already
+  ret = gpio_install_isr_service(0);
+  if(ESP_ERR_INVALID_STATE != ret) {
+    ESP_ERROR_CHECK(ret);
+  }
+  ret = gpio_isr_handler_add(dev.int1, adxl345_int1_isr, NULL);
+  ESP_ERROR_CHECK(ret);
+
+  // Samples collected before the interrupt was enabled would keep the line high without an edge
+  adxl345_sample_t samples[ADXL345_FIFO_SIZE];
+  adxl345_read_fifo(dev, samples, ADXL345_FIFO_SIZE);
+}
@@ -0,0 +1,53 @@
+#ifndef ADXL345_PORT_H
+#define ADXL345_PORT_H
+
+#include "driver/gpio.h"
+#include "driver/i2c_master.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ESP-IDF port of the sensor transport: I2C master and the INT1 GPIO
+
+enum { ADXL345_I2C_CLOCK_HZ = 400 * 1000, ADXL345_I2C_TIMEOUT_MS = 10 };
+
+// ---------------------------------------------------------------------------------
+
+/**
+ * @brief Struct that stores the I2C device handle and the interrupt pin of the sensor
+ */
+typedef struct {
+  i2c_master_dev_handle_t i2c;
+  gpio_num_t int1; // INT1 pin, the watermark interrupt is mapped to it
+} adxl345_handle_t;
+
+/**
+ * @brief Callback called from the GPIO interrupt when the FIFO reaches the watermark;
+ */
+typedef void (*adxl345_watermark_cb_t)(void *arg);
+
+/**
+ * @brief Starts the watermark interrupt.
+ *
+ * Configures the INT1 pin as an input with a rising edge interrupt. The callback runs in the ISR, it should only wake
+ * the task that drains the FIFO with adxl345_read_fifo(). The FIFO is drained once here, so the interrupt line is low
+ * and the next watermark makes an edge.
+ *
+ * @param dev sensor handle
+ * @param watermark_cb callback called from the GPIO interrupt
+ * @param arg argument passed to the callback
+ *
+ * @return void
+ *
+ * @note I2C device has to be added with ADXL345_I2C_ADDR and at most ADXL345_I2C_CLOCK_HZ, the GPIO ISR service is
+ *       installed if it isn't yet.
+ */
+void adxl345_int_start(adxl345_handle_t dev, adxl345_watermark_cb_t watermark_cb, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADXL345_PORT_H
@@ -0,0 +1,123 @@
+#include "adxl345_config.h"
+#include "adxl345_port.h"
+#include "adxl345_regs.h"
+#include "adxl345_transport.h"
+#include <string.h>
+
+// Power-on value of the BW_RATE register
+enum { ADXL345_SIM_RESET_BW_RATE = 0x0A };
+
+static bool adxl345_sim_is_streaming(const adxl345_sim_t *sim) {
+  return ADXL345_FIFO_MODE_BYPASS != (sim->regs[ADXL345_REG_FIFO_CTL] & ADXL345_FIFO_MODE_MASK);
+}
+
+static uint8_t adxl345_sim_int_source(const adxl345_sim_t *sim) {
+  uint8_t source = sim->regs[ADXL345_REG_INT_SOURCE];
+  uint8_t watermark = sim->regs[ADXL345_REG_FIFO_CTL] & ADXL345_FIFO_SAMPLES_MASK;
+  if(adxl345_sim_is_streaming(sim) && sim->fifo_entries >= watermark) {
+    source |= ADXL345_INT_WATERMARK;
+  }
+  return source;
+}
+
+// Reading the data registers pops the oldest entry into them, in bypass mode they hold the last sample
+static void adxl345_sim_pop(adxl345_sim_t *sim) {
+  if(0 == sim->fifo_entries) {
+    return;
+  }
+  memcpy(sim->data, sim->fifo[sim->fifo_head], sizeof(sim->data));
+  sim->fifo_head = (sim->fifo_head + 1) % ADXL345_FIFO_SIZE;
+  sim->fifo_entries--;
+  sim->regs[ADXL345_REG_INT_SOURCE] &= (uint8_t)~ADXL345_INT_OVERRUN;
+}
+
+static uint8_t adxl345_sim_read_reg(adxl345_sim_t *sim, uint8_t reg) {
+  switch(reg) {
+  case ADXL345_REG_DEVID:
+    return sim->devid;
+  case ADXL345_REG_INT_SOURCE:
+    return adxl345_sim_int_source(sim);
+  case ADXL345_REG_FIFO_STATUS:
+    return sim->fifo_entries;
+  default:
+    break;
+  }
+  if(reg >= ADXL345_REG_DATAX0 && reg < ADXL345_REG_DATAX0 + ADXL345_SAMPLE_BYTES) {
+    uint16_t value = (uint16_t)sim->data[(reg - ADXL345_REG_DATAX0) / 2];
+    return (0 == (reg - ADXL345_REG_DATAX0) % 2) ? (uint8_t)(value & 0xFF) : (uint8_t)(value >> 8);
+  }
+  return (reg < ADXL345_SIM_REG_NUM) ? sim->regs[reg] : 0;
+}
+
+void adxl345_sim_init(adxl345_sim_t *sim) {
+  memset(sim, 0, sizeof(*sim));
+  sim->devid = ADXL345_DEVID_VAL;
+  sim->regs[ADXL345_REG_BW_RATE] = ADXL345_SIM_RESET_BW_RATE;
+}
+
+void adxl345_sim_reset_stats(adxl345_sim_t *sim) {
+  sim->overruns = 0;
+  sim->transfers = 0;
+  sim->bytes_read = 0;
+}
+
+void adxl345_sim_push(adxl345_sim_t *sim, int16_t x, int16_t y, int16_t z) {
+  if(0 == (sim->regs[ADXL345_REG_POWER_CTL] & ADXL345_POWER_CTL_MEASURE)) {
+    return;
+  }
+  if(!adxl345_sim_is_streaming(sim)) {
+    sim->data[0] = x;
+    sim->data[1] = y;
+    sim->data[2] = z;
+    return;
+  }
+  if(ADXL345_FIFO_SIZE == sim->fifo_entries) {
+    // Stream mode keeps the newest samples
+    sim->fifo_head = (sim->fifo_head + 1) % ADXL345_FIFO_SIZE;
+    sim->fifo_entries--;
+    sim->overruns++;
+    sim->regs[ADXL345_REG_INT_SOURCE] |= ADXL345_INT_OVERRUN;
+  }
+  int16_t *entry = sim->fifo[(sim->fifo_head + sim->fifo_entries) % ADXL345_FIFO_SIZE];
+  entry[0] = x;
+  entry[1] = y;
+  entry[2] = z;
+  sim->fifo_entries++;
+}
+
+bool adxl345_sim_int1(const adxl345_sim_t *sim) {
+  uint8_t active = adxl345_sim_int_source(sim) & sim->regs[ADXL345_REG_INT_ENABLE];
+  return 0 != (active & (uint8_t)~sim->regs[ADXL345_REG_INT_MAP]);
+}
+
+void adxl345_transport_write(adxl345_handle_t dev, uint8_t reg, uint8_t value) {
+  adxl345_sim_t *sim = dev.sim;
+  sim->transfers++;
+  if(reg >= ADXL345_SIM_REG_NUM) {
+    return;
+  }
+  sim->regs[reg] = value;
+  if(ADXL345_REG_FIFO_CTL == reg && !adxl345_sim_is_streaming(sim)) {
+    // Bypass mode clears the FIFO
+    sim->fifo_head = 0;
+    sim->fifo_entries = 0;
+  }
+}
+
+void adxl345_transport_read(adxl345_handle_t dev, uint8_t reg, uint8_t *buf, size_t len) {
+  adxl345_sim_t *sim = dev.sim;
+  sim->transfers++;
+  sim->bytes_read += len;
+  if(ADXL345_REG_DATAX0 == reg) {
+    adxl345_sim_pop(sim);
+  }
+  for(size_t i = 0; i < len; i++) {
+    buf[i] = adxl345_sim_read_reg(sim, (uint8_t)(reg + i));
+  }
+}
+
+void adxl345_transport_read_fifo(adxl345_handle_t dev, uint8_t *buf, size_t entries) {
+  for(size_t i = 0; i < entries; i++) {
+    adxl345_transport_read(dev, ADXL345_REG_DATAX0, &buf[i * ADXL345_SAMPLE_BYTES], ADXL345_SAMPLE_BYTES);
+  }
+}
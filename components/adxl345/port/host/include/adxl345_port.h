@@ -0,0 +1,87 @@
+#ifndef ADXL345_PORT_H
+#define ADXL345_PORT_H
+
+#include "adxl345_config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Host port of the sensor transport: register reads and writes are decoded by a simulated ADXL345 with its FIFO, so
+// the driver and the step detection can be tested and benchmarked on PC.
+
+enum { ADXL345_SIM_REG_NUM = 0x3A }; // Registers 0x00 - 0x39
+
+// ---------------------------------------------------------------------------------
+
+/**
+ * @brief Simulated ADXL345: registers, FIFO and transfer statistics;
+ */
+typedef struct {
+  uint8_t regs[ADXL345_SIM_REG_NUM];  // Register values, data and status registers are computed
+  int16_t fifo[ADXL345_FIFO_SIZE][3]; // FIFO entries X, Y, Z
+  uint8_t fifo_head;                  // Index of the oldest entry
+  uint8_t fifo_entries;               // Number of entries
+  int16_t data[3];                    // Data registers, the last popped or bypassed sample
+  uint8_t devid;                      // Value of the DEVID register
+  uint32_t overruns;                  // Number of samples lost in the stream mode
+  uint32_t transfers;                 // Number of I2C transactions
+  uint32_t bytes_read;                // Number of register bytes read
+} adxl345_sim_t;
+
+/**
+ * @brief Sensor handle of the host port, points to the simulated sensor
+ */
+typedef struct {
+  adxl345_sim_t *sim;
+} adxl345_handle_t;
+
+/**
+ * @brief Initializes the simulated sensor to its power-on state and clears the statistics.
+ *
+ * @param sim simulated sensor
+ *
+ * @return void
+ */
+void adxl345_sim_init(adxl345_sim_t *sim);
+
+/**
+ * @brief Clears the transfer statistics of the simulated sensor.
+ *
+ * @param sim simulated sensor
+ *
+ * @return void
+ */
+void adxl345_sim_reset_stats(adxl345_sim_t *sim);
+
+/**
+ * @brief Feeds a sample measured by the sensor, called at the output data rate.
+ *
+ * In standby the sample is dropped. In stream mode a full FIFO drops its oldest entry and sets the overrun interrupt.
+ *
+ * @param sim simulated sensor
+ * @param x x axis in ADXL345_LSB_PER_G units
+ * @param y y axis
+ * @param z z axis
+ *
+ * @return void
+ */
+void adxl345_sim_push(adxl345_sim_t *sim, int16_t x, int16_t y, int16_t z);
+
+/**
+ * @brief Gets the level of the INT1 pin.
+ *
+ * @param sim simulated sensor
+ *
+ * @return true if an enabled interrupt mapped to INT1 is active
+ */
+bool adxl345_sim_int1(const adxl345_sim_t *sim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADXL345_PORT_H
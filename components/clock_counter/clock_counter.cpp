@@ -1,36 +1,86 @@
 #include "clock_counter.hpp"
 #include "clock_counter_config.hpp"
 #include "system_data.hpp"
-#include <variant>
+#include "system_data_config.hpp"
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
 
 using namespace pedometer;
 
-void ClockCounter::init(void) {
-  mCount = 0;
-  mPresc = CLOCK_COUNTER_TICK_PRESCALER;
+// Length of the day in microseconds, the time of day wraps around at midnight
+static constexpr uint64_t DAY_US = static_cast<uint64_t>(CLOCK_SECONDS_PER_DAY) * CLOCK_US_PER_SECOND;
+
+#ifdef ESP_PLATFORM
+void ClockCounter::onSecondTimer(void *args) {
+  ClockCounter &clockCounter = *static_cast<ClockCounter *>(args);
+  uint64_t nextUs = clockCounter.update(esp_timer_get_time());
+  // The timer isn't running in its own callback, it is armed again for the next second boundary only
+  esp_timer_start_once(clockCounter.mTimer, nextUs);
+}
+#endif
+
+void ClockCounter::init(uint64_t nowUs) {
+  if(mIsInitialized) {
+    throw std::runtime_error("ClockCounter instance is already initialized.");
+  }
+  // Clock continues from the time in the system data
+  auto [hours, minutes, seconds] = SystemData::GetInstance().read<DATA_HOURS, DATA_MINUTES, DATA_SECONDS>();
+  mIsInitialized = true;
+#ifdef ESP_PLATFORM
+  const esp_timer_create_args_t timerArgs = {.callback = &ClockCounter::onSecondTimer,
+                                             .arg = this,
+                                             .dispatch_method = ESP_TIMER_TASK,
+                                             .name = "system_clock",
+                                             .skip_unhandled_events = false};
+  ESP_ERROR_CHECK(esp_timer_create(&timerArgs, &mTimer));
+#endif
+  setTime(hours, minutes, seconds, nowUs);
+}
+
+void ClockCounter::setTime(uint8_t hours, uint8_t minutes, uint8_t seconds, uint64_t nowUs) {
+  if(hours > SYSTEM_DATA_SCHEMA[DATA_HOURS].max || minutes > SYSTEM_DATA_SCHEMA[DATA_MINUTES].max ||
+     seconds > SYSTEM_DATA_SCHEMA[DATA_SECONDS].max) {
+    throw std::out_of_range("Invalid time of day.");
+  }
+  uint64_t timeUs = (static_cast<uint64_t>(hours) * CLOCK_SECONDS_PER_HOUR + minutes * CLOCK_SECONDS_PER_MINUTE + seconds) * CLOCK_US_PER_SECOND;
+  // Offset is kept within one day, so the time of day is never negative
+  mOffsetUs.store((timeUs + DAY_US - nowUs % DAY_US) % DAY_US);
+  mDay.store((nowUs + mOffsetUs.load()) / DAY_US);
+  uint64_t nextUs = update(nowUs);
+#ifdef ESP_PLATFORM
+  if(nullptr != mTimer) {
+    // Second boundaries have moved, the timer is armed again
+    esp_timer_stop(mTimer);
+    esp_timer_start_once(mTimer, nextUs);
+  }
+#else
+  (void)nextUs;
+#endif
+}
+
+uint32_t ClockCounter::getSecondsOfDay(uint64_t nowUs) const {
+  return static_cast<uint32_t>(((nowUs % DAY_US + mOffsetUs.load()) % DAY_US) / CLOCK_US_PER_SECOND);
+}
+
+std::tuple<uint8_t, uint8_t, uint8_t> ClockCounter::getTime(uint64_t nowUs) const {
+  uint32_t secondsOfDay = getSecondsOfDay(nowUs);
+  return {static_cast<uint8_t>(secondsOfDay / CLOCK_SECONDS_PER_HOUR),
+          static_cast<uint8_t>(secondsOfDay % CLOCK_SECONDS_PER_HOUR / CLOCK_SECONDS_PER_MINUTE),
+          static_cast<uint8_t>(secondsOfDay % CLOCK_SECONDS_PER_MINUTE)};
 }
 
-void ClockCounter::processTick() {
-  mCount++;
-  if(mCount >= mPresc) {
-    mCount = 0;
-    uint32_t seconds = std::get<uint32_t>(SystemData::GetInstance()->getData(DATA_SECONDS));
-    uint32_t minutes = std::get<uint32_t>(SystemData::GetInstance()->getData(DATA_MINUTES));
-    uint32_t hours = std::get<uint32_t>(SystemData::GetInstance()->getData(DATA_HOURS));
-    if(SYSTEM_SECONDS_MAX == seconds) {
-      SystemData::GetInstance()->setData(static_cast<uint32_t>(0), DATA_SECONDS);
-      if(SYSTEM_MINUTES_MAX == minutes) {
-        SystemData::GetInstance()->setData(static_cast<uint32_t>(0), DATA_MINUTES);
-        if(SYSTEM_HOURS_MAX == hours) {
-          SystemData::GetInstance()->setData(static_cast<uint32_t>(0), DATA_HOURS);
-        } else {
-          SystemData::GetInstance()->changeValue(DATA_HOURS, true);
-        }
-      } else {
-        SystemData::GetInstance()->changeValue(DATA_MINUTES, true);
-      }
-    } else {
-      SystemData::GetInstance()->changeValue(DATA_SECONDS, true);
-    }
+uint64_t ClockCounter::update(uint64_t nowUs) {
+  auto [hours, minutes, seconds] = getTime(nowUs);
+  uint64_t day = (nowUs + mOffsetUs.load()) / DAY_US;
+  // All fields are written at once, readers never see e.g. 12:59:00 between 12:59:59 and 13:00:00. Unchanged fields
+  // don't notify the observers.
+  if(day != mDay.exchange(day)) {
+    // New day, the steps are reset in the same write, so the pace never divides the steps of the last day by the
+    // minutes of the new one
+    SystemData::GetInstance().write<DATA_STEPS, DATA_HOURS, DATA_MINUTES, DATA_SECONDS>(0, hours, minutes, seconds);
+  } else {
+    SystemData::GetInstance().write<DATA_HOURS, DATA_MINUTES, DATA_SECONDS>(hours, minutes, seconds);
   }
+  return CLOCK_US_PER_SECOND - (nowUs + mOffsetUs.load()) % CLOCK_US_PER_SECOND;
 }
@@ -2,18 +2,37 @@
 #define CLOCK_COUNTER_H
 
 #include "system_data.hpp"
+#include <atomic>
 #include <cstdint>
-#include <string>
+#include <tuple>
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#endif
 
 namespace pedometer {
 
   /**
    * @brief Class that represents system time counter: seconds, minutes and hours
+   *
+   * Time of day isn't counted by ticks, it is computed from a monotonic microsecond counter (esp_timer_get_time() on the
+   * target) and an offset set by setTime(). The clock can't drift or lose time when the application is late. On the
+   * target a one-shot esp_timer is armed for the next second boundary only, where update() publishes hours, minutes and
+   * seconds to SystemData and the observers of the fields are notified. Steps are counted per day, the first update
+   * after midnight resets DATA_STEPS together with the time.
    */
   class ClockCounter {
   private:
-    volatile uint32_t mCount;
-    uint32_t mPresc;
+    // Microseconds added to the monotonic time to get the time of day, kept within one day
+    std::atomic<uint64_t> mOffsetUs{0};
+    // Day of the last published time, the monotonic time shifted by the offset in days
+    std::atomic<uint64_t> mDay{0};
+    bool mIsInitialized = false;
+#ifdef ESP_PLATFORM
+    esp_timer_handle_t mTimer = nullptr;
+
+    // Callback of the one-shot timer, publishes the time and arms the timer for the next second
+    static void onSecondTimer(void *args);
+#endif
 
     // One default constructor, disable copying
     ClockCounter(void) = default;
@@ -27,25 +46,43 @@ namespace pedometer {
      * @brief Static constructor for Singleton instance. After calling the constructor, method init() should be called once.
      */
     static ClockCounter &getInstance() {
-      static ClockCounter *clockCounter = new ClockCounter();
-      return *clockCounter;
+      static ClockCounter clockCounter;
+      return clockCounter;
     }
 
     /**
-     * @brief Initializes clock counter with default values. Should be called only once after the constructor.
+     * @brief Initializes clock counter with the time from SystemData. On the target starts the one-shot timer. Should be
+     *        called only once after the constructor and after SystemData::init().
+     * @param nowUs current monotonic time in microseconds
      * @note Calling the method more than once will throw std::runtime_error.
      */
-    void init(void);
+    void init(uint64_t nowUs);
+
+    /**
+     * @brief Sets the time of day and publishes it to SystemData. Setting the time doesn't start a new day, the steps
+     *        are kept.
+     * @param nowUs current monotonic time in microseconds
+     * @note Throws std::out_of_range if the time is out of the SystemData limits.
+     */
+    void setTime(uint8_t hours, uint8_t minutes, uint8_t seconds, uint64_t nowUs);
+
+    /**
+     * @brief Returns the number of seconds since midnight at the given monotonic time.
+     */
+    uint32_t getSecondsOfDay(uint64_t nowUs) const;
 
     /**
-     * @brief Processes tick and changes system time.
+     * @brief Returns hours, minutes and seconds at the given monotonic time.
      */
-    void processTick(void);
+    std::tuple<uint8_t, uint8_t, uint8_t> getTime(uint64_t nowUs) const;
 
     /**
-     * @brief Should be called on interrupt from system counter.
+     * @brief Publishes the time to SystemData, observers are notified only when the time has changed. The first update
+     *        of a new day also resets DATA_STEPS.
+     * @param nowUs current monotonic time in microseconds
+     * @return microseconds to the next second boundary
      */
-    void onTickISR(void);
+    uint64_t update(uint64_t nowUs);
   };
 
 } // namespace pedometer
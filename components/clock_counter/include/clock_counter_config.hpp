@@ -1,8 +1,10 @@
 #ifndef CLOCK_COUNTER_CONFIG_H
 #define CLOCK_COUNTER_CONFIG_H
 
+#include <cstdint>
+
 namespace pedometer {
-  enum : uint32_t { CLOCK_COUNTER_TICK_PRESCALER = 100 };
+  enum : uint32_t { CLOCK_US_PER_SECOND = 1000000, CLOCK_SECONDS_PER_MINUTE = 60, CLOCK_SECONDS_PER_HOUR = 3600, CLOCK_SECONDS_PER_DAY = 86400 };
 } // namespace pedometer
 
 #endif // CLOCK_COUNTER_CONFIG_H
\ No newline at end of file
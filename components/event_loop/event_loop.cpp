@@ -0,0 +1,129 @@
+#include "event_loop.hpp"
+#include "event_loop_config.hpp"
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+using namespace pedometer;
+
+uint64_t EventLoop::nowUs(void) {
+#ifdef ESP_PLATFORM
+  return esp_timer_get_time();
+#else
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void EventLoop::init(void) {
+  if(mIsInitialized) {
+    throw std::runtime_error("EventLoop instance is already initialized.");
+  }
+#ifdef ESP_PLATFORM
+  mTask = xTaskGetCurrentTaskHandle();
+#endif
+  mLastDispatchUs = nowUs();
+  mIsInitialized = true;
+}
+
+void EventLoop::setHandler(EventType type, EventHandler handler, void *context) {
+  if(type >= EVENT_TYPE_NUM) {
+    throw std::invalid_argument("Invalid event type.");
+  }
+  mHandlers[type] = Handler{handler, context};
+}
+
+void EventLoop::post(EventType type) {
+  // Unknown events are ignored, the method may be called from an ISR and can't throw
+  if(type >= EVENT_TYPE_NUM) {
+    return;
+  }
+  uint32_t mask = eventMask(type);
+  // Latency is measured from the first post, merged posts keep the time
+  if(0 == (mPending.load(std::memory_order_relaxed) & mask)) {
+    mPostedUs[type].store(static_cast<uint32_t>(nowUs()), std::memory_order_relaxed);
+  }
+  mPending.fetch_or(mask, std::memory_order_release);
+#ifdef ESP_PLATFORM
+  if(nullptr == mTask) {
+    return;
+  }
+  if(xPortInIsrContext()) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(mTask, &woken);
+    portYIELD_FROM_ISR(woken);
+  } else {
+    xTaskNotifyGive(mTask);
+  }
+#else
+  {
+    // Waiting task either hasn't checked the pending events yet or already waits for the notification
+    std::lock_guard<std::mutex> lock(mMutex);
+  }
+  mWakeUp.notify_one();
+#endif
+}
+
+void EventLoop::wait(uint64_t timeoutUs) {
+#ifdef ESP_PLATFORM
+  if(0 != mPending.load(std::memory_order_acquire)) {
+    return;
+  }
+  // Timeout is rounded up to whole ticks, the task never wakes before it
+  enum : uint64_t { TICK_US = portTICK_PERIOD_MS * 1000 };
+  TickType_t ticks = portMAX_DELAY;
+  if(EVENT_WAIT_FOREVER != timeoutUs && (timeoutUs + TICK_US - 1) / TICK_US < portMAX_DELAY) {
+    ticks = static_cast<TickType_t>((timeoutUs + TICK_US - 1) / TICK_US);
+  }
+  // A post after the check above leaves the notification pending, the take returns at once
+  ulTaskNotifyTake(pdTRUE, ticks);
+#else
+  std::unique_lock<std::mutex> lock(mMutex);
+  auto isPending = [this] { return 0 != mPending.load(std::memory_order_acquire); };
+  if(EVENT_WAIT_FOREVER == timeoutUs) {
+    mWakeUp.wait(lock, isPending);
+  } else {
+    mWakeUp.wait_for(lock, std::chrono::microseconds(timeoutUs), isPending);
+  }
+#endif
+}
+
+uint32_t EventLoop::dispatch(uint64_t timeoutUs) {
+  uint64_t startUs = nowUs();
+  mStats.busyUs += startUs - mLastDispatchUs;
+  if(0 != timeoutUs) {
+    wait(timeoutUs);
+  }
+  uint64_t wakeUpUs = nowUs();
+  mStats.idleUs += wakeUpUs - startUs;
+
+  uint32_t events = mPending.exchange(0, std::memory_order_acquire);
+  if(0 != events) {
+    mStats.dispatches++;
+  }
+  for(uint8_t type = 0; type < EVENT_TYPE_NUM; type++) {
+    if(0 == (events & eventMask(static_cast<EventType>(type)))) {
+      continue;
+    }
+    // Difference of the lower 32 bits is valid for latencies up to 71 minutes
+    uint32_t latencyUs = static_cast<uint32_t>(nowUs()) - mPostedUs[type].load(std::memory_order_relaxed);
+    mStats.events++;
+    mStats.latencyUs += latencyUs;
+    mStats.maxLatencyUs = std::max(mStats.maxLatencyUs, latencyUs);
+    if(nullptr != mHandlers[type].handler) {
+      mHandlers[type].handler(mHandlers[type].context);
+    }
+  }
+  mLastDispatchUs = nowUs();
+  mStats.busyUs += mLastDispatchUs - wakeUpUs;
+  return events;
+}
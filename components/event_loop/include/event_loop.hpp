@@ -0,0 +1,128 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include "event_loop_config.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace pedometer {
+
+  /**
+   * @brief Returns the mask of the event type, masks of several events are combined with |.
+   */
+  constexpr uint32_t eventMask(EventType type) { return 1UL << type; }
+
+  /**
+   * @brief Handler of an event type, called by EventLoop::dispatch() in the context of the main task.
+   */
+  using EventHandler = void (*)(void *context);
+
+  /**
+   * @brief Counters of the event loop, times are in microseconds.
+   */
+  struct EventLoopStats {
+    uint32_t dispatches;   // Wake-ups with at least one event
+    uint32_t events;       // Dispatched events, merged posts are counted once
+    uint64_t idleUs;       // Time spent blocked in dispatch()
+    uint64_t busyUs;       // Time spent in handlers and outside of dispatch() between the calls
+    uint32_t maxLatencyUs; // Longest time from the first post of an event to the start of its handler
+    uint64_t latencyUs;    // Sum of the latencies of all dispatched events
+
+    /**
+     * @brief Returns the percentage of time the main task was blocked waiting for events.
+     */
+    uint32_t idlePercent(void) const { return (0 == idleUs + busyUs) ? 0 : static_cast<uint32_t>(idleUs * 100 / (idleUs + busyUs)); }
+  };
+
+  /**
+   * @brief Class that represents the event loop of the main task.
+   *
+   * Timers, interrupts and other tasks post events, the main task blocks in dispatch() until an event comes and calls the
+   * handlers of the posted events. Pending events are a bitmask, so posting never allocates or blocks and several posts
+   * of one type before the dispatch wake the task once. On the target the task sleeps on its FreeRTOS task notification,
+   * the idle task (light sleep, watchdog feeding) runs meanwhile.
+   */
+  class EventLoop {
+  private:
+    struct Handler {
+      EventHandler handler;
+      void *context;
+    };
+    std::array<Handler, EVENT_TYPE_NUM> mHandlers = {};
+    std::atomic<uint32_t> mPending{0};
+    // Time of the first post of each pending event, lower 32 bits of the microsecond time
+    std::array<std::atomic<uint32_t>, EVENT_TYPE_NUM> mPostedUs = {};
+    EventLoopStats mStats = {};
+    uint64_t mLastDispatchUs = 0;
+    bool mIsInitialized = false;
+#ifdef ESP_PLATFORM
+    TaskHandle_t mTask = nullptr;
+#else
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+#endif
+
+    // Blocks until an event is posted or the timeout expires
+    void wait(uint64_t timeoutUs);
+
+    // One default constructor, disable copying
+    EventLoop(void) = default;
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+    EventLoop(EventLoop &&) = delete;
+    EventLoop &operator=(EventLoop &&) = delete;
+
+  public:
+    /**
+     * @brief Static constructor for Singleton instance. After calling the constructor, method init() should be called once.
+     */
+    static EventLoop &GetInstance(void) {
+      static EventLoop eventLoop;
+      return eventLoop;
+    }
+
+    /**
+     * @brief Initializes the event loop for the calling task, only this task may call dispatch().
+     * @note Calling the method more than once will throw std::runtime_error.
+     */
+    void init(void);
+
+    /**
+     * @brief Sets the handler of the event type, nullptr removes it. Should be called during initialization.
+     * @note Throws std::invalid_argument if the event type doesn't exist.
+     */
+    void setHandler(EventType type, EventHandler handler, void *context = nullptr);
+
+    /**
+     * @brief Posts the event and wakes the main task. May be called from any task, timer callback or ISR.
+     */
+    void post(EventType type);
+
+    /**
+     * @brief Waits for events and calls their handlers in the EventType order.
+     * @param timeoutUs maximum time to wait in microseconds, 0 only dispatches the pending events
+     * @return mask of the dispatched events, 0 if the timeout expired or the task was woken by already dispatched events
+     */
+    uint32_t dispatch(uint64_t timeoutUs = EVENT_WAIT_FOREVER);
+
+    /**
+     * @brief Returns the counters of the event loop.
+     */
+    const EventLoopStats &getStats(void) const { return mStats; }
+
+    /**
+     * @brief Returns the microsecond time used by the event loop, esp_timer_get_time() on the target.
+     */
+    static uint64_t nowUs(void);
+  };
+} // namespace pedometer
+
+#endif // EVENT_LOOP_H
@@ -0,0 +1,14 @@
+#ifndef EVENT_LOOP_CONFIG_H
+#define EVENT_LOOP_CONFIG_H
+
+#include <cstdint>
+
+namespace pedometer {
+  // Sources of events that wake the main task, events of the same type posted before the dispatch are merged
+  enum EventType : uint8_t { EVENT_DISPLAY, EVENT_TIMER, EVENT_BUTTON, EVENT_ACCEL, EVENT_BLE, EVENT_TYPE_NUM };
+
+  // Timeout of EventLoop::dispatch() that waits until an event is posted
+  enum : uint64_t { EVENT_WAIT_FOREVER = UINT64_MAX };
+} // namespace pedometer
+
+#endif // EVENT_LOOP_CONFIG_H
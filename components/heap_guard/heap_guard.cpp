@@ -0,0 +1,75 @@
+#include "heap_guard.hpp"
+#include "heap_guard_config.hpp"
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "sdkconfig.h"
+#else
+#include <cstdio>
+#include <cstdlib>
+#endif
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+using namespace pedometer;
+
+#ifdef ESP_PLATFORM
+static const char *TAG = "heap_guard";
+
+#ifdef CONFIG_HEAP_USE_HOOKS
+// Called by heap_caps for every successful allocation, including the ones of ISRs and other tasks
+extern "C" void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps) { HeapGuard::GetInstance().onAllocation(size); }
+#endif
+#endif
+
+void HeapGuard::arm(bool isAborting) {
+  mIsAborting = isAborting;
+  mViolations.store(0, std::memory_order_relaxed);
+  mLastViolationSize.store(0, std::memory_order_relaxed);
+  mIsArmed.store(true, std::memory_order_release);
+}
+
+void HeapGuard::onAllocation(size_t size) {
+  if(!mIsArmed.load(std::memory_order_acquire)) {
+    return;
+  }
+  mViolations.fetch_add(1, std::memory_order_relaxed);
+  mLastViolationSize.store(size, std::memory_order_relaxed);
+  if(mIsAborting) {
+    // The hook runs inside the allocator, nothing that may allocate is called here
+#ifdef ESP_PLATFORM
+    esp_system_abort("Heap allocation after the initialization");
+#else
+    std::abort();
+#endif
+  }
+}
+
+void HeapGuard::logReport(const RamBudget *table, size_t count) {
+  size_t total = 0;
+  size_t totalBudget = 0;
+#ifdef ESP_PLATFORM
+  ESP_LOGI(TAG, "%-14s %8s %8s", "component", "bytes", "budget");
+  for(size_t i = 0; i < count; i++) {
+    ESP_LOGI(TAG, "%-14s %8u %8u%s", table[i].component, static_cast<unsigned>(table[i].bytes), static_cast<unsigned>(table[i].budget),
+             (table[i].bytes > table[i].budget) ? " over budget" : "");
+    total += table[i].bytes;
+    totalBudget += table[i].budget;
+  }
+  ESP_LOGI(TAG, "%-14s %8u %8u", "total", static_cast<unsigned>(total), static_cast<unsigned>(totalBudget));
+  ESP_LOGI(TAG, "heap free %u, minimum free %u, largest block %u", static_cast<unsigned>(heap_caps_get_free_size(MALLOC_CAP_8BIT)),
+           static_cast<unsigned>(heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT)),
+           static_cast<unsigned>(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT)));
+#else
+  std::printf("%-14s %8s %8s\n", "component", "bytes", "budget");
+  for(size_t i = 0; i < count; i++) {
+    std::printf("%-14s %8zu %8zu%s\n", table[i].component, table[i].bytes, table[i].budget,
+                (table[i].bytes > table[i].budget) ? " over budget" : "");
+    total += table[i].bytes;
+    totalBudget += table[i].budget;
+  }
+  std::printf("%-14s %8zu %8zu\n", "total", total, totalBudget);
+#endif
+}
@@ -0,0 +1,108 @@
+#ifndef HEAP_GUARD_H
+#define HEAP_GUARD_H
+
+#include "heap_guard_config.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace pedometer {
+
+  /**
+   * @brief Row of the RAM budget report, statically allocated RAM of one component against its budget in bytes.
+   */
+  struct RamBudget {
+    const char *component;
+    size_t bytes;
+    size_t budget;
+  };
+
+  /**
+   * @brief Checks at compile time that no component of the table exceeds its budget.
+   */
+  template <size_t N> constexpr bool isWithinBudget(const RamBudget (&table)[N]) {
+    for(size_t i = 0; i < N; i++) {
+      if(table[i].bytes > table[i].budget) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Class that traps heap allocations after the initialization.
+   *
+   * In the static allocation mode all tasks, queues and objects are allocated statically or during the initialization.
+   * Once the guard is armed, every heap allocation reported by the allocator hook is a violation: it is counted and,
+   * in the abort mode, stops the system. The panic reason is a constant string, formatting the size could allocate
+   * inside the allocator. On the target the hook is the heap_caps allocation hook (CONFIG_HEAP_USE_HOOKS), on the host
+   * the tests forward the global operator new.
+   */
+  class HeapGuard {
+  private:
+    std::atomic<bool> mIsArmed{false};
+    bool mIsAborting = false;
+    std::atomic<uint32_t> mViolations{0};
+    std::atomic<size_t> mLastViolationSize{0};
+
+    // One default constructor, disable copying
+    HeapGuard(void) = default;
+    HeapGuard(const HeapGuard &) = delete;
+    HeapGuard &operator=(const HeapGuard &) = delete;
+    HeapGuard(HeapGuard &&) = delete;
+    HeapGuard &operator=(HeapGuard &&) = delete;
+
+    // Logs the rows of the budget table and the state of the heap
+    static void logReport(const RamBudget *table, size_t count);
+
+  public:
+    /**
+     * @brief Static constructor for Singleton instance.
+     */
+    static HeapGuard &GetInstance(void) {
+      static HeapGuard heapGuard;
+      return heapGuard;
+    }
+
+    /**
+     * @brief Starts trapping allocations, should be called when the initialization ends.
+     * @param isAborting true stops the system on the first allocation, false only counts the allocations
+     */
+    void arm(bool isAborting);
+
+    /**
+     * @brief Stops trapping allocations, e.g. before a reconfiguration that allocates.
+     */
+    void disarm(void) { mIsArmed.store(false, std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns true if allocations are trapped.
+     */
+    bool isArmed(void) const { return mIsArmed.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Called by the allocator hook for every heap allocation. May be called from any task or ISR.
+     */
+    void onAllocation(size_t size);
+
+    /**
+     * @brief Returns the number of allocations since the guard was armed.
+     */
+    uint32_t getViolations(void) const { return mViolations.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns the size of the last allocation since the guard was armed, 0 if there was none.
+     */
+    size_t getLastViolationSize(void) const { return mLastViolationSize.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Logs the RAM budget per component and the heap usage.
+     */
+    template <size_t N> static void report(const RamBudget (&table)[N]) {
+      static_assert(N <= RAM_BUDGET_MAX_ROWS, "Too many rows in the RAM budget table.");
+      logReport(table, N);
+    }
+  };
+} // namespace pedometer
+
+#endif // HEAP_GUARD_H
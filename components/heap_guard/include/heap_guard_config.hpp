@@ -0,0 +1,11 @@
+#ifndef HEAP_GUARD_CONFIG_H
+#define HEAP_GUARD_CONFIG_H
+
+#include <cstdint>
+
+namespace pedometer {
+  // Maximum number of rows of the RAM budget report
+  enum : uint8_t { RAM_BUDGET_MAX_ROWS = 16 };
+} // namespace pedometer
+
+#endif // HEAP_GUARD_CONFIG_H
@@ -1,22 +1,39 @@
 #ifndef MENU_H
 #define MENU_H
 
+#include "menu_config.hpp"
 #include "menu_pages.hpp"
-#include <map>
-#include <memory>
+#include <array>
+#include <atomic>
+#include <cstdint>
 
 namespace pedometer {
 
   enum MenuAction { MENU_ACTION_ENTER, MENU_ACTION_UP, MENU_ACTION_DOWN };
 
+  /**
+   * @brief Function called when data shown in the menu change, e.g. to wake the task that calls Menu::update().
+   */
+  using RedrawRequest = void (*)(void);
+
   /**
    * @brief Class that represents the whole menu system.
+   *
+   * Pages are constant layouts placed in flash (see menu.cpp), the menu keeps only the state of the active page. Nothing
+   * is allocated on the heap. Frames are published to the render task of the display, the display has to be in the
+   * asynchronous mode (oled_async_start()) before init() is called. A frame refused while the previous one is still
+   * being sent stays pending and is published by the next update().
    */
-  class Menu {
+  class Menu : public DataObserver {
   private:
-    std::map<PageName, std::unique_ptr<Page>> mPages;
-    PageName mActivePage;
-    bool mIsInitialized;
+    PageName mActivePage = MAIN_PAGE;
+    uint8_t mSelected = INITIAL_SELECTION;
+    bool mIsInitialized = false;
+    uint64_t mLastFrameUs = 0;
+    std::atomic<uint32_t> mDirtyFields{0};
+    std::atomic<bool> mIsFramePending{false};
+    std::array<PageDrawStats, PAGE_NUM> mDrawStats = {};
+    RedrawRequest mRedrawRequest = nullptr;
 
     // One default constructor, disable copying
     Menu(void) = default;
@@ -25,26 +42,75 @@ namespace pedometer {
     Menu(Menu &&) = delete;
     Menu &operator=(Menu &&) = delete;
 
+    // Opens the page with the first option selected
+    void openPage(PageName page);
+
+    // Draws the whole active page, all values are read again
+    void drawPage(void);
+
+    // Page specific handling of the action, selected by std::visit on the active page layout
+    void pageAction(const LinkPageLayout &page, MenuAction action);
+    void pageAction(const ParamPageLayout &page, MenuAction action);
+
   public:
     /**
      * @brief Static constructor for Singleton instance. After calling the constructor, method init() should be called once.
+     * @note The instance is a static object, so the menu doesn't use the heap.
      */
     static Menu &GetInstance(void) {
-      static Menu *menuSystem = new Menu();
-      return *menuSystem;
+      static Menu menuSystem;
+      return menuSystem;
     }
 
     /**
      * @brief Initializes the menu system. Should be called only once after the constructor.
      * @note Calling the method more than once will throw std::runtime_error.
      */
-    void init(ext_spi_handle_t ext_spi);
+    void init(void);
 
     /**
      * @brief Enables an action in a menu system
      * @param action action: ENTER, UP, DOWN (...)
      */
-    void action(ext_spi_handle_t ext_spi, MenuAction action);
+    void action(MenuAction action);
+
+    /**
+     * @brief Frame scheduler. Redraws the items showing changed data fields of the active page, at most once per
+     *        MENU_FRAME_PERIOD_US. A pending frame without new changes is published at once.
+     * @param nowUs current time in microseconds
+     * @return true if a frame was published
+     */
+    bool update(uint64_t nowUs);
+
+    /**
+     * @brief Returns the time in microseconds until update() can draw the pending changes of the active page, 0 if it can
+     *        draw now, MENU_NO_FRAME if nothing has changed. A pending frame doesn't shorten the delay, the frame done
+     *        callback of the display should request a redraw when isFramePending() is true.
+     * @param nowUs current time in microseconds
+     */
+    uint64_t getFrameDelayUs(uint64_t nowUs) const;
+
+    /**
+     * @brief Returns true if a drawn frame waits for the display. May be called from an ISR.
+     */
+    bool isFramePending(void) const { return mIsFramePending.load(); }
+
+    /**
+     * @brief Sets the function called when data shown in the menu change, nullptr removes it. The function is called in
+     *        the context of the data writer, which may be an ISR.
+     */
+    void setRedrawRequest(RedrawRequest request) { mRedrawRequest = request; }
+
+    /**
+     * @brief Marks the data fields as changed, called by SystemData.
+     */
+    void onDataChanged(uint32_t fields) override;
+
+    /**
+     * @brief Returns the background cache counters of the given page.
+     * @note Throws std::out_of_range if the page doesn't exist.
+     */
+    const PageDrawStats &getDrawStats(PageName page) const;
   };
 } // namespace pedometer
 
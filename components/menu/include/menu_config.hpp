@@ -0,0 +1,14 @@
+#ifndef MENU_CONFIG_H
+#define MENU_CONFIG_H
+
+#include <cstdint>
+
+namespace pedometer {
+  // Frame scheduler: dirty widgets are redrawn at most MENU_MAX_FPS times per second
+  enum : uint32_t { MENU_MAX_FPS = 10, MENU_FRAME_PERIOD_US = 1000000 / MENU_MAX_FPS };
+
+  // Frame delay when there is nothing to redraw
+  enum : uint64_t { MENU_NO_FRAME = UINT64_MAX };
+} // namespace pedometer
+
+#endif // MENU_CONFIG_H
@@ -3,666 +3,284 @@
 
 #include "oled_sh1106.h"
 #include "oled_sh1106_config.h"
+#include "oled_sh1106_font.h"
 #include "system_data.hpp"
+#include "system_data_config.hpp"
+#include <cstddef>
 #include <cstdint>
-#include <memory>
-#include <string>
+#include <stdexcept>
 #include <variant>
-#include <vector>
-
-// enum { OLED_WIDTH = 128, OLED_HEIGHT = 64, OLED_NUM_PAGES = 8 }
 
 namespace pedometer {
 
-  enum LineDirection : bool { SHAPE_LINE_VERTICAL = true, SHAPE_LINE_HORIZONTAL = false };
-  enum ShapeColor : bool { SHAPE_COLOR_WHITE = true, SHAPE_COLOR_BLACK = false };
-  enum ShapeFill : bool { SHAPE_FILLED = true, SHAPE_NOT_FILLED = false };
   enum { INITIAL_SELECTION = 0 };
 
-  enum VariantType { VARIANT_UINT8_T, VARIANT_UINT32_T, VARIANT_BOOL };
-
-  // Pages are stored in the Menu class in the map<PageName, Page>, where PageName type variable is the key
-  enum PageName { MAIN_PAGE, CONFIG_PAGE };
+  // Pages are described by constant PageLayout tables, PageName is the index of the page in the table
+  enum PageName : uint8_t { MAIN_PAGE, CONFIG_PAGE, PAGE_NUM };
 
-  // ----- Forward declaration -----
-  class Page;
-  // -------------------------------
+  // Kinds of the page items
+  enum ItemKind : uint8_t {
+    ITEM_TEXT,  // Constant text
+    ITEM_DATA,  // Value of a data field
+    ITEM_RECT,  // Rectangle
+    ITEM_LINK,  // Link to another page - selectable option
+    ITEM_PARAM, // Name and value of a data field that can be changed - selectable option
+  };
 
   /**
-   * @brief This class represents a GraphicObject - shape ot text to draw on the display.
+   * @brief Single item of a page layout. Items are created by the constexpr functions below, so positions are computed
+   *        and checked at compile time and the layouts are placed in flash.
    */
-  class GraphicObject {
-  public:
-    // Virtual methods
-    virtual void draw(void) const = 0;
-    virtual ~GraphicObject() = default;
+  struct PageItem {
+    ItemKind kind;
+    uint8_t page;     // Text row - display page
+    uint8_t col;      // First column of the text
+    uint8_t width;    // Number of characters reserved for the value; ITEM_DATA, ITEM_PARAM
+    const char *text; // ITEM_TEXT, ITEM_LINK, ITEM_PARAM
+    DataField field;  // ITEM_DATA, ITEM_PARAM
+    PageName target;  // ITEM_LINK
+    oled_rect_t rect; // ITEM_RECT
   };
 
   /**
-   * @brief This class represents a single point to draw on the display.
+   * @brief Items of a single page in the menu system.
    */
-  class Point : public GraphicObject {
-  private:
-    uint8_t mX;
-    uint8_t mY;
-    ShapeColor mColor;
-
-  public:
-    /**
-     * @brief Object constructor. By default point is white.
-     */
-    Point(uint8_t x, uint8_t y);
-
-    /**
-     * @brief Object constructor.
-     */
-    Point(uint8_t x, uint8_t y, ShapeColor color);
-
-    /**
-     * Default destructor.
-     */
-    ~Point() override = default;
-
-    /**
-     * @brief Returns x coordinate of the point.
-     */
-    uint8_t getX(void) const;
-
-    /**
-     * @brief Returns y coordinate of the point.
-     */
-    uint8_t getY(void) const;
-
-    /**
-     * @brief Returns the point color.
-     * @return SHAPE_COLOR_WHITE if the point white; SHAPE_COLOR_BLACK if it is black
-     */
-    ShapeColor getColor(void) const;
-
-    /**
-     * @brief Sets the x coordinate of the point.
-     * @return x coordinate
-     */
-    void setX(uint8_t x);
-
-    /**
-     * @brief Sets the y coordinate of the point.
-     * @return y coordinate
-     */
-    void setY(uint8_t y);
-
-    /**
-     * @brief Sets the the point color: SHAPE_COLOR_WHITE is white; SHAPE_COLOR_BLACK is black
-     */
-    void setColor(ShapeColor color);
-
-    /**
-     * @brief Puts the point into the video buffer.
-     */
-    void draw(void) const override;
+  struct PageContent {
+    const PageItem *items; // Items in the drawing order
+    uint8_t itemNum;       // Number of items
+    uint8_t optionNum;     // Number of selectable items (links or params)
+    uint32_t fields;       // Mask of data fields shown on the page, bit number is the DataField
   };
 
   /**
-   * @brief This class represents a vertital or a horizontal line to draw on the display.
+   * @brief Page with links to other pages. UP and DOWN move the selection, ENTER opens the selected page.
    */
-  class Line : public GraphicObject {
-  private:
-    Point mStartP;
-    uint8_t mLength;
-    LineDirection mDir;
-    ShapeColor mColor;
-
-  public:
-    /**
-     * @brief Object constructor. By default line is white and vertical.
-     */
-    Line(Point p, uint8_t length);
-
-    /**
-     * @brief Object constructor.
-     */
-    Line(Point p, uint8_t length, LineDirection dir, ShapeColor color);
-
-    /**
-     * Default destructor.
-     */
-    ~Line() override = default;
-
-    /**
-     * @brief Returns the start point.
-     * @return start point
-     */
-    Point getStartPoint(void) const;
-
-    /**
-     * @brief Returns the length of the line.
-     * @return length
-     */
-    uint8_t getLength(void) const;
-
-    /**
-     * @brief Returns if line is vertical or horizontal.
-     * @return SHAPE_LINE_VERTICAL if the line is vertical; SHAPE_LINE_HORIZONTAL if it is horizontal
-     */
-    LineDirection getDirection(void) const;
-
-    /**
-     * @brief Returns the line color.
-     * @return HAPE_COLOR_WHITE if the line white; SHAPE_COLOR_BLACK if it is black
-     */
-    ShapeColor getColor(void) const;
-
-    /**
-     * @brief Sets the start point of the line.
-     */
-    void setStartPoint(Point p);
-
-    /**
-     * @brief Sets the length of the line.
-     */
-    void setLength(uint8_t length);
-
-    /**
-     * @brief Sets the the direction of the line: SHAPE_LINE_VERTICAL is vertical; SHAPE_LINE_HORIZONTAL is horizontal.
-     */
-    void setDirection(LineDirection dir);
-
-    /**
-     * @brief Sets the the line color: SHAPE_COLOR_WHITE is white; SHAPE_COLOR_BLACK is black.
-     */
-    void setColor(ShapeColor color);
-
-    /**
-     * @brief Puts the line into the video buffer.
-     */
-    void draw(void) const override;
+  struct LinkPageLayout {
+    PageContent content;
   };
 
   /**
-   * @brief This class represents a filled or a not filled rectangle to draw on the display.
+   * @brief Page with params to change. UP and DOWN change the selected param, ENTER selects the next one and after the
+   *        last param opens the parent page.
    */
-  class Rectangle : public GraphicObject {
-  private:
-    Point mStartP;
-    Point mEndP;
-    ShapeColor mColor;
-    ShapeFill mFill;
-
-  public:
-    /**
-     * @brief Object constructor. By default color is white and rectangle is not filled.
-     */
-    Rectangle(Point startP, Point endP);
-
-    /**
-     * @brief Object constructor.
-     */
-    Rectangle(Point startP, Point endP, ShapeColor color, ShapeFill fill);
-
-    /**
-     * Default destructor.
-     */
-    ~Rectangle() override = default;
-
-    /**
-     * @brief Returns the start point.
-     * @return start point
-     */
-    Point getStartPoint(void) const;
-
-    /**
-     * @brief Returns the end point.
-     * @return end point
-     */
-    Point getEndPoint(void) const;
-
-    /**
-     * @brief Returns the rectangle color.
-     * @return SHAPE_COLOR_WHITE if the rectangle white; SHAPE_COLOR_BLACK if it is black
-     */
-    ShapeColor getColor(void) const;
-
-    /**
-     * @brief Returns the rectangle fill.
-     * @return SHAPE_FILLED if the rectangle is filled; SHAPE_NOT_FILLED if it is not filled
-     */
-    ShapeFill getFill(void) const;
-
-    /**
-     * @brief Sets the start point of the rectangle.
-     */
-    void setStartPoint(Point p);
-
-    /**
-     * @brief Sets the end point of the rectangle.
-     */
-    void setEndPoint(Point p);
-
-    /**
-     * @brief Sets the the rectangle fill: SHAPE_FILLED is filled; SHAPE_NOT_FILLED is not filled.
-     */
-    void setFill(ShapeFill fill);
-
-    /**
-     * @brief Sets the the rectangle color: SHAPE_COLOR_WHITE is white; SHAPE_COLOR_BLACK is black.
-     */
-    void setColor(ShapeColor color);
-
-    /**
-     * @brief Puts the rectangle into the video buffer.
-     */
-    void draw(void) const override;
+  struct ParamPageLayout {
+    PageContent content;
+    PageName parent;
   };
 
   /**
-   * @brief This class represents a single string to print on the display.
+   * @brief Layout of a single page. Actions are dispatched by std::visit, the menu doesn't need RTTI.
    */
-  class TextLine : public GraphicObject {
-  private:
-    std::string mText;
-    uint8_t mPage;
-    uint8_t mCol;
-    uint8_t mFontID;
-
-  public:
-    /**
-     * @brief Object constructor.
-     */
-    TextLine(std::string text, uint8_t page, uint8_t col, uint8_t fontID);
-
-    /**
-     * Default destructor.
-     */
-    ~TextLine() override = default;
-
-    /**
-     * @brief Returns the text string.
-     */
-    std::string getText(void) const;
-
-    /**
-     * @brief Returns the text page.
-     */
-    uint8_t getPage(void) const;
-
-    /**
-     * @brief Returns the text column.
-     */
-    uint8_t getCol(void) const;
-
-    /**
-     * @brief Returns the text font ID.
-     */
-    uint8_t getFontID(void) const;
-
-    /**
-     * @brief Sets the text.
-     */
-    void setText(std::string text);
-
-    /**
-     * @brief Sets the text page.
-     */
-    void setPage(uint8_t page);
-
-    /**
-     * @brief Sets the text column.
-     */
-    void setCol(uint8_t col);
-
-    /**
-     * @brief Sets the text font ID.
-     */
-    void setFontID(uint8_t fontID);
-
-    /**
-     * @brief Puts the text into the video buffer.
-     */
-    void draw(void) const override;
-  };
+  using PageLayout = std::variant<LinkPageLayout, ParamPageLayout>;
 
   /**
-   * @brief This class represents a single data line to print on the display.
+   * @brief Counters of the page background cache. Cycles are CPU cycles on the target and nanoseconds on the host.
    */
-  class DataLine : public GraphicObject {
-  private:
-    std::variant<uint8_t, uint32_t, bool> mValue;
-    uint8_t mPage;
-    uint8_t mCol;
-    uint8_t mFontID;
-    DataField mDataField;
-
-  public:
-    /**
-     * @brief Object constructor.
-     */
-    DataLine(uint8_t page, uint8_t col, uint8_t fontID, DataField dataField);
-
-    /**
-     * Default destructor.
-     */
-    ~DataLine() override = default;
-
-    /**
-     * @brief Returns the data value.
-     */
-    std::variant<uint8_t, uint32_t, bool> getData(void) const;
-
-    /**
-     * @brief Returns the data page.
-     */
-    uint8_t getPage(void) const;
-
-    /**
-     * @brief Returns the data column.
-     */
-    uint8_t getCol(void) const;
-
-    /**
-     * @brief Returns the data font ID.
-     */
-    uint8_t getFontID(void) const;
-
-    /**
-     * @brief Sets the data value.
-     */
-    void setData(std::variant<uint8_t, uint32_t, bool> value);
-
-    /**
-     * @brief Sets the data page.
-     */
-    void setPage(uint8_t page);
-
-    /**
-     * @brief Sets the data column.
-     */
-    void setCol(uint8_t col);
-
-    /**
-     * @brief Sets the data font ID.
-     */
-    void setFontID(uint8_t fontID);
-
-    /**
-     * @brief Updates parameter from system data base.
-     * @param systemData pointer to the system data base
-     */
-    void updateParam(const SystemData &systemData);
-
-    /**
-     * @brief Puts the data converted to text into the video buffer.
-     */
-    void draw(void) const override;
+  struct PageDrawStats {
+    uint32_t backgroundBuilds; // Number of background rasterizations
+    uint32_t cachedFrames;     // Number of frames drawn over the cached background
+    uint32_t staticCycles;     // Cycles of the last rasterization of the static items
+    uint64_t savedCycles;      // Cycles saved by copying the cached background instead of rasterizing the static items
   };
 
+  // -------------------------------------------------------------------------------
+  // ------------------------ Compile time layout functions ------------------------
+  // -------------------------------------------------------------------------------
+
   /**
-   * @brief This class represents a parameter or an option that can be changed.
+   * @brief Returns the length of the text.
    */
-  class InteractiveParam {
-  private:
-    std::variant<uint8_t, uint32_t, bool> mValue;
-    TextLine mTextLine;
-    DataField mDataField;
-
-  public:
-    /**
-     * @brief Object constructor.
-     */
-    InteractiveParam(TextLine textLine, DataField dataField);
-
-    /**
-     * Default destructor.
-     */
-    ~InteractiveParam() = default;
-
-    /**
-     * @brief Returns the param value.
-     */
-    std::variant<uint8_t, uint32_t, bool> getValue(void) const;
-
-    /**
-     * @brief Returns text of the param.
-     */
-    TextLine getLine(void) const;
-
-    /**
-     * @brief Sets the param value.
-     */
-    void setValue(std::variant<uint8_t, uint32_t, bool> value);
-
-    /**
-     * @brief Sets the text of the param.
-     */
-    void setText(TextLine textLine);
-
-    /**
-     * @brief Updates parameter from system data base.
-     * @param systemData pointer to the system data base
-     */
-    void updateParam(const SystemData &systemData);
-
-    /**
-     * Returns data field.
-     */
-    DataField getDataField(void);
-
-    /**
-     * @brief Puts the text into the video buffer.
-     */
-    void draw(void) const;
-  };
+  constexpr uint8_t textLength(const char *text) {
+    uint8_t len = 0;
+    while('\0' != text[len]) {
+      len++;
+    }
+    return len;
+  }
 
   /**
-   * @brief This class represents a page link.
+   * @brief Returns the number of decimal digits of the value.
    */
-  class InteractiveLink {
-  private:
-    PageName mChildPage;
-    TextLine mTextLine;
-
-  public:
-    /**
-     * @brief Object constructor.
-     */
-    InteractiveLink(PageName childPage, TextLine textLine);
-
-    /**
-     * Default destructor.
-     */
-    ~InteractiveLink() = default;
-
-    /**
-     * @brief Returns pointer to the child page.
-     */
-    PageName getPage(void) const;
-
-    /**
-     * @brief Returns text of the page link.
-     */
-    TextLine getLine(void) const;
-
-    /**
-     * @brief Sets the child page pointer.
-     */
-    void setPage(PageName page);
-
-    /**
-     * @brief Sets the text of the link page.
-     */
-    void setText(TextLine textLine);
+  constexpr uint8_t decimalDigits(uint32_t value) {
+    uint8_t digits = 1;
+    while(value >= 10) {
+      value /= 10;
+      digits++;
+    }
+    return digits;
+  }
 
-    /**
-     * @brief Puts the text into the video buffer.
-     */
-    void draw(void) const;
-  };
+  /**
+   * @brief Returns the number of characters needed to show any value of the data field.
+   */
+  constexpr uint8_t dataWidth(DataField field) {
+    if(field >= DATA_FIELD_NUM) {
+      throw std::invalid_argument("Unsupported data field.");
+    }
+    const DataSchema &schema = SYSTEM_DATA_SCHEMA[field];
+    switch(schema.type) {
+    case PARAM_UINT8:
+      // Small values are clock fields, they are always shown with at least two digits
+      return (decimalDigits(schema.max) > 2) ? decimalDigits(schema.max) : 2;
+    case PARAM_UINT32:
+      return decimalDigits(schema.max);
+    default:
+      return 3; // "ON" or "OFF"
+    }
+  }
 
   /**
-   * @brief Class that represents a single page in the menu system.
+   * @brief Checks that the text of the given length fits the display and returns its column.
+   * @note Evaluated at compile time, a text out of the display stops the compilation.
    */
-  class Page {
-  public:
-    // Virtual methods
-    virtual void addGraphic(std::unique_ptr<GraphicObject> graphic) = 0;
-    virtual void draw(ext_spi_handle_t ext_spi) const = 0;
-    virtual void updateDataAndParams(const SystemData &systemData) = 0;
-    virtual void setSelection(uint8_t sel) = 0;
-    virtual void changeSelection(bool increase) = 0;
-    virtual void setCursor(void) const = 0;
-    virtual ~Page() = default;
-  };
+  constexpr uint8_t checkTextCol(uint8_t page, uint8_t col, uint8_t len) {
+    if(page >= OLED_NUM_PAGES || col + len * OLED_BASIC_FONT_COLS > OLED_WIDTH) {
+      throw std::out_of_range("Text doesn't fit the display.");
+    }
+    return col;
+  }
 
   /**
-   * @brief Class that represents a single menu page with page links in the menu system.
+   * @brief Constant text.
    */
-  class LinkPage : public Page {
-  private:
-    std::vector<std::unique_ptr<GraphicObject>> mGraphic;
-    std::vector<std::unique_ptr<InteractiveLink>> mLinks;
-    uint8_t mSelected;
+  constexpr PageItem textItem(const char *text, uint8_t page, uint8_t col) {
+    return PageItem{ITEM_TEXT, page, checkTextCol(page, col, textLength(text)), 0, text, DATA_STEPS, MAIN_PAGE, oled_rect_t{}};
+  }
 
-  public:
-    /**
-     * @brief Default constructor.
-     */
-    LinkPage() = default;
+  /**
+   * @brief Constant text centered on the display.
+   */
+  constexpr PageItem centeredTextItem(const char *text, uint8_t page) {
+    return textItem(text, page, static_cast<uint8_t>((OLED_WIDTH - textLength(text) * OLED_BASIC_FONT_COLS) / 2));
+  }
 
-    /**
-     * @brief Object constructor.
-     */
-    LinkPage(std::vector<std::unique_ptr<GraphicObject>> &&graphic, std::vector<std::unique_ptr<InteractiveLink>> &&links);
+  /**
+   * @brief Value of the data field.
+   */
+  constexpr PageItem dataItem(DataField field, uint8_t page, uint8_t col) {
+    return PageItem{ITEM_DATA, page, checkTextCol(page, col, dataWidth(field)), dataWidth(field), nullptr, field, MAIN_PAGE, oled_rect_t{}};
+  }
 
-    /**
-     * @brief Default destructor.
-     */
-    ~LinkPage() override = default;
+  /**
+   * @brief Rectangle; white and not filled by default.
+   */
+  constexpr PageItem rectItem(uint8_t origX, uint8_t origY, uint8_t endX, uint8_t endY, bool color = OLED_COLOR_WHITE,
+                              bool fill = OLED_SHAPE_NOT_FILLED) {
+    if(origX > endX || origY > endY || endX >= OLED_WIDTH || endY >= OLED_HEIGHT) {
+      throw std::out_of_range("Rectangle doesn't fit the display.");
+    }
+    return PageItem{ITEM_RECT, 0, 0, 0, nullptr, DATA_STEPS, MAIN_PAGE, oled_rect_t{origX, origY, endX, endY, color, fill}};
+  }
 
-    /**
-     * @brief This function adds graphic object to the page.
-     */
-    void addGraphic(std::unique_ptr<GraphicObject> graphic) override;
+  /**
+   * @brief Border drawn around the page.
+   */
+  constexpr PageItem borderItem(void) { return rectItem(2, 2, OLED_WIDTH - 3, OLED_HEIGHT - 3); }
 
-    /**
-     * @brief This function adds link to the page.
-     */
-    void addLink(std::unique_ptr<InteractiveLink> link);
+  /**
+   * @brief Link to the target page; links are placed after the cursor column.
+   */
+  constexpr PageItem linkItem(const char *text, uint8_t page, PageName target) {
+    uint8_t col = checkTextCol(page, OLED_BASIC_FONT_START_COL_OFFSET, textLength(text));
+    return PageItem{ITEM_LINK, page, col, 0, text, DATA_STEPS, target, oled_rect_t{}};
+  }
 
-    /**
-     * @brief Returns a pointer to the child page.
-     */
-    PageName getChild(void);
+  /**
+   * @brief Param: name of the data field followed by its value; params are placed after the cursor column.
+   */
+  constexpr PageItem paramItem(const char *text, uint8_t page, DataField field) {
+    uint8_t col = checkTextCol(page, OLED_BASIC_FONT_START_COL_OFFSET, textLength(text) + 1 + dataWidth(field));
+    return PageItem{ITEM_PARAM, page, col, dataWidth(field), text, field, MAIN_PAGE, oled_rect_t{}};
+  }
 
-    /**
-     * @brief Updates data to display on the screen if present.
-     */
-    void updateDataAndParams(const SystemData &systemData) override;
+  /**
+   * @brief Returns the number of items of the given kind.
+   */
+  constexpr uint8_t countItems(const PageItem *items, size_t itemNum, ItemKind kind) {
+    uint8_t count = 0;
+    for(size_t i = 0; i < itemNum; i++) {
+      if(kind == items[i].kind) {
+        count++;
+      }
+    }
+    return count;
+  }
 
-    /**
-     * @brief Sets selected link option.
-     */
-    void setSelection(uint8_t sel) override;
+  /**
+   * @brief Returns the mask of data fields shown by the items.
+   */
+  constexpr uint32_t fieldMask(const PageItem *items, size_t itemNum) {
+    uint32_t mask = 0;
+    for(size_t i = 0; i < itemNum; i++) {
+      if(ITEM_DATA == items[i].kind || ITEM_PARAM == items[i].kind) {
+        mask |= 1UL << items[i].field;
+      }
+    }
+    return mask;
+  }
 
-    /**
-     * @brief Changes selected option to the next or the previos one depending on the argument.
-     */
-    void changeSelection(bool increase) override;
+  /**
+   * @brief Page with links to other pages; it must have at least one link and no params.
+   */
+  template <size_t N> constexpr LinkPageLayout linkPageLayout(const PageItem (&items)[N]) {
+    if(0 == countItems(items, N, ITEM_LINK) || 0 != countItems(items, N, ITEM_PARAM)) {
+      throw std::invalid_argument("Link page needs links and no params.");
+    }
+    return LinkPageLayout{PageContent{items, static_cast<uint8_t>(N), countItems(items, N, ITEM_LINK), fieldMask(items, N)}};
+  }
 
-    /**
-     * @brief Gets pointer to the selected link.
-     */
-    InteractiveLink *getSelectedLink(void);
+  /**
+   * @brief Page with params to change; it must have at least one param and no links.
+   */
+  template <size_t N> constexpr ParamPageLayout paramPageLayout(const PageItem (&items)[N], PageName parent) {
+    if(0 == countItems(items, N, ITEM_PARAM) || 0 != countItems(items, N, ITEM_LINK)) {
+      throw std::invalid_argument("Param page needs params and no links.");
+    }
+    return ParamPageLayout{PageContent{items, static_cast<uint8_t>(N), countItems(items, N, ITEM_PARAM), fieldMask(items, N)}, parent};
+  }
 
-    /**
-     * @brief Sets cursor on the page if there are more than one options.
-     */
-    void setCursor(void) const override;
+  /**
+   * @brief Returns the items of the page.
+   */
+  constexpr const PageContent &pageContent(const PageLayout &layout) {
+    return std::visit([](const auto &page) -> const PageContent & { return page.content; }, layout);
+  }
 
-    /**
-     * @brief Puts the graphic and interactive objects into the video buffer.
-     */
-    void draw(ext_spi_handle_t ext_spi) const override;
-  };
+  // -------------------------------------------------------------------------------
+  // -------------------------------- Page renderer --------------------------------
+  // -------------------------------------------------------------------------------
 
   /**
-   * @brief Class that represents a single menu page with parameters to change int the menu system.
+   * @brief Renderer of the page layouts.
+   *
+   * Static items (texts, links, rectangles and the cursor) are rasterized once into a background that is shared by all
+   * pages. Every frame the background is copied into the video buffer and only data items and params are drawn over it.
+   * The background is rebuilt when another page or another selection is drawn.
    */
-  class ParamPage : public Page {
-  private:
-    std::vector<std::unique_ptr<GraphicObject>> mGraphic;
-    std::vector<std::unique_ptr<InteractiveParam>> mParams;
-    uint8_t mSelected;
-    PageName mParentPage;
-
+  class PageRenderer {
   public:
     /**
-     * @brief Default constructor.
-     */
-    ParamPage() = default;
-
-    /**
-     * @brief Object constructor.
-     */
-    ParamPage(std::vector<std::unique_ptr<GraphicObject>> &&graphic, std::vector<std::unique_ptr<InteractiveParam>> &&params);
-
-    /**
-     * @brief Default destructor.
-     */
-    ~ParamPage() override = default;
-
-    /**
-     * @brief This function adds graphic object to the page.
-     */
-    void addGraphic(std::unique_ptr<GraphicObject> graphic) override;
-
-    /**
-     * @brief This function adds param to the page.
-     */
-    void addParam(std::unique_ptr<InteractiveParam> param);
-
-    /**
-     * @brief Updates data and parameters to display on the screen if present.
-     */
-    void updateDataAndParams(const SystemData &systemData) override;
-
-    /**
-     * @brief Sets cursor on the page if there are more than one options.
-     */
-    void setCursor(void) const override;
-
-    /**
-     * @brief Returns a pointer to the child page.
-     */
-    PageName getParent(void);
-
-    /**
-     * @brief Returns selected option.
-     */
-    uint8_t getSelected(void);
-
-    /**
-     * @brief Returns params number.
-     */
-    uint8_t getParamsNum(void);
-
-    /**
-     * @brief Sets selected params option.
-     */
-    void setSelection(uint8_t sel) override;
-
-    /**
-     * @brief Changes selected option to the next or the previos one depending on the argument.
+     * @brief Draws the whole page and publishes it to the render task of the display (oled_swap_buffers()).
+     * @param selected selected option, the cursor is shown if the page has more than one option
+     * @param stats background cache counters of the page
+     * @return true if the frame was published; false if the previous frame is still being sent, the changes stay in the
+     *         video buffer until the next oled_swap_buffers()
      */
-    void changeSelection(bool increase) override;
+    static bool draw(const PageContent &page, uint8_t selected, const SystemData &systemData, PageDrawStats &stats);
 
     /**
-     * @brief Gets pointer to the selected param.
+     * @brief Redraws only the items showing the given data fields and publishes the changes. The whole page is drawn if
+     *        the background doesn't belong to the page.
+     * @param fields mask of the changed data fields
+     * @return true if the frame was published, see draw()
      */
-    InteractiveParam *getSelectedParam(void);
+    static bool drawFields(const PageContent &page, uint8_t selected, uint32_t fields, const SystemData &systemData, PageDrawStats &stats);
 
     /**
-     * @brief Puts the graphic and interactive objects into the video buffer.
+     * @brief Returns the selectable item (link or param) with the given index.
+     * @note Throws std::out_of_range if the option doesn't exist.
      */
-    void draw(ext_spi_handle_t ext_spi) const override;
+    static const PageItem &getOption(const PageContent &page, uint8_t option);
   };
 
 } // namespace pedometer
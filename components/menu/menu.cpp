@@ -4,133 +4,169 @@
 #include "oled_sh1106_font.h"
 #include "system_data.hpp"
 #include <cstdint>
-#include <memory>
-#include <string>
-#include <vector>
+#include <stdexcept>
+#include <variant>
 
 namespace pedometer {
 
-  enum : uint8_t { DEFAULT_LINK_PARAM_SELECT = 0 };
-
-  uint8_t getCenteredTextCol(std::string text, uint8_t fontID) {
-    switch(fontID) {
-    case OLED_BASIC_FONT_ID:
-      return (oled_get_attributes().columns - text.length()) / 2 * OLED_BASIC_FONT_COLS;
-    default:
-      return 0; // Unsupported font
+  // ################################## MAIN_PAGE ##################################
+  static constexpr PageItem MAIN_PAGE_ITEMS[] = {
+      centeredTextItem("PEDOMETER", 1),
+      linkItem("CONFIG", 3, CONFIG_PAGE),
+      textItem("STEPS:", 5, 72),
+      textItem("TARGET:", 6, 72),
+      dataItem(DATA_STEPS, 5, OLED_BASIC_FONT_START_COL_OFFSET),
+      dataItem(DATA_TARGET_STEPS, 6, OLED_BASIC_FONT_START_COL_OFFSET),
+      borderItem(),
+  };
+
+  // ################################## CONFIG_PAGE ##################################
+  static constexpr PageItem CONFIG_PAGE_ITEMS[] = {
+      centeredTextItem("CONFIG", 1),
+      linkItem("BACK", 3, MAIN_PAGE),
+      linkItem("BACK 2", 4, MAIN_PAGE),
+      borderItem(),
+  };
+
+  // Pages in the PageName order, the active page is selected by its index
+  static constexpr PageLayout MENU_LAYOUT[PAGE_NUM] = {
+      linkPageLayout(MAIN_PAGE_ITEMS),
+      linkPageLayout(CONFIG_PAGE_ITEMS),
+  };
+
+  // Mask of all data fields shown in the menu
+  static constexpr uint32_t menuFields(void) {
+    uint32_t fields = 0;
+    for(const PageLayout &layout : MENU_LAYOUT) {
+      fields |= pageContent(layout).fields;
     }
+    return fields;
   }
 
-  void Menu::init(ext_spi_handle_t ext_spi) {
+  void Menu::init(void) {
     if(mIsInitialized) {
       throw std::runtime_error("MenuSystem instance is already initialized.");
     } else {
-      // #################### Pages initialization and instatiation ####################
-      // ################################## MAIN_PAGE ##################################
-
-      // Helper vectors
-      std::vector<std::unique_ptr<GraphicObject>> mainPageGO;
-      std::vector<std::unique_ptr<InteractiveLink>> mainPageIL;
-
-      // Graphic objects
-      mainPageGO.emplace_back(std::make_unique<TextLine>("PEDOMETER", 1, getCenteredTextCol("PEDOMETER", OLED_BASIC_FONT_ID), OLED_BASIC_FONT_ID));
-      mainPageGO.emplace_back(std::make_unique<TextLine>("STEPS:", 5, 72, OLED_BASIC_FONT_ID));
-      mainPageGO.emplace_back(std::make_unique<TextLine>("TARGET:", 6, 72, OLED_BASIC_FONT_ID));
-
-      mainPageGO.emplace_back(std::make_unique<DataLine>(5, OLED_BASIC_FONT_START_COL_OFFSET, OLED_BASIC_FONT_ID, DATA_STEPS));
-      mainPageGO.emplace_back(std::make_unique<DataLine>(6, OLED_BASIC_FONT_START_COL_OFFSET, OLED_BASIC_FONT_ID, DATA_STEPS_TARGET));
-
-      mainPageGO.emplace_back(std::make_unique<Rectangle>(
-          Point{2, 2}, Point{static_cast<uint8_t>(oled_get_attributes().last_col - 2), static_cast<uint8_t>(oled_get_attributes().last_row - 2)}));
-
-      // Links
-      mainPageIL.emplace_back(
-          std::make_unique<InteractiveLink>(CONFIG_PAGE, TextLine("CONFIG", 1, OLED_BASIC_FONT_START_COL_OFFSET, OLED_BASIC_FONT_ID)));
-
-      // Calling page constructor
-      std::unique_ptr<Page> mainPage = std::make_unique<LinkPage>(std::move(mainPageGO), std::move(mainPageIL));
-
-      mainPage->setSelection(DEFAULT_LINK_PARAM_SELECT);
-
-      //   -------------------------------------------------------------------------------
-
-      // ################################## CONFIG_PAGE ##################################
-
-      // Helper vectors
-      std::vector<std::unique_ptr<GraphicObject>> configPageGO;
-      std::vector<std::unique_ptr<InteractiveLink>> configPageIL;
+      // Items showing data are redrawn when their data fields change
+      for(uint8_t field = 0; field < DATA_FIELD_NUM; field++) {
+        if(menuFields() & (1UL << field)) {
+          SystemData::GetInstance().subscribe(static_cast<DataField>(field), this);
+        }
+      }
 
-      // Graphic objects
-      configPageGO.emplace_back(std::make_unique<TextLine>("CONFIG", 1, getCenteredTextCol("CONFIG", OLED_BASIC_FONT_ID), OLED_BASIC_FONT_ID));
+      // ############################ Active page selection ############################
+      mActivePage = MAIN_PAGE;
+      mSelected = INITIAL_SELECTION;
+      mIsInitialized = true;
 
-      configPageGO.emplace_back(std::make_unique<Rectangle>(
-          Point{2, 2}, Point{static_cast<uint8_t>(oled_get_attributes().last_col - 2), static_cast<uint8_t>(oled_get_attributes().last_row - 2)}));
+      // Draw pages
+      drawPage();
+    }
+  }
 
-      // Links
-      configPageIL.emplace_back(
-          std::make_unique<InteractiveLink>(MAIN_PAGE, TextLine("BACK", 3, OLED_BASIC_FONT_START_COL_OFFSET, OLED_BASIC_FONT_ID)));
-      configPageIL.emplace_back(
-          std::make_unique<InteractiveLink>(MAIN_PAGE, TextLine("BACK 2", 4, OLED_BASIC_FONT_START_COL_OFFSET, OLED_BASIC_FONT_ID)));
+  void Menu::openPage(PageName page) {
+    mActivePage = page;
+    mSelected = INITIAL_SELECTION;
+  }
 
-      // Calling page constructor
-      std::unique_ptr<Page> configPage = std::make_unique<LinkPage>(std::move(configPageGO), std::move(configPageIL));
+  void Menu::drawPage(void) {
+    mDirtyFields.store(0);
+    // Set before the swap, so a frame done callback in between already sees the frame as pending
+    mIsFramePending.store(true);
+    mIsFramePending.store(!PageRenderer::draw(pageContent(MENU_LAYOUT[mActivePage]), mSelected, SystemData::GetInstance(), mDrawStats[mActivePage]));
+  }
 
-      configPage->setSelection(DEFAULT_LINK_PARAM_SELECT);
+  void Menu::pageAction(const LinkPageLayout &page, MenuAction action) {
+    switch(action) {
+    case MENU_ACTION_ENTER:
+      openPage(PageRenderer::getOption(page.content, mSelected).target);
+      break;
 
-      // -------------------------------------------------------------------------------
+    case MENU_ACTION_UP:
+      // Links are selected in a loop
+      mSelected = (mSelected + 1) % page.content.optionNum;
+      break;
 
-      // ############################ Active page selection ############################
-      mActivePage = MAIN_PAGE;
-      mIsInitialized = true;
+    case MENU_ACTION_DOWN:
+      mSelected = (0 == mSelected) ? page.content.optionNum - 1 : mSelected - 1;
+      break;
 
-      // Draw pages
-      mPages[mActivePage]->updateDataAndParams(SystemData::GetInstance());
-      mPages[mActivePage]->draw(ext_spi);
+    default:
+      throw std::invalid_argument("Invalid action.");
+      break;
     }
   }
 
-  void Menu::action(ext_spi_handle_t ext_spi, MenuAction action) {
+  void Menu::pageAction(const ParamPageLayout &page, MenuAction action) {
     switch(action) {
     case MENU_ACTION_ENTER:
-      if(auto page = dynamic_cast<LinkPage *>(mPages[mActivePage].get())) {
-        mActivePage = page->getChild();
-      } else if(auto page = dynamic_cast<ParamPage *>(mPages[mActivePage].get())) {
-        if(page->getSelected() < (page->getParamsNum() - 1)) {
-          page->changeSelection(true);
-        } else {
-          mActivePage = page->getParent();
-        }
+      if(mSelected < (page.content.optionNum - 1)) {
+        mSelected++;
       } else {
-        throw std::runtime_error("Invalid page type.");
+        openPage(page.parent);
       }
       break;
 
     case MENU_ACTION_UP:
-      if(auto page = dynamic_cast<LinkPage *>(mPages[mActivePage].get())) {
-        page->changeSelection(true);
-      } else if(auto page = dynamic_cast<ParamPage *>(mPages[mActivePage].get())) {
-        SystemData::GetInstance().changeValue(page->getSelectedParam()->getDataField(), true);
-      } else {
-        throw std::runtime_error("Invalid page type.");
-      }
+      SystemData::GetInstance().changeValue(PageRenderer::getOption(page.content, mSelected).field, SYSTEM_INCREASE_VAL);
       break;
 
     case MENU_ACTION_DOWN:
-      if(auto page = dynamic_cast<LinkPage *>(mPages[mActivePage].get())) {
-        page->changeSelection(false);
-      } else if(auto page = dynamic_cast<ParamPage *>(mPages[mActivePage].get())) {
-        SystemData::GetInstance().changeValue(page->getSelectedParam()->getDataField(), false);
-      } else {
-        throw std::runtime_error("Invalid page type.");
-      }
+      SystemData::GetInstance().changeValue(PageRenderer::getOption(page.content, mSelected).field, SYSTEM_DECREASE_VAL);
       break;
 
     default:
       throw std::invalid_argument("Invalid action.");
       break;
     }
-    mPages[mActivePage]->updateDataAndParams(SystemData::GetInstance());
-    mPages[mActivePage]->draw(ext_spi);
   }
 
-} // namespace pedometer
\ No newline at end of file
+  void Menu::action(MenuAction action) {
+    std::visit([this, action](const auto &page) { pageAction(page, action); }, MENU_LAYOUT[mActivePage]);
+    drawPage();
+  }
+
+  bool Menu::update(uint64_t nowUs) {
+    if(!mIsInitialized) {
+      return false;
+    }
+    const PageContent &page = pageContent(MENU_LAYOUT[mActivePage]);
+    uint32_t fields = 0;
+    if((nowUs - mLastFrameUs) >= MENU_FRAME_PERIOD_US) {
+      // Bits are cleared before the values are read, a change notified meanwhile is drawn in the next frame
+      fields = mDirtyFields.fetch_and(~page.fields) & page.fields;
+    }
+    if(0 == fields && !mIsFramePending.load()) {
+      return false;
+    }
+    mIsFramePending.store(true);
+    bool isPublished;
+    if(0 == fields) {
+      // The pending frame was drawn at its frame time, it only waited for the display
+      isPublished = oled_swap_buffers();
+    } else {
+      isPublished = PageRenderer::drawFields(page, mSelected, fields, SystemData::GetInstance(), mDrawStats[mActivePage]);
+      mLastFrameUs = nowUs;
+    }
+    mIsFramePending.store(!isPublished);
+    return isPublished;
+  }
+
+  uint64_t Menu::getFrameDelayUs(uint64_t nowUs) const {
+    if(!mIsInitialized || 0 == (mDirtyFields.load() & pageContent(MENU_LAYOUT[mActivePage]).fields)) {
+      return MENU_NO_FRAME;
+    }
+    uint64_t elapsedUs = nowUs - mLastFrameUs;
+    return (elapsedUs >= MENU_FRAME_PERIOD_US) ? 0 : MENU_FRAME_PERIOD_US - elapsedUs;
+  }
+
+  void Menu::onDataChanged(uint32_t fields) {
+    mDirtyFields.fetch_or(fields);
+    if(nullptr != mRedrawRequest) {
+      mRedrawRequest();
+    }
+  }
+
+  const PageDrawStats &Menu::getDrawStats(PageName page) const { return mDrawStats.at(page); }
+
+} // namespace pedometer
@@ -1,136 +1,141 @@
+#include "menu_pages.hpp"
+#include "oled_sh1106.h"
+#include "oled_sh1106_font.h"
 #include "system_data.hpp"
-#include "system_data_config.hpp"
-#include <algorithm>
-#include <cstdint>
+#include <cinttypes>
+#include <cstdio>
 #include <stdexcept>
-#include <type_traits>
 #include <variant>
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#else
+#include <chrono>
+#endif
 
-using namespace pedometer;
+namespace pedometer {
 
-SystemParam::SystemParam(std::variant<uint8_t, uint32_t, bool> value, std::variant<uint8_t, uint32_t, bool> min,
-                         std::variant<uint8_t, uint32_t, bool> max) {
-  if(std::holds_alternative<uint8_t>(value) && std::holds_alternative<uint8_t>(min) && std::holds_alternative<uint8_t>(max)) {
-    mMin = min;
-    mMax = max;
-    mValue = std::clamp(value, mMin, mMax);
-  } else if(std::holds_alternative<uint32_t>(value) && std::holds_alternative<uint32_t>(min) && std::holds_alternative<uint32_t>(max)) {
-    mMin = min;
-    mMax = max;
-    mValue = std::clamp(value, mMin, mMax);
-  } else if(std::holds_alternative<bool>(value) && std::holds_alternative<bool>(min) && std::holds_alternative<bool>(max)) {
-    mMin = false;
-    mMax = true;
-    mValue = value;
-  } else {
-    throw std::invalid_argument("All the arguments must be the same type. Available types: uint8_t, uint32_t or bool.");
+  enum : uint8_t { CURSOR_CHAR = '<', DATA_TEXT_LEN = 12 };
+
+  // Background shared by all pages, the page and the selection it was rasterized for; nullptr if it isn't valid
+  static uint8_t sBackground[OLED_BITMAP_LEN];
+  static const PageContent *sBackgroundPage = nullptr;
+  static uint8_t sBackgroundSelected = INITIAL_SELECTION;
+
+  // Time stamp for the background cache counters: CPU cycles on the target, nanoseconds on the host
+  static uint32_t getCycleCount(void) {
+#ifdef ESP_PLATFORM
+    return esp_cpu_get_cycle_count();
+#else
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
   }
-}
 
-std::variant<uint8_t, uint32_t, bool> SystemParam::getValue(void) const {
-  if(std::holds_alternative<uint8_t>(mValue) || std::holds_alternative<uint32_t>(mValue) || std::holds_alternative<bool>(mValue)) {
-    return mValue;
-  } else {
-    return (uint8_t)0;
+  // Converts the data value into the text shown on the display, returns the text length
+  static uint8_t dataToText(const std::variant<uint8_t, uint32_t, bool> &value, char *text, size_t size) {
+    int len;
+    if(std::holds_alternative<uint8_t>(value)) {
+      // Small values are clock fields -> always two digits
+      len = std::snprintf(text, size, "%02u", static_cast<unsigned>(std::get<uint8_t>(value)));
+    } else if(std::holds_alternative<uint32_t>(value)) {
+      len = std::snprintf(text, size, "%" PRIu32, std::get<uint32_t>(value));
+    } else {
+      len = std::snprintf(text, size, "%s", std::get<bool>(value) ? "ON" : "OFF");
+    }
+    return static_cast<uint8_t>(len);
   }
-}
 
-void SystemParam::setValue(std::variant<uint8_t, uint32_t, bool> value) {
-  if(std::holds_alternative<uint8_t>(mValue) && std::holds_alternative<uint8_t>(value)) {
-    mValue = std::clamp(value, mMin, mMax);
-  } else if(std::holds_alternative<uint32_t>(mValue) && std::holds_alternative<uint32_t>(value)) {
-    mValue = std::clamp(value, mMin, mMax);
-  } else if(std::holds_alternative<bool>(mValue) && std::holds_alternative<bool>(value)) {
-    mValue = value;
-  } else {
-    throw std::invalid_argument("Argument must be of uint8_t, uint32_t or bool type and the same as currently stored type.");
+  // Column of the value of the item
+  static uint8_t valueCol(const PageItem &item) {
+    return (ITEM_PARAM == item.kind) ? item.col + (textLength(item.text) + 1) * OLED_BASIC_FONT_COLS : item.col;
   }
-}
 
-void SystemParam::increaseValue(void) {
-  if(std::holds_alternative<uint8_t>(mValue)) {
-    mValue = std::clamp(static_cast<uint8_t>(std::get<uint8_t>(mValue) + 1), std::get<uint8_t>(mMin), std::get<uint8_t>(mMax));
-  } else if(std::holds_alternative<uint32_t>(mValue)) {
-    mValue = std::clamp(static_cast<uint32_t>(std::get<uint32_t>(mValue) + 1), std::get<uint32_t>(mMin), std::get<uint32_t>(mMax));
-  } else if(std::holds_alternative<bool>(mValue)) {
-    if(false == std::get<bool>(mValue)) {
-      mValue = true;
-    }
+  // Puts the value of the item into the video buffer, the value is cut to the reserved width
+  static void drawValue(const PageItem &item, const SystemData &systemData) {
+    char text[DATA_TEXT_LEN];
+    uint8_t len = dataToText(systemData.getData(item.field), text, sizeof(text));
+    oled_put_string_n(text, (len < item.width) ? len : item.width, item.page, valueCol(item), OLED_BASIC_FONT_ID);
   }
-}
 
-void SystemParam::decreaseValue(void) {
-  if(std::holds_alternative<uint8_t>(mValue)) {
-    mValue = std::clamp(static_cast<uint8_t>(std::get<uint8_t>(mValue) - 1), std::get<uint8_t>(mMin), std::get<uint8_t>(mMax));
-  } else if(std::holds_alternative<uint32_t>(mValue)) {
-    mValue = std::clamp(static_cast<uint32_t>(std::get<uint32_t>(mValue) - 1), std::get<uint32_t>(mMin), std::get<uint32_t>(mMax));
-  } else if(std::holds_alternative<bool>(mValue)) {
-    if(true == std::get<bool>(mValue)) {
-      mValue = false;
+  // Puts the static items into the video buffer
+  static void drawStatic(const PageContent &page, uint8_t selected) {
+    for(uint8_t i = 0; i < page.itemNum; i++) {
+      const PageItem &item = page.items[i];
+      if(ITEM_TEXT == item.kind || ITEM_LINK == item.kind || ITEM_PARAM == item.kind) {
+        oled_put_string(item.text, item.page, item.col, OLED_BASIC_FONT_ID);
+      }
+    }
+    if(page.optionNum > 1) {
+      oled_put_char(CURSOR_CHAR, PageRenderer::getOption(page, selected).page, OLED_BASIC_FONT_START_COL, OLED_BASIC_FONT_ID);
+    }
+    // Rectangles are drawn last, so borders aren't overwritten by characters
+    for(uint8_t i = 0; i < page.itemNum; i++) {
+      if(ITEM_RECT == page.items[i].kind) {
+        oled_put_rect(page.items[i].rect);
+      }
     }
   }
-}
 
-void SystemData::init(void) {
-  if(!mIsInitialized) {
-    mData.insert({DATA_STEPS, SystemParam(static_cast<uint32_t>(SYSTEM_STEPS_MIN), static_cast<uint32_t>(SYSTEM_STEPS_DEFAULT),
-                                          static_cast<uint32_t>(SYSTEM_STEPS_MAX))});
-    mData.insert({DATA_STEPS_TARGET, SystemParam(static_cast<uint32_t>(SYSTEM_TARGET_STEPS_MIN), static_cast<uint32_t>(SYSTEM_TARGET_STEPS_DEFAULT),
-                                                 static_cast<uint32_t>(SYSTEM_TARGET_STEPS_MAX))});
-    mData.insert({DATA_HOURS, SystemParam(static_cast<uint8_t>(SYSTEM_HOURS_MIN), static_cast<uint8_t>(SYSTEM_HOURS_DEFAULT),
-                                          static_cast<uint8_t>(SYSTEM_HOURS_MAX))});
-    mData.insert({DATA_MINUTES, SystemParam(static_cast<uint8_t>(SYSTEM_MINUTES_MIN), static_cast<uint8_t>(SYSTEM_MINUTES_DEFAULT),
-                                            static_cast<uint8_t>(SYSTEM_MINUTES_MAX))});
-    mData.insert({DATA_SECONDS, SystemParam(static_cast<uint8_t>(SYSTEM_SECONDS_MIN), static_cast<uint8_t>(SYSTEM_SECONDS_DEFAULT),
-                                            static_cast<uint8_t>(SYSTEM_SECONDS_MAX))});
-    mIsInitialized = true;
-  } else {
-    throw std::runtime_error("SystemData instance is already initialized.");
+  // Puts the background of the page into the video buffer, the background is rasterized first if it isn't valid
+  static void drawBackground(const PageContent &page, uint8_t selected, PageDrawStats &stats) {
+    if(&page != sBackgroundPage || selected != sBackgroundSelected) {
+      uint32_t start = getCycleCount();
+      oled_clear_buf();
+      drawStatic(page, selected);
+      stats.staticCycles = getCycleCount() - start;
+      stats.backgroundBuilds++;
+      oled_get_bitmap(sBackground);
+      sBackgroundPage = &page;
+      sBackgroundSelected = selected;
+    } else {
+      uint32_t start = getCycleCount();
+      oled_put_bitmap(sBackground);
+      uint32_t copyCycles = getCycleCount() - start;
+      stats.cachedFrames++;
+      if(stats.staticCycles > copyCycles) {
+        stats.savedCycles += stats.staticCycles - copyCycles;
+      }
+    }
   }
-}
 
-std::variant<uint8_t, uint32_t, bool> SystemData::getData(DataField dataField) const {
-  auto data = mData.find(dataField);
-  if(data != mData.end()) {
-    if(std::holds_alternative<uint8_t>(data->second.getValue())) {
-      return std::get<uint8_t>(data->second.getValue());
-    } else if(std::holds_alternative<uint32_t>(data->second.getValue())) {
-      return std::get<uint32_t>(data->second.getValue());
-    } else if(std::holds_alternative<bool>(data->second.getValue())) {
-      return std::get<bool>(data->second.getValue());
-    } else {
-      // throw std::invalid_argument("Invalid key.");
-      return (uint8_t)0;
+  bool PageRenderer::draw(const PageContent &page, uint8_t selected, const SystemData &systemData, PageDrawStats &stats) {
+    drawBackground(page, selected, stats);
+    for(uint8_t i = 0; i < page.itemNum; i++) {
+      const PageItem &item = page.items[i];
+      if(ITEM_DATA == item.kind || ITEM_PARAM == item.kind) {
+        drawValue(item, systemData);
+      }
     }
-  } else {
-    throw std::invalid_argument("Invalid key.");
+    // The render task sends the frame, the bus is never waited for
+    return oled_swap_buffers();
   }
-}
 
-void SystemData::setData(std::variant<uint8_t, uint32_t, bool> value, DataField dataField) {
-  auto data = mData.find(dataField);
-  if(data != mData.end()) {
-    if(std::holds_alternative<uint8_t>(data->second.getValue())) {
-      data->second.setValue(std::get<uint8_t>(value));
-    } else if(std::holds_alternative<uint32_t>(data->second.getValue())) {
-      data->second.setValue(std::get<uint32_t>(value));
-    } else if(std::holds_alternative<bool>(data->second.getValue())) {
-      data->second.setValue(std::get<bool>(value));
+  bool PageRenderer::drawFields(const PageContent &page, uint8_t selected, uint32_t fields, const SystemData &systemData, PageDrawStats &stats) {
+    if(&page != sBackgroundPage || selected != sBackgroundSelected) {
+      return draw(page, selected, systemData, stats);
     }
-  } else {
-    throw std::invalid_argument("Invalid key.");
+    for(uint8_t i = 0; i < page.itemNum; i++) {
+      const PageItem &item = page.items[i];
+      if((ITEM_DATA == item.kind || ITEM_PARAM == item.kind) && (fields & (1UL << item.field))) {
+        // The background under the reserved width is restored, so a shorter value doesn't leave old characters
+        uint8_t col = valueCol(item);
+        oled_put_bitmap_span(sBackground, item.page, col, col + item.width * OLED_BASIC_FONT_COLS - 1);
+        drawValue(item, systemData);
+      }
+    }
+    return oled_swap_buffers();
   }
-}
 
-void SystemData::changeValue(DataField dataField, bool increase) {
-  auto data = mData.find(dataField);
-  if(data != mData.end()) {
-    if(SYSTEM_INCREASE_VAL == increase) {
-      data->second.increaseValue();
-    } else {
-      data->second.decreaseValue();
+  const PageItem &PageRenderer::getOption(const PageContent &page, uint8_t option) {
+    // A page has either links or params
+    for(uint8_t i = 0; i < page.itemNum; i++) {
+      if(ITEM_LINK == page.items[i].kind || ITEM_PARAM == page.items[i].kind) {
+        if(0 == option) {
+          return page.items[i];
+        }
+        option--;
+      }
     }
-  } else {
-    throw std::invalid_argument("Invalid key.");
+    throw std::out_of_range("Selected option doesn't exist.");
   }
-}
+
+} // namespace pedometer
@@ -1,9 +1,9 @@
 #ifndef OLED_SH1106_H
 #define OLED_SH1106_H
 
-#include "driver/gpio.h"
-#include "driver/spi_master.h"
 #include "oled_sh1106_config.h"
+#include "oled_sh1106_gfx.h"
+#include "oled_sh1106_port.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
@@ -15,37 +15,11 @@ extern "C" {
 // Additional defines
 #define OLED_UNIT_BUF_LEN OLED_WIDTH
 #define OLED_STRING_OFFSET 5
-
-enum { OLED_COLOR_BLACK = false, OLED_COLOR_WHITE = true };
-
-enum { OLED_SHAPE_NOT_FILLED = false, OLED_SHAPE_FILLED = true };
+#define OLED_CMD_BURST_LEN 32
+#define OLED_CURSOR_CMDS_LEN 3
 
 // ---------------------------------------------------------------------------------
 
-/**
- * @brief Stores parameters of an OLED display;
- */
-typedef struct {
-  uint8_t rows;
-  uint8_t first_row;
-  uint8_t last_row;
-  uint8_t first_page;
-  uint8_t last_page;
-  uint8_t pages;
-  uint8_t columns;
-  uint8_t first_col;
-  uint8_t last_col;
-} oled_attributes_t;
-
-/**
- * @brief Struct that stores pointers to SPI device handler and other required pins
- */
-typedef struct {
-  spi_device_handle_t spi;
-  gpio_num_t dc;  // Data or command GPIO
-  gpio_num_t res; // Reset
-} ext_spi_handle_t;
-
 /**
  * @brief Structure of a single command;
  */
@@ -54,44 +28,6 @@ typedef struct {
   uint8_t dc;  // Command or data type
 } oled_cmd_t;
 
-/**
- * @brief Structure representing a point - pixel;
- */
-typedef struct {
-  uint8_t x;  // x coordinate
-  uint8_t y;  // y coordinate
-  bool color; // Color -> OLED_COLOR_WHITE for white, OLED_COLOR_BLACK for black
-} oled_point_t;
-
-/**
- * @brief Structure representing a line;
- */
-typedef struct {
-  uint8_t orig_x; // Origin point -> x coordinate
-  uint8_t orig_y; // Origin point -> y coordinate
-  uint8_t len;    // Length of the line
-  bool color;     // Color -> OLED_COLOR_WHITE for white, OLED_COLOR_BLACK for black; point color isn't used
-} oled_line_t;
-
-/**
- * @brief Structure representing a rectangle;
- */
-typedef struct {
-  uint8_t orig_x; // Origin point -> x coordinate
-  uint8_t orig_y; // Origin point -> y coordinate
-  uint8_t end_x;  // End point -> x coordinate
-  uint8_t end_y;  // End point -> y coordinate
-  bool color;     // Color -> OLED_COLOR_WHITE for white, OLED_COLOR_BLACK for black; point color isn't used
-  bool fill;      // Fill -> OLED_SHAPE_FILLED for filling, OLED_SHAPE_NOT_FILLED for borders only
-} oled_rect_t;
-
-/**
- * @brief Gets the attributes of the OLED display.
- *
- * @return oled_attributes_t structure containing the attributes of the OLED display.
- */
-oled_attributes_t oled_get_attributes(void);
-
 /**
  * @brief Initialization of OLED display.
  *
@@ -113,105 +49,27 @@ void oled_init(ext_spi_handle_t ext_spi);
 void oled_clear_display(ext_spi_handle_t ext_spi);
 
 /**
- * @brief Clears the video buffer.
- *
- * Clears the video buffer by setting values of all pixels to 0x00
- *
- * @return void
- */
-void oled_clear_buf(void);
-
-/**
- * @brief Puts a point into the video buffer.
- *
- * @param point point to draw
- *
- * @return void
- *
- * @note The point is put into the video buffer, but not rendered immediately.
- */
-void oled_put_point(oled_point_t point);
-
-/**
- * @brief Puts a vertical line into the video buffer.
- *
- * @param line line with it's beginning and length
- *
- * @return void
- *
- * @note The line is put into the video buffer, but not rendered immediately.
- */
-void oled_put_vline(oled_line_t line);
-
-/**
- * @brief Puts a horizontal line into the video buffer.
- *
- * @param line line with it's beginning and length
- *
- * @return void
- *
- * @note The line is put into the video buffer, but not rendered immediately.
- */
-void oled_put_hline(oled_line_t line);
-
-/**
- * @brief Puts a rectangle into the video buffer.
- *
- * @param rect rectangle with it's beggining and end point, can be filled
- *
- * @return void
- *
- * @note The rectangle is put into the video buffer, but not rendered immediately.
- */
-void oled_put_rect(oled_rect_t rect);
-
-/**
- * @brief Puts a character at given location into the video buffer.
- *
- * @param c character
- * @param page page
- * @param col column
- * @param font_id font ID to use for the character
- *
- * @return void
+ * @brief Renders the display by sending all data from video buffer.
  *
- * @note The character is put into the video buffer, but not rendered immediately.
- */
-void oled_put_char(const char c, uint8_t page, uint8_t col, uint8_t font_id);
-
-/**
- * @brief Puts a string at given location into the video buffer.
+ * Every page is sent as a single command burst (page and column address) followed by a single data burst.
  *
- * @param str string
- * @param page page
- * @param col column
- * @param font_id font ID to use for the string
+ * @param ext_spi expanded SPI device handle to use for communication.
  *
  * @return void
- *
- * @note The string is put into the video buffer, but not rendered immediately.
  */
-void oled_put_string(const char *str, uint8_t page, uint8_t col, uint8_t font_id);
+void oled_render(ext_spi_handle_t ext_spi);
 
 /**
- * @brief Puts a given bitmap into the video buffer.
- *
- * @param bitmap bitmap to draw
+ * @brief Renders only the changed part of the display.
  *
- * @return void
- *
- * @note The bitmap is put into the video buffer, but not rendered immediately.
- */
-void oled_put_bitmap(const uint8_t *bitmap);
-
-/**
- * @brief Renders the display by sending all data from video buffer.
+ * Every oled_put_* call records the touched columns of each page. Only the bytes within these spans that differ
+ * from the previously rendered content are sent, using the column address commands. The dirty state is cleared afterwards.
  *
  * @param ext_spi expanded SPI device handle to use for communication.
  *
  * @return void
  */
-void oled_render(ext_spi_handle_t ext_spi);
+void oled_render_dirty(ext_spi_handle_t ext_spi);
 
 /**
  * @brief Turns off the display -> sleep mode enabled
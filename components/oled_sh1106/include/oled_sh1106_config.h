@@ -9,6 +9,8 @@ extern "C" {
 
 enum { OLED_WIDTH = 128, OLED_HEIGHT = 64, OLED_NUM_PAGES = 8 };
 
+enum { OLED_RENDER_TASK_STACK = 2048, OLED_RENDER_TASK_PRIO = 5 };
+
 #ifdef __cplusplus
 }
 #endif
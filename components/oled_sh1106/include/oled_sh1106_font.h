@@ -13,54 +13,75 @@ enum { OLED_BASIC_FONT_COLS = 8 };
 
 enum { OLED_BASIC_FONT_START_COL = 0, OLED_BASIC_FONT_START_COL_OFFSET = OLED_BASIC_FONT_COLS };
 
+enum { OLED_FONT_INDEX_LEN = 128 }; // ASCII characters
+
 typedef struct {
   uint8_t c[OLED_BASIC_FONT_COLS]; // 8 bytes per character
 } oled_basic_font_t;
 
-static const char oled_font_characters[] = {' ', 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S',
-                                            'T', 'U', 'V', 'W', 'X', 'Y', 'Z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '<', ':'};
+// Glyphs of the basic font: X(glyph name, character, 8 columns of the glyph)
+#define OLED_BASIC_FONT_GLYPHS(X) \
+  X(SPACE, ' ', 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00) \
+  X(LETTER_A, 'A', 0x78, 0x14, 0x12, 0x11, 0x12, 0x14, 0x78, 0x00) \
+  X(LETTER_B, 'B', 0x7F, 0x49, 0x49, 0x49, 0x49, 0x49, 0x7F, 0x00) \
+  X(LETTER_C, 'C', 0x7E, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x00) \
+  X(LETTER_D, 'D', 0x7F, 0x41, 0x41, 0x41, 0x41, 0x41, 0x7E, 0x00) \
+  X(LETTER_E, 'E', 0x7F, 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x00) \
+  X(LETTER_F, 'F', 0x7F, 0x09, 0x09, 0x09, 0x09, 0x01, 0x01, 0x00) \
+  X(LETTER_G, 'G', 0x7F, 0x41, 0x41, 0x41, 0x51, 0x51, 0x73, 0x00) \
+  X(LETTER_H, 'H', 0x7F, 0x08, 0x08, 0x08, 0x08, 0x08, 0x7F, 0x00) \
+  X(LETTER_I, 'I', 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x00) \
+  X(LETTER_J, 'J', 0x21, 0x41, 0x41, 0x3F, 0x01, 0x01, 0x01, 0x00) \
+  X(LETTER_K, 'K', 0x00, 0x7F, 0x08, 0x08, 0x14, 0x22, 0x41, 0x00) \
+  X(LETTER_L, 'L', 0x7F, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00) \
+  X(LETTER_M, 'M', 0x7F, 0x02, 0x04, 0x08, 0x04, 0x02, 0x7F, 0x00) \
+  X(LETTER_N, 'N', 0x7F, 0x02, 0x04, 0x08, 0x10, 0x20, 0x7F, 0x00) \
+  X(LETTER_O, 'O', 0x3E, 0x41, 0x41, 0x41, 0x41, 0x41, 0x3E, 0x00) \
+  X(LETTER_P, 'P', 0x7F, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00) \
+  X(LETTER_Q, 'Q', 0x3E, 0x41, 0x41, 0x49, 0x51, 0x61, 0x7E, 0x00) \
+  X(LETTER_R, 'R', 0x7F, 0x11, 0x11, 0x11, 0x31, 0x51, 0x0E, 0x00) \
+  X(LETTER_S, 'S', 0x46, 0x49, 0x49, 0x49, 0x49, 0x30, 0x00, 0x00) \
+  X(LETTER_T, 'T', 0x01, 0x01, 0x01, 0x7F, 0x01, 0x01, 0x01, 0x00) \
+  X(LETTER_U, 'U', 0x3F, 0x40, 0x40, 0x40, 0x40, 0x40, 0x3F, 0x00) \
+  X(LETTER_V, 'V', 0x0F, 0x10, 0x20, 0x40, 0x20, 0x10, 0x0F, 0x00) \
+  X(LETTER_W, 'W', 0x7F, 0x20, 0x10, 0x08, 0x10, 0x20, 0x7F, 0x00) \
+  X(LETTER_X, 'X', 0x00, 0x41, 0x22, 0x14, 0x14, 0x22, 0x41, 0x00) \
+  X(LETTER_Y, 'Y', 0x01, 0x02, 0x04, 0x78, 0x04, 0x02, 0x01, 0x00) \
+  X(LETTER_Z, 'Z', 0x41, 0x43, 0x59, 0x45, 0x43, 0x41, 0x00, 0x00) \
+  X(DIGIT_0, '0', 0x3E, 0x41, 0x41, 0x49, 0x41, 0x41, 0x3E, 0x00) \
+  X(DIGIT_1, '1', 0x00, 0x00, 0x42, 0x7F, 0x40, 0x00, 0x00, 0x00) \
+  X(DIGIT_2, '2', 0x30, 0x49, 0x49, 0x49, 0x49, 0x46, 0x00, 0x00) \
+  X(DIGIT_3, '3', 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36, 0x00) \
+  X(DIGIT_4, '4', 0x3F, 0x20, 0x20, 0x78, 0x20, 0x20, 0x00, 0x00) \
+  X(DIGIT_5, '5', 0x4F, 0x49, 0x49, 0x49, 0x49, 0x30, 0x00, 0x00) \
+  X(DIGIT_6, '6', 0x3F, 0x48, 0x48, 0x48, 0x48, 0x48, 0x30, 0x00) \
+  X(DIGIT_7, '7', 0x01, 0x01, 0x01, 0x61, 0x31, 0x0D, 0x03, 0x00) \
+  X(DIGIT_8, '8', 0x36, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36, 0x00) \
+  X(DIGIT_9, '9', 0x06, 0x09, 0x09, 0x09, 0x09, 0x09, 0x7F, 0x00) \
+  X(CURSOR, '<', 0x00, 0x00, 0x81, 0x42, 0x24, 0x18, 0x00, 0x00) \
+  X(COLON, ':', 0x00, 0x00, 0x00, 0x33, 0x33, 0x00, 0x00, 0x00)
+
+// Glyph indices, the replacement glyph is drawn for every character that is not in the font
+typedef enum {
+  OLED_BASIC_GLYPH_REPLACEMENT = 0,
+#define OLED_BASIC_GLYPH_ENUM(name, character, ...) OLED_BASIC_GLYPH_##name,
+  OLED_BASIC_FONT_GLYPHS(OLED_BASIC_GLYPH_ENUM)
+#undef OLED_BASIC_GLYPH_ENUM
+  OLED_BASIC_GLYPH_NUM
+} oled_basic_glyph_t;
+
+// Glyph data, defined once in oled_sh1106_font.c and placed in flash
+extern const oled_basic_font_t oled_basic_font_lut[OLED_BASIC_GLYPH_NUM];
 
-static const oled_basic_font_t oled_basic_font_lut[] = {
-    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // Nothing
-    {{0x78, 0x14, 0x12, 0x11, 0x12, 0x14, 0x78, 0x00}}, // A
-    {{0x7F, 0x49, 0x49, 0x49, 0x49, 0x49, 0x7F, 0x00}}, // B
-    {{0x7E, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x00}}, // C
-    {{0x7F, 0x41, 0x41, 0x41, 0x41, 0x41, 0x7E, 0x00}}, // D
-    {{0x7F, 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x00}}, // E
-    {{0x7F, 0x09, 0x09, 0x09, 0x09, 0x01, 0x01, 0x00}}, // F
-    {{0x7F, 0x41, 0x41, 0x41, 0x51, 0x51, 0x73, 0x00}}, // G
-    {{0x7F, 0x08, 0x08, 0x08, 0x08, 0x08, 0x7F, 0x00}}, // H
-    {{0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x00}}, // I
-    {{0x21, 0x41, 0x41, 0x3F, 0x01, 0x01, 0x01, 0x00}}, // J
-    {{0x00, 0x7F, 0x08, 0x08, 0x14, 0x22, 0x41, 0x00}}, // K
-    {{0x7F, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00}}, // L
-    {{0x7F, 0x02, 0x04, 0x08, 0x04, 0x02, 0x7F, 0x00}}, // M
-    {{0x7F, 0x02, 0x04, 0x08, 0x10, 0x20, 0x7F, 0x00}}, // N
-    {{0x3E, 0x41, 0x41, 0x41, 0x41, 0x41, 0x3E, 0x00}}, // O
-    {{0x7F, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00}}, // P
-    {{0x3E, 0x41, 0x41, 0x49, 0x51, 0x61, 0x7E, 0x00}}, // Q
-    {{0x7F, 0x11, 0x11, 0x11, 0x31, 0x51, 0x0E, 0x00}}, // R
-    {{0x46, 0x49, 0x49, 0x49, 0x49, 0x30, 0x00, 0x00}}, // S
-    {{0x01, 0x01, 0x01, 0x7F, 0x01, 0x01, 0x01, 0x00}}, // T
-    {{0x3F, 0x40, 0x40, 0x40, 0x40, 0x40, 0x3F, 0x00}}, // U
-    {{0x0F, 0x10, 0x20, 0x40, 0x20, 0x10, 0x0F, 0x00}}, // V
-    {{0x7F, 0x20, 0x10, 0x08, 0x10, 0x20, 0x7F, 0x00}}, // W
-    {{0x00, 0x41, 0x22, 0x14, 0x14, 0x22, 0x41, 0x00}}, // X
-    {{0x01, 0x02, 0x04, 0x78, 0x04, 0x02, 0x01, 0x00}}, // Y
-    {{0x41, 0x43, 0x59, 0x45, 0x43, 0x41, 0x00, 0x00}}, // Z
-    {{0x3E, 0x41, 0x41, 0x49, 0x41, 0x41, 0x3E, 0x00}}, // 0
-    {{0x00, 0x00, 0x42, 0x7F, 0x40, 0x00, 0x00, 0x00}}, // 1
-    {{0x30, 0x49, 0x49, 0x49, 0x49, 0x46, 0x00, 0x00}}, // 2
-    {{0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36, 0x00}}, // 3
-    {{0x3F, 0x20, 0x20, 0x78, 0x20, 0x20, 0x00, 0x00}}, // 4
-    {{0x4F, 0x49, 0x49, 0x49, 0x49, 0x30, 0x00, 0x00}}, // 5
-    {{0x3F, 0x48, 0x48, 0x48, 0x48, 0x48, 0x30, 0x00}}, // 6
-    {{0x01, 0x01, 0x01, 0x61, 0x31, 0x0D, 0x03, 0x00}}, // 7
-    {{0x36, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36, 0x00}}, // 8
-    {{0x06, 0x09, 0x09, 0x09, 0x09, 0x09, 0x7F, 0x00}}, // 9
-    {{0x00, 0x00, 0x81, 0x42, 0x24, 0x18, 0x00, 0x00}}, // >
-    {{0x00, 0x00, 0x00, 0x33, 0x33, 0x00, 0x00, 0x00}}  // :
-};
+// ASCII code to glyph index, generated at compile time from OLED_BASIC_FONT_GLYPHS
+extern const uint8_t oled_basic_font_index[OLED_FONT_INDEX_LEN];
+
+/**
+ * @brief Returns the glyph index of a character, OLED_BASIC_GLYPH_REPLACEMENT if the character is not in the font.
+ */
+static inline uint8_t oled_basic_font_glyph(char c) {
+  return ((uint8_t)c < OLED_FONT_INDEX_LEN) ? oled_basic_font_index[(uint8_t)c] : (uint8_t)OLED_BASIC_GLYPH_REPLACEMENT;
+}
 
 #ifdef __cplusplus
 }
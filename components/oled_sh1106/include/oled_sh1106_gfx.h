@@ -0,0 +1,215 @@
+#ifndef OLED_SH1106_GFX_H
+#define OLED_SH1106_GFX_H
+
+#include "oled_sh1106_config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum { OLED_COLOR_BLACK = false, OLED_COLOR_WHITE = true };
+
+enum { OLED_SHAPE_NOT_FILLED = false, OLED_SHAPE_FILLED = true };
+
+enum { OLED_BITMAP_LEN = OLED_NUM_PAGES * OLED_WIDTH }; // Size of a full screen bitmap in the video buffer layout
+
+// ---------------------------------------------------------------------------------
+
+/**
+ * @brief Stores parameters of an OLED display;
+ */
+typedef struct {
+  uint8_t rows;
+  uint8_t first_row;
+  uint8_t last_row;
+  uint8_t first_page;
+  uint8_t last_page;
+  uint8_t pages;
+  uint8_t columns;
+  uint8_t first_col;
+  uint8_t last_col;
+} oled_attributes_t;
+
+/**
+ * @brief Structure representing a span of columns within a single page;
+ */
+typedef struct {
+  uint8_t min_col; // First column of the span
+  uint8_t max_col; // Last column of the span
+} oled_span_t;
+
+/**
+ * @brief Structure representing a point - pixel;
+ */
+typedef struct {
+  uint8_t x;  // x coordinate
+  uint8_t y;  // y coordinate
+  bool color; // Color -> OLED_COLOR_WHITE for white, OLED_COLOR_BLACK for black
+} oled_point_t;
+
+/**
+ * @brief Structure representing a line;
+ */
+typedef struct {
+  uint8_t orig_x; // Origin point -> x coordinate
+  uint8_t orig_y; // Origin point -> y coordinate
+  uint8_t len;    // Length of the line
+  bool color;     // Color -> OLED_COLOR_WHITE for white, OLED_COLOR_BLACK for black; point color isn't used
+} oled_line_t;
+
+/**
+ * @brief Structure representing a rectangle;
+ */
+typedef struct {
+  uint8_t orig_x; // Origin point -> x coordinate
+  uint8_t orig_y; // Origin point -> y coordinate
+  uint8_t end_x;  // End point -> x coordinate
+  uint8_t end_y;  // End point -> y coordinate
+  bool color;     // Color -> OLED_COLOR_WHITE for white, OLED_COLOR_BLACK for black; point color isn't used
+  bool fill;      // Fill -> OLED_SHAPE_FILLED for filling, OLED_SHAPE_NOT_FILLED for borders only
+} oled_rect_t;
+
+/**
+ * @brief Gets the attributes of the OLED display.
+ *
+ * @return oled_attributes_t structure containing the attributes of the OLED display.
+ */
+oled_attributes_t oled_get_attributes(void);
+
+/**
+ * @brief Clears the video buffer.
+ *
+ * Clears the video buffer by setting values of all pixels to 0x00
+ *
+ * @return void
+ */
+void oled_clear_buf(void);
+
+/**
+ * @brief Puts a point into the video buffer.
+ *
+ * @param point point to draw
+ *
+ * @return void
+ *
+ * @note The point is put into the video buffer, but not rendered immediately.
+ */
+void oled_put_point(oled_point_t point);
+
+/**
+ * @brief Puts a vertical line into the video buffer.
+ *
+ * @param line line with it's beginning and length
+ *
+ * @return void
+ *
+ * @note The line is put into the video buffer, but not rendered immediately.
+ */
+void oled_put_vline(oled_line_t line);
+
+/**
+ * @brief Puts a horizontal line into the video buffer.
+ *
+ * @param line line with it's beginning and length
+ *
+ * @return void
+ *
+ * @note The line is put into the video buffer, but not rendered immediately.
+ */
+void oled_put_hline(oled_line_t line);
+
+/**
+ * @brief Puts a rectangle into the video buffer.
+ *
+ * @param rect rectangle with it's beggining and end point, can be filled
+ *
+ * @return void
+ *
+ * @note The rectangle is put into the video buffer, but not rendered immediately.
+ */
+void oled_put_rect(oled_rect_t rect);
+
+/**
+ * @brief Puts a character at given location into the video buffer.
+ *
+ * @param c character
+ * @param page page
+ * @param col column
+ * @param font_id font ID to use for the character
+ *
+ * @return void
+ *
+ * @note The character is put into the video buffer, but not rendered immediately.
+ */
+void oled_put_char(const char c, uint8_t page, uint8_t col, uint8_t font_id);
+
+/**
+ * @brief Puts a string at given location into the video buffer.
+ *
+ * @param str string
+ * @param page page
+ * @param col column
+ * @param font_id font ID to use for the string
+ *
+ * @return void
+ *
+ * @note The string is put into the video buffer, but not rendered immediately.
+ */
+void oled_put_string(const char *str, uint8_t page, uint8_t col, uint8_t font_id);
+
+/**
+ * @brief Puts a string of known length at given location into the video buffer.
+ *
+ * @param str string, doesn't have to be null-terminated
+ * @param len number of characters to put
+ * @param page page
+ * @param col column
+ * @param font_id font ID to use for the string
+ *
+ * @return void
+ *
+ * @note The string is put into the video buffer, but not rendered immediately.
+ */
+void oled_put_string_n(const char *str, size_t len, uint8_t page, uint8_t col, uint8_t font_id);
+
+/**
+ * @brief Puts a given bitmap into the video buffer.
+ *
+ * @param bitmap bitmap to draw, OLED_BITMAP_LEN bytes in the video buffer layout
+ *
+ * @return void
+ *
+ * @note The bitmap is put into the video buffer, but not rendered immediately.
+ */
+void oled_put_bitmap(const uint8_t *bitmap);
+
+/**
+ * @brief Copies the video buffer into a bitmap, e.g. to cache a pre-rasterized background.
+ *
+ * @param bitmap destination, OLED_BITMAP_LEN bytes in the video buffer layout
+ *
+ * @return void
+ */
+void oled_get_bitmap(uint8_t *bitmap);
+
+/**
+ * @brief Puts a column span of a single page of the given bitmap into the video buffer, e.g. to restore the background
+ *        under a redrawn object.
+ *
+ * @param bitmap bitmap to copy from, OLED_BITMAP_LEN bytes in the video buffer layout
+ * @param page page of the span
+ * @param first_col first column of the span
+ * @param last_col last column of the span
+ *
+ * @return void
+ */
+void oled_put_bitmap_span(const uint8_t *bitmap, uint8_t page, uint8_t first_col, uint8_t last_col);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OLED_SH1106_GFX_H
@@ -0,0 +1,50 @@
+#ifndef OLED_SH1106_TRANSPORT_H
+#define OLED_SH1106_TRANSPORT_H
+
+#include "oled_sh1106_port.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Display transport used by the driver core. Every port implements these functions:
+// port/esp  - SPI master, D/C and reset GPIOs, FreeRTOS delays;
+// port/host - simulated SH1106 controller for tests and benchmarks on PC.
+
+/**
+ * @brief Resets the display controller (hardware reset line).
+ *
+ * @param ext_spi expanded SPI device handle to use for communication.
+ *
+ * @return void
+ */
+void oled_transport_reset(ext_spi_handle_t ext_spi);
+
+/**
+ * @brief Sends a burst of command or data bytes with a single D/C level.
+ *
+ * @param ext_spi expanded SPI device handle to use for communication.
+ * @param buf bytes to send; must stay valid until the function returns
+ * @param len number of bytes
+ * @param dc OLED_CMD for commands, OLED_DATA for display RAM data
+ *
+ * @return void
+ */
+void oled_transport_write(ext_spi_handle_t ext_spi, const uint8_t *buf, size_t len, uint8_t dc);
+
+/**
+ * @brief Waits the given time, e.g. after reset or while the splash screen is shown.
+ *
+ * @param ms time in milliseconds
+ *
+ * @return void
+ */
+void oled_transport_delay_ms(uint32_t ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OLED_SH1106_TRANSPORT_H
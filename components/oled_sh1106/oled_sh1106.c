@@ -1,26 +1,19 @@
 #include "oled_sh1106.h"
-#include "driver/gpio.h"
-#include "driver/spi_master.h"
-#include "freertos/task.h"
 #include "oled_sh1106_commands.h"
 #include "oled_sh1106_config.h"
+#include "oled_sh1106_fb.h"
 #include "oled_sh1106_font.h"
-#include "sdkconfig.h"
+#include "oled_sh1106_transport.h"
 #include <assert.h>
 #include <string.h>
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define DMA_ATTR
+#endif
 
-static const oled_attributes_t oled_sh1106_attributes = {.rows = OLED_HEIGHT,
-                                                         .first_row = 0x00,
-                                                         .last_row = OLED_HEIGHT - 1,
-                                                         .columns = OLED_WIDTH,
-                                                         .first_page = 0x00,
-                                                         .last_page = OLED_NUM_PAGES - 1,
-                                                         .first_col = 0x00,
-                                                         .last_col = OLED_WIDTH - 1,
-                                                         .pages = OLED_NUM_PAGES};
-
-// Buffer for the display
-static uint8_t oled_buf[OLED_HEIGHT / 8][OLED_WIDTH];
+// Published frame (front buffer): the last rendered content, DMA source of the render task in asynchronous mode
+DMA_ATTR uint8_t oled_front_buf[OLED_NUM_PAGES][OLED_WIDTH];
 
 // Command sequence for proper initialization of the OLED display
 static const oled_cmd_t init_cmds_seq[] = {
@@ -38,178 +31,84 @@ static const oled_cmd_t init_cmds_seq[] = {
     {.cmd = OLED_DISPLAY_POSITIVE, .dc = OLED_CMD},
 };
 
-oled_attributes_t oled_get_attributes(void) { return oled_sh1106_attributes; }
-
-void oled_clear_buf(void) {
-  for(uint8_t page = oled_sh1106_attributes.first_page; page <= oled_sh1106_attributes.last_page; page++) {
-    memset(oled_buf[page], 0x00, oled_sh1106_attributes.columns);
+oled_span_t oled_trim_dirty(uint8_t page) {
+  oled_span_t span = oled_dirty[page];
+  // Skip bytes that were redrawn with the same content, e.g. after clearing and drawing the same text again
+  while(span.min_col <= span.max_col && oled_buf[page][span.min_col] == oled_front_buf[page][span.min_col]) {
+    span.min_col++;
   }
+  while(span.min_col <= span.max_col && oled_buf[page][span.max_col] == oled_front_buf[page][span.max_col]) {
+    span.max_col--;
+  }
+  return span;
 }
 
-void oled_send_cmd(ext_spi_handle_t ext_spi, const oled_cmd_t oled_cmd) {
-  esp_err_t ret;
-  spi_transaction_t t;
-  memset(&t, 0, sizeof(t));
-  t.length = 8;
-  t.tx_buffer = &(oled_cmd.cmd);
-  ret = gpio_set_level(ext_spi.dc, oled_cmd.dc);
-  ESP_ERROR_CHECK(ret);
-  ret = spi_device_polling_transmit(ext_spi.spi, &t);
-  ESP_ERROR_CHECK(ret);
-}
+void oled_send_cmd(ext_spi_handle_t ext_spi, const oled_cmd_t oled_cmd) { oled_transport_write(ext_spi, &(oled_cmd.cmd), 1, oled_cmd.dc); }
 
-void oled_send_cmd_list(ext_spi_handle_t ext_spi, oled_cmd_t const *commands) {
-  for(int i = 0; i < sizeof(commands); i++) {
-    oled_send_cmd(ext_spi, commands[i]);
+void oled_send_cmd_list(ext_spi_handle_t ext_spi, oled_cmd_t const *commands, size_t len) {
+  // Consecutive bytes of the same type are grouped, so D/C changes only on command/data boundary
+  uint8_t burst[OLED_CMD_BURST_LEN];
+  size_t burst_len = 0;
+  for(size_t i = 0; i < len; i++) {
+    burst[burst_len++] = commands[i].cmd;
+    if(i == len - 1 || commands[i + 1].dc != commands[i].dc || burst_len == OLED_CMD_BURST_LEN) {
+      oled_transport_write(ext_spi, burst, burst_len, commands[i].dc);
+      burst_len = 0;
+    }
   }
 }
 
 void oled_init(ext_spi_handle_t ext_spi) {
   // Display hardware reset
-  esp_err_t ret;
-  ret = gpio_set_level(ext_spi.res, 0);
-  ESP_ERROR_CHECK(ret);
-  vTaskDelay(pdMS_TO_TICKS(100));
-  ret = gpio_set_level(ext_spi.res, 1);
-  ESP_ERROR_CHECK(ret);
-  vTaskDelay(pdMS_TO_TICKS(100));
+  oled_transport_reset(ext_spi);
   // Send initialization commands, clear buffer and render empty display
-  oled_send_cmd_list(ext_spi, init_cmds_seq);
+  oled_send_cmd_list(ext_spi, init_cmds_seq, sizeof(init_cmds_seq) / sizeof(init_cmds_seq[0]));
   oled_clear_buf();
   oled_put_string("PEDOMETER", 4, 10, OLED_BASIC_FONT_ID);
   oled_render(ext_spi);
-  vTaskDelay(pdMS_TO_TICKS(5000));
+  oled_transport_delay_ms(5000);
 }
 
-void oled_cursor_allign_left(ext_spi_handle_t ext_spi) {
-  oled_cmd_t cmd;
-  cmd.cmd = OLED_BASE_COL_ADDR_H;
-  cmd.dc = OLED_CMD;
-  oled_send_cmd(ext_spi, cmd);
-  cmd.cmd = OLED_BASE_COL_ADDR_L;
-  cmd.dc = OLED_CMD;
-  oled_send_cmd(ext_spi, cmd);
+void oled_cursor_cmds(uint8_t page, uint8_t col, uint8_t *cmds) {
+  assert(page >= oled_sh1106_attributes.first_page && page <= oled_sh1106_attributes.last_page);
+  assert(col >= oled_sh1106_attributes.first_col && col <= oled_sh1106_attributes.last_col);
+  // Column address is shifted by the base column, SH1106 RAM is 132 columns wide
+  uint8_t addr = OLED_BASE_COL_ADDR_L + col;
+  cmds[0] = OLED_FIRST_PAGE_ADDR + page;
+  cmds[1] = OLED_BASE_COL_ADDR_H | (addr >> 4);
+  cmds[2] = addr & 0x0F;
 }
 
-void oled_set_page(ext_spi_handle_t ext_spi, uint8_t page) {
-  assert(page >= oled_sh1106_attributes.first_page && page <= oled_sh1106_attributes.last_page);
-  oled_cmd_t cmd;
-  cmd.cmd = OLED_FIRST_PAGE_ADDR + page;
-  cmd.dc = OLED_CMD;
-  oled_send_cmd(ext_spi, cmd);
+void oled_set_cursor(ext_spi_handle_t ext_spi, uint8_t page, uint8_t col) {
+  uint8_t cmds[OLED_CURSOR_CMDS_LEN];
+  oled_cursor_cmds(page, col, cmds);
+  oled_transport_write(ext_spi, cmds, sizeof(cmds), OLED_CMD);
 }
 
 void oled_render(ext_spi_handle_t ext_spi) {
-  oled_cmd_t cmd;
   for(uint8_t page = oled_sh1106_attributes.first_page; page <= oled_sh1106_attributes.last_page; page++) {
-    oled_cursor_allign_left(ext_spi);
-    oled_set_page(ext_spi, page);
-    for(uint8_t col = oled_sh1106_attributes.first_col; col <= oled_sh1106_attributes.last_col; col++) {
-      cmd.cmd = oled_buf[page][col];
-      cmd.dc = OLED_DATA;
-      oled_send_cmd(ext_spi, cmd);
-    }
+    oled_set_cursor(ext_spi, page, oled_sh1106_attributes.first_col);
+    oled_transport_write(ext_spi, oled_buf[page], oled_sh1106_attributes.columns, OLED_DATA);
   }
+  memcpy(oled_front_buf, oled_buf, sizeof(oled_buf));
+  oled_mark_clean(oled_dirty);
 }
 
-void oled_clear_display(ext_spi_handle_t ext_spi) {
-  oled_clear_buf();
-  oled_render(ext_spi);
-}
-
-void oled_put_point(oled_point_t point) {
-  assert(oled_sh1106_attributes.first_col <= point.x && oled_sh1106_attributes.last_col >= point.x);
-  assert(oled_sh1106_attributes.first_row <= point.y && oled_sh1106_attributes.last_row >= point.y);
-  uint8_t page = point.y / 8;
-  uint8_t bit = 1 << (point.y % 8);
-  if(OLED_COLOR_WHITE == point.color) {
-    oled_buf[page][point.x] |= bit;
-  } else {
-    oled_buf[page][point.x] &= ~bit;
-  }
-}
-
-void oled_put_vline(oled_line_t line) {
-  assert(oled_sh1106_attributes.first_col <= line.orig_x && oled_sh1106_attributes.last_col >= line.orig_x);
-  assert(oled_sh1106_attributes.first_row <= line.orig_y && oled_sh1106_attributes.last_row >= (line.orig_y + line.len - 1));
-  for(uint8_t pt = 0; pt < line.len; pt++) {
-    oled_put_point((oled_point_t){.x = line.orig_x, .y = line.orig_y + pt, .color = line.color});
-  }
-}
-
-void oled_put_hline(oled_line_t line) {
-  assert(oled_sh1106_attributes.first_col <= line.orig_x && oled_sh1106_attributes.last_col >= (line.orig_x + line.len - 1));
-  assert(oled_sh1106_attributes.first_row <= line.orig_y && oled_sh1106_attributes.last_row >= line.orig_y);
-  for(uint8_t pt = 0; pt < line.len; pt++) {
-    oled_put_point((oled_point_t){.x = line.orig_x + pt, .y = line.orig_y, .color = line.color});
-  }
-}
-
-void oled_put_rect(oled_rect_t rect) {
-  assert(oled_sh1106_attributes.first_col <= rect.orig_x && oled_sh1106_attributes.last_col >= rect.orig_x);
-  assert(oled_sh1106_attributes.first_col <= rect.end_x && oled_sh1106_attributes.last_col >= rect.end_x);
-  assert(oled_sh1106_attributes.first_row <= rect.orig_y && oled_sh1106_attributes.last_row >= rect.orig_y);
-  assert(oled_sh1106_attributes.first_row <= rect.end_y && oled_sh1106_attributes.last_row >= rect.end_y);
-  if(OLED_SHAPE_FILLED == rect.fill) {
-    // Fill the rectangle with points
-    for(uint8_t col = rect.orig_x; col <= rect.end_x; col++) {
-      for(uint8_t row = rect.orig_y; row <= rect.end_y; row++) {
-        oled_put_point((oled_point_t){.x = col, .y = row, .color = rect.color});
-      }
-    }
-  } else {
-    // Drawing border
-    // Draw horizontal border lines
-    oled_put_hline((oled_line_t){.orig_x = rect.orig_x, .orig_y = rect.orig_y, .len = rect.end_x - rect.orig_x + 1, .color = rect.color});
-    oled_put_hline((oled_line_t){.orig_x = rect.orig_x, .orig_y = rect.end_y, .len = rect.end_x - rect.orig_x + 1, .color = rect.color});
-    // Draw vertical border lines
-    oled_put_vline((oled_line_t){.orig_x = rect.orig_x, .orig_y = rect.orig_y, .len = rect.end_y - rect.orig_y + 1, .color = rect.color});
-    oled_put_vline((oled_line_t){.orig_x = rect.end_x, .orig_y = rect.orig_y, .len = rect.end_y - rect.orig_y + 1, .color = rect.color});
-  }
-}
-
-void oled_put_basic_font_char(const char c, uint8_t page, uint8_t col) {
-  assert(oled_sh1106_attributes.first_col <= col && oled_sh1106_attributes.last_col >= col + OLED_BASIC_FONT_COLS - 1);
-  assert(oled_sh1106_attributes.first_page <= page && oled_sh1106_attributes.last_page >= page);
-  uint8_t char_index = 0;
-  for(uint8_t c_idx = 0; c_idx < sizeof(oled_font_characters) / sizeof(oled_font_characters[0]); c_idx++) {
-    if(oled_font_characters[c_idx] == c) {
-      char_index = c_idx;
-      break;
+void oled_render_dirty(ext_spi_handle_t ext_spi) {
+  for(uint8_t page = oled_sh1106_attributes.first_page; page <= oled_sh1106_attributes.last_page; page++) {
+    oled_span_t span = oled_trim_dirty(page);
+    if(span.min_col <= span.max_col) {
+      oled_set_cursor(ext_spi, page, span.min_col);
+      oled_transport_write(ext_spi, &oled_buf[page][span.min_col], span.max_col - span.min_col + 1, OLED_DATA);
+      memcpy(&oled_front_buf[page][span.min_col], &oled_buf[page][span.min_col], span.max_col - span.min_col + 1);
     }
   }
-  // Copy the character data into the buffer
-  memcpy(&oled_buf[page][col], &oled_basic_font_lut[char_index], OLED_BASIC_FONT_COLS);
-}
-
-void oled_put_char(const char c, uint8_t page, uint8_t col, uint8_t font_id) {
-  switch(font_id) {
-  case OLED_BASIC_FONT_ID:
-    oled_put_basic_font_char(c, page, col);
-    break;
-  default:
-    break;
-  }
+  oled_mark_clean(oled_dirty);
 }
 
-void oled_put_string(const char *str, uint8_t page, uint8_t col, uint8_t font_id) {
-  switch(font_id) {
-  case OLED_BASIC_FONT_ID:
-    assert(oled_sh1106_attributes.first_col <= col && oled_sh1106_attributes.last_col >= (col + strlen(str) * OLED_BASIC_FONT_COLS - 1));
-    assert(oled_sh1106_attributes.first_page <= page && oled_sh1106_attributes.last_page >= page);
-    break;
-  default:
-    // Unsupported font ID
-    return;
-  }
-  for(size_t i = 0; i < strlen(str); i++) {
-    oled_put_char(str[i], page, col + (i * OLED_BASIC_FONT_COLS), font_id);
-  }
-}
-
-void oled_put_bitmap(const uint8_t *bitmap) {
-  assert(sizeof(oled_buf) == sizeof(bitmap));
-  memcpy(&oled_buf, bitmap, sizeof(oled_buf));
+void oled_clear_display(ext_spi_handle_t ext_spi) {
+  oled_clear_buf();
+  oled_render(ext_spi);
 }
 
 void oled_sleep(ext_spi_handle_t ext_spi) {
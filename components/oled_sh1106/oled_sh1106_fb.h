@@ -0,0 +1,46 @@
+#ifndef OLED_SH1106_FB_H
+#define OLED_SH1106_FB_H
+
+#include "oled_sh1106_config.h"
+#include "oled_sh1106_gfx.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Video buffers and their state shared by the raster primitives, the driver core and the ports; not a public API
+
+extern const oled_attributes_t oled_sh1106_attributes;
+
+extern uint8_t oled_buf[OLED_NUM_PAGES][OLED_WIDTH];
+
+extern oled_span_t oled_dirty[OLED_NUM_PAGES];
+
+extern uint8_t oled_front_buf[OLED_NUM_PAGES][OLED_WIDTH];
+
+/**
+ * @brief Extends the dirty span of the page by the given columns.
+ */
+void oled_mark_dirty(uint8_t page, uint8_t first_col, uint8_t last_col);
+
+/**
+ * @brief Marks all the given page spans as clean.
+ */
+void oled_mark_clean(oled_span_t *spans);
+
+/**
+ * @brief Gets the dirty span of the page without the bytes that equal the front buffer.
+ */
+oled_span_t oled_trim_dirty(uint8_t page);
+
+/**
+ * @brief Fills OLED_CURSOR_CMDS_LEN command bytes that set the page and column address.
+ */
+void oled_cursor_cmds(uint8_t page, uint8_t col, uint8_t *cmds);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OLED_SH1106_FB_H
@@ -0,0 +1,15 @@
+#include "oled_sh1106_font.h"
+
+const oled_basic_font_t oled_basic_font_lut[OLED_BASIC_GLYPH_NUM] = {
+    [OLED_BASIC_GLYPH_REPLACEMENT] = {{0x00, 0x7F, 0x41, 0x41, 0x41, 0x41, 0x7F, 0x00}}, // Hollow box
+#define OLED_BASIC_GLYPH_DATA(name, character, ...) [OLED_BASIC_GLYPH_##name] = {{__VA_ARGS__}},
+    OLED_BASIC_FONT_GLYPHS(OLED_BASIC_GLYPH_DATA)
+#undef OLED_BASIC_GLYPH_DATA
+};
+
+// Characters missing in the font are left zero, which is the replacement glyph
+const uint8_t oled_basic_font_index[OLED_FONT_INDEX_LEN] = {
+#define OLED_BASIC_GLYPH_INDEX(name, character, ...) [(uint8_t)(character)] = OLED_BASIC_GLYPH_##name,
+    OLED_BASIC_FONT_GLYPHS(OLED_BASIC_GLYPH_INDEX)
+#undef OLED_BASIC_GLYPH_INDEX
+};
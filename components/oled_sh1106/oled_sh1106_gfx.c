@@ -0,0 +1,194 @@
+#include "oled_sh1106_gfx.h"
+#include "oled_sh1106_config.h"
+#include "oled_sh1106_fb.h"
+#include "oled_sh1106_font.h"
+#include <assert.h>
+#include <string.h>
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define DMA_ATTR
+#endif
+
+const oled_attributes_t oled_sh1106_attributes = {.rows = OLED_HEIGHT,
+                                                  .first_row = 0x00,
+                                                  .last_row = OLED_HEIGHT - 1,
+                                                  .columns = OLED_WIDTH,
+                                                  .first_page = 0x00,
+                                                  .last_page = OLED_NUM_PAGES - 1,
+                                                  .first_col = 0x00,
+                                                  .last_col = OLED_WIDTH - 1,
+                                                  .pages = OLED_NUM_PAGES};
+
+// Buffer for the display (back buffer), each page is sent as a single DMA transaction
+DMA_ATTR uint8_t oled_buf[OLED_NUM_PAGES][OLED_WIDTH];
+
+// Column span of every page that was touched since the last render; the page is clean if min_col > max_col
+oled_span_t oled_dirty[OLED_NUM_PAGES];
+
+// Masks of bits from the given bit up to the MSB, and from the LSB up to the given bit
+static const uint8_t oled_mask_from_bit[8] = {0xFF, 0xFE, 0xFC, 0xF8, 0xF0, 0xE0, 0xC0, 0x80};
+static const uint8_t oled_mask_to_bit[8] = {0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F, 0xFF};
+
+oled_attributes_t oled_get_attributes(void) { return oled_sh1106_attributes; }
+
+void oled_mark_dirty(uint8_t page, uint8_t first_col, uint8_t last_col) {
+  if(first_col < oled_dirty[page].min_col) {
+    oled_dirty[page].min_col = first_col;
+  }
+  if(last_col > oled_dirty[page].max_col) {
+    oled_dirty[page].max_col = last_col;
+  }
+}
+
+void oled_mark_clean(oled_span_t *spans) {
+  for(uint8_t page = oled_sh1106_attributes.first_page; page <= oled_sh1106_attributes.last_page; page++) {
+    spans[page] = (oled_span_t){.min_col = oled_sh1106_attributes.columns, .max_col = 0};
+  }
+}
+
+void oled_clear_buf(void) {
+  for(uint8_t page = oled_sh1106_attributes.first_page; page <= oled_sh1106_attributes.last_page; page++) {
+    memset(oled_buf[page], 0x00, oled_sh1106_attributes.columns);
+    oled_mark_dirty(page, oled_sh1106_attributes.first_col, oled_sh1106_attributes.last_col);
+  }
+}
+
+void oled_put_point(oled_point_t point) {
+  assert(oled_sh1106_attributes.first_col <= point.x && oled_sh1106_attributes.last_col >= point.x);
+  assert(oled_sh1106_attributes.first_row <= point.y && oled_sh1106_attributes.last_row >= point.y);
+  uint8_t page = point.y / 8;
+  uint8_t bit = 1 << (point.y % 8);
+  if(OLED_COLOR_WHITE == point.color) {
+    oled_buf[page][point.x] |= bit;
+  } else {
+    oled_buf[page][point.x] &= ~bit;
+  }
+  oled_mark_dirty(page, point.x, point.x);
+}
+
+static void oled_put_area(uint8_t first_col, uint8_t last_col, uint8_t first_row, uint8_t last_row, bool color) {
+  uint8_t first_page = first_row / 8;
+  uint8_t last_page = last_row / 8;
+  size_t len = last_col - first_col + 1;
+  for(uint8_t page = first_page; page <= last_page; page++) {
+    // Rows of the area that belong to this page
+    uint8_t mask = 0xFF;
+    if(page == first_page) {
+      mask &= oled_mask_from_bit[first_row % 8];
+    }
+    if(page == last_page) {
+      mask &= oled_mask_to_bit[last_row % 8];
+    }
+    uint8_t *dst = &oled_buf[page][first_col];
+    if(0xFF == mask) {
+      memset(dst, (OLED_COLOR_WHITE == color) ? 0xFF : 0x00, len);
+    } else if(OLED_COLOR_WHITE == color) {
+      for(size_t col = 0; col < len; col++) {
+        dst[col] |= mask;
+      }
+    } else {
+      for(size_t col = 0; col < len; col++) {
+        dst[col] &= ~mask;
+      }
+    }
+    oled_mark_dirty(page, first_col, last_col);
+  }
+}
+
+void oled_put_vline(oled_line_t line) {
+  assert(oled_sh1106_attributes.first_col <= line.orig_x && oled_sh1106_attributes.last_col >= line.orig_x);
+  assert(oled_sh1106_attributes.first_row <= line.orig_y && oled_sh1106_attributes.last_row >= (line.orig_y + line.len - 1));
+  if(0 < line.len) {
+    oled_put_area(line.orig_x, line.orig_x, line.orig_y, line.orig_y + line.len - 1, line.color);
+  }
+}
+
+void oled_put_hline(oled_line_t line) {
+  assert(oled_sh1106_attributes.first_col <= line.orig_x && oled_sh1106_attributes.last_col >= (line.orig_x + line.len - 1));
+  assert(oled_sh1106_attributes.first_row <= line.orig_y && oled_sh1106_attributes.last_row >= line.orig_y);
+  if(0 < line.len) {
+    oled_put_area(line.orig_x, line.orig_x + line.len - 1, line.orig_y, line.orig_y, line.color);
+  }
+}
+
+void oled_put_rect(oled_rect_t rect) {
+  assert(oled_sh1106_attributes.first_col <= rect.orig_x && oled_sh1106_attributes.last_col >= rect.orig_x);
+  assert(oled_sh1106_attributes.first_col <= rect.end_x && oled_sh1106_attributes.last_col >= rect.end_x);
+  assert(oled_sh1106_attributes.first_row <= rect.orig_y && oled_sh1106_attributes.last_row >= rect.orig_y);
+  assert(oled_sh1106_attributes.first_row <= rect.end_y && oled_sh1106_attributes.last_row >= rect.end_y);
+  assert(rect.orig_x <= rect.end_x && rect.orig_y <= rect.end_y);
+  if(OLED_SHAPE_FILLED == rect.fill) {
+    // Fill the rectangle page by page
+    oled_put_area(rect.orig_x, rect.end_x, rect.orig_y, rect.end_y, rect.color);
+  } else {
+    // Drawing border
+    // Draw horizontal border lines
+    oled_put_area(rect.orig_x, rect.end_x, rect.orig_y, rect.orig_y, rect.color);
+    oled_put_area(rect.orig_x, rect.end_x, rect.end_y, rect.end_y, rect.color);
+    // Draw vertical border lines
+    oled_put_area(rect.orig_x, rect.orig_x, rect.orig_y, rect.end_y, rect.color);
+    oled_put_area(rect.end_x, rect.end_x, rect.orig_y, rect.end_y, rect.color);
+  }
+}
+
+void oled_put_basic_font_char(const char c, uint8_t page, uint8_t col) {
+  assert(oled_sh1106_attributes.first_col <= col && oled_sh1106_attributes.last_col >= col + OLED_BASIC_FONT_COLS - 1);
+  assert(oled_sh1106_attributes.first_page <= page && oled_sh1106_attributes.last_page >= page);
+  // Copy the character data into the buffer
+  memcpy(&oled_buf[page][col], &oled_basic_font_lut[oled_basic_font_glyph(c)], OLED_BASIC_FONT_COLS);
+  oled_mark_dirty(page, col, col + OLED_BASIC_FONT_COLS - 1);
+}
+
+void oled_put_char(const char c, uint8_t page, uint8_t col, uint8_t font_id) {
+  switch(font_id) {
+  case OLED_BASIC_FONT_ID:
+    oled_put_basic_font_char(c, page, col);
+    break;
+  default:
+    break;
+  }
+}
+
+void oled_put_string(const char *str, uint8_t page, uint8_t col, uint8_t font_id) { oled_put_string_n(str, strlen(str), page, col, font_id); }
+
+void oled_put_string_n(const char *str, size_t len, uint8_t page, uint8_t col, uint8_t font_id) {
+  switch(font_id) {
+  case OLED_BASIC_FONT_ID:
+    assert(oled_sh1106_attributes.first_col <= col && oled_sh1106_attributes.last_col >= (col + len * OLED_BASIC_FONT_COLS - 1));
+    assert(oled_sh1106_attributes.first_page <= page && oled_sh1106_attributes.last_page >= page);
+    break;
+  default:
+    // Unsupported font ID
+    return;
+  }
+  if(0 == len) {
+    return;
+  }
+  uint8_t *dst = &oled_buf[page][col];
+  for(size_t i = 0; i < len; i++) {
+    memcpy(dst + (i * OLED_BASIC_FONT_COLS), &oled_basic_font_lut[oled_basic_font_glyph(str[i])], OLED_BASIC_FONT_COLS);
+  }
+  oled_mark_dirty(page, col, col + len * OLED_BASIC_FONT_COLS - 1);
+}
+
+void oled_put_bitmap(const uint8_t *bitmap) {
+  assert(NULL != bitmap);
+  memcpy(oled_buf, bitmap, sizeof(oled_buf));
+  for(uint8_t page = oled_sh1106_attributes.first_page; page <= oled_sh1106_attributes.last_page; page++) {
+    oled_mark_dirty(page, oled_sh1106_attributes.first_col, oled_sh1106_attributes.last_col);
+  }
+}
+
+void oled_get_bitmap(uint8_t *bitmap) {
+  assert(NULL != bitmap);
+  memcpy(bitmap, oled_buf, sizeof(oled_buf));
+}
+
+void oled_put_bitmap_span(const uint8_t *bitmap, uint8_t page, uint8_t first_col, uint8_t last_col) {
+  assert(NULL != bitmap);
+  assert(oled_sh1106_attributes.first_page <= page && oled_sh1106_attributes.last_page >= page);
+  assert(first_col <= last_col && oled_sh1106_attributes.last_col >= last_col);
+  memcpy(&oled_buf[page][first_col], &bitmap[page * OLED_WIDTH + first_col], last_col - first_col + 1);
+  oled_mark_dirty(page, first_col, last_col);
+}
@@ -0,0 +1,84 @@
+#ifndef OLED_SH1106_PORT_H
+#define OLED_SH1106_PORT_H
+
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "oled_sh1106_config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ESP-IDF port of the display transport: SPI master with D/C and reset GPIOs
+
+#define OLED_ASYNC_TRANS_NUM (2 * OLED_NUM_PAGES)
+
+// ---------------------------------------------------------------------------------
+
+/**
+ * @brief Struct that stores pointers to SPI device handler and other required pins
+ */
+typedef struct {
+  spi_device_handle_t spi;
+  gpio_num_t dc;  // Data or command GPIO
+  gpio_num_t res; // Reset
+} ext_spi_handle_t;
+
+/**
+ * @brief Callback called from the SPI interrupt when the render task has sent the whole published frame;
+ */
+typedef void (*oled_frame_done_cb_t)(void *arg);
+
+/**
+ * @brief Starts the asynchronous display mode.
+ *
+ * Creates the render task that streams the front buffer with queued DMA transactions. From now on the display
+ * content is published with oled_swap_buffers(); oled_render() and oled_render_dirty() must not be used anymore.
+ *
+ * @param ext_spi expanded SPI device handle to use for communication.
+ * @param frame_done_cb callback called from the SPI interrupt when a published frame has been sent, can be NULL
+ * @param arg argument passed to the callback
+ *
+ * @return void
+ *
+ * @note SPI device has to be added with oled_spi_pre_transfer_cb and oled_spi_post_transfer_cb as pre_cb and post_cb,
+ *       and with queue size of at least OLED_ASYNC_TRANS_NUM.
+ */
+void oled_async_start(ext_spi_handle_t ext_spi, oled_frame_done_cb_t frame_done_cb, void *arg);
+
+/**
+ * @brief Publishes the video buffer (back buffer) to the render task.
+ *
+ * Changed bytes of the back buffer are copied into the front buffer and the render task is woken up. The call never
+ * waits for the SPI bus. If the previous frame is still in flight, nothing is published and the back buffer keeps its
+ * changes for the next call.
+ *
+ * @return true if the frame was published; false if the previous frame is still being sent
+ */
+bool oled_swap_buffers(void);
+
+/**
+ * @brief SPI pre-transfer callback, sets the D/C line for transactions of the render task.
+ *
+ * @param t SPI transaction
+ *
+ * @return void
+ */
+void oled_spi_pre_transfer_cb(spi_transaction_t *t);
+
+/**
+ * @brief SPI post-transfer callback, signals the end of a frame sent by the render task.
+ *
+ * @param t SPI transaction
+ *
+ * @return void
+ */
+void oled_spi_post_transfer_cb(spi_transaction_t *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OLED_SH1106_PORT_H
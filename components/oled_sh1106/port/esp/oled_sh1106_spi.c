@@ -0,0 +1,150 @@
+#include "oled_sh1106.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "oled_sh1106_commands.h"
+#include "oled_sh1106_config.h"
+#include "oled_sh1106_fb.h"
+#include "oled_sh1106_transport.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <string.h>
+
+// Column spans of the front buffer published by oled_swap_buffers() that are waiting for the render task
+static oled_span_t oled_front_dirty[OLED_NUM_PAGES];
+
+// Flags passed to the SPI transfer callbacks in the transaction user field
+enum { OLED_TRANS_DC = 0x01, OLED_TRANS_ASYNC = 0x02, OLED_TRANS_LAST = 0x04 };
+
+// Asynchronous mode state
+static ext_spi_handle_t oled_async_spi;
+static TaskHandle_t oled_render_task_handle = NULL;
+static StackType_t oled_render_task_stack[OLED_RENDER_TASK_STACK];
+static StaticTask_t oled_render_task_buf;
+static spi_transaction_t oled_async_trans[OLED_ASYNC_TRANS_NUM];
+static atomic_bool oled_frame_in_flight = false;
+static oled_frame_done_cb_t oled_frame_done_cb = NULL;
+static void *oled_frame_done_arg = NULL;
+
+void oled_transport_reset(ext_spi_handle_t ext_spi) {
+  esp_err_t ret;
+  ret = gpio_set_level(ext_spi.res, 0);
+  ESP_ERROR_CHECK(ret);
+  vTaskDelay(pdMS_TO_TICKS(100));
+  ret = gpio_set_level(ext_spi.res, 1);
+  ESP_ERROR_CHECK(ret);
+  vTaskDelay(pdMS_TO_TICKS(100));
+}
+
+void oled_transport_write(ext_spi_handle_t ext_spi, const uint8_t *buf, size_t len, uint8_t dc) {
+  esp_err_t ret;
+  spi_transaction_t t;
+  memset(&t, 0, sizeof(t));
+  t.length = len * 8;
+  if(len <= sizeof(t.tx_data)) {
+    // Short command bursts are sent from the transaction itself, no DMA descriptor is needed
+    t.flags = SPI_TRANS_USE_TXDATA;
+    memcpy(t.tx_data, buf, len);
+  } else {
+    t.tx_buffer = buf;
+  }
+  ret = gpio_set_level(ext_spi.dc, dc);
+  ESP_ERROR_CHECK(ret);
+  ret = spi_device_polling_transmit(ext_spi.spi, &t);
+  ESP_ERROR_CHECK(ret);
+}
+
+void oled_transport_delay_ms(uint32_t ms) { vTaskDelay(pdMS_TO_TICKS(ms)); }
+
+void IRAM_ATTR oled_spi_pre_transfer_cb(spi_transaction_t *t) {
+  uint32_t flags = (uint32_t)(uintptr_t)t->user;
+  if(flags & OLED_TRANS_ASYNC) {
+    gpio_set_level(oled_async_spi.dc, flags & OLED_TRANS_DC);
+  }
+}
+
+void IRAM_ATTR oled_spi_post_transfer_cb(spi_transaction_t *t) {
+  uint32_t flags = (uint32_t)(uintptr_t)t->user;
+  if(flags & OLED_TRANS_LAST) {
+    // The whole frame left the front buffer, it can be overwritten by the next swap
+    atomic_store(&oled_frame_in_flight, false);
+    if(NULL != oled_frame_done_cb) {
+      oled_frame_done_cb(oled_frame_done_arg);
+    }
+  }
+}
+
+static void oled_render_task(void *arg) {
+  while(1) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    // Every published span becomes a command transaction (cursor) followed by a data transaction
+    size_t trans_num = 0;
+    for(uint8_t page = oled_sh1106_attributes.first_page; page <= oled_sh1106_attributes.last_page; page++) {
+      oled_span_t span = oled_front_dirty[page];
+      if(span.min_col <= span.max_col) {
+        spi_transaction_t *t = &oled_async_trans[trans_num++];
+        memset(t, 0, sizeof(*t));
+        t->flags = SPI_TRANS_USE_TXDATA;
+        t->length = OLED_CURSOR_CMDS_LEN * 8;
+        t->user = (void *)(uintptr_t)(OLED_TRANS_ASYNC | OLED_CMD);
+        oled_cursor_cmds(page, span.min_col, t->tx_data);
+        t = &oled_async_trans[trans_num++];
+        memset(t, 0, sizeof(*t));
+        t->length = (span.max_col - span.min_col + 1) * 8;
+        t->tx_buffer = &oled_front_buf[page][span.min_col];
+        t->user = (void *)(uintptr_t)(OLED_TRANS_ASYNC | OLED_DATA);
+      }
+    }
+    oled_mark_clean(oled_front_dirty);
+    if(0 == trans_num) {
+      atomic_store(&oled_frame_in_flight, false);
+      continue;
+    }
+    oled_async_trans[trans_num - 1].user = (void *)((uintptr_t)oled_async_trans[trans_num - 1].user | OLED_TRANS_LAST);
+    for(size_t i = 0; i < trans_num; i++) {
+      ESP_ERROR_CHECK(spi_device_queue_trans(oled_async_spi.spi, &oled_async_trans[i], portMAX_DELAY));
+    }
+    // Finished transactions have to be collected before the descriptors are reused
+    for(size_t i = 0; i < trans_num; i++) {
+      spi_transaction_t *done;
+      ESP_ERROR_CHECK(spi_device_get_trans_result(oled_async_spi.spi, &done, portMAX_DELAY));
+    }
+  }
+}
+
+void oled_async_start(ext_spi_handle_t ext_spi, oled_frame_done_cb_t frame_done_cb, void *arg) {
+  assert(NULL == oled_render_task_handle);
+  oled_async_spi = ext_spi;
+  oled_frame_done_cb = frame_done_cb;
+  oled_frame_done_arg = arg;
+  oled_mark_clean(oled_front_dirty);
+  // The task is allocated statically, its stack is part of the RAM budget of the driver
+  oled_render_task_handle = xTaskCreateStatic(oled_render_task, "oled_render", OLED_RENDER_TASK_STACK, NULL, OLED_RENDER_TASK_PRIO,
+                                              oled_render_task_stack, &oled_render_task_buf);
+  assert(NULL != oled_render_task_handle);
+}
+
+bool oled_swap_buffers(void) {
+  assert(NULL != oled_render_task_handle);
+  if(atomic_load(&oled_frame_in_flight)) {
+    // The front buffer is still being sent, the frame stays in the back buffer until the next swap
+    return false;
+  }
+  bool published = false;
+  for(uint8_t page = oled_sh1106_attributes.first_page; page <= oled_sh1106_attributes.last_page; page++) {
+    oled_span_t span = oled_trim_dirty(page);
+    if(span.min_col <= span.max_col) {
+      memcpy(&oled_front_buf[page][span.min_col], &oled_buf[page][span.min_col], span.max_col - span.min_col + 1);
+      oled_front_dirty[page] = span;
+      published = true;
+    }
+  }
+  oled_mark_clean(oled_dirty);
+  if(published) {
+    atomic_store(&oled_frame_in_flight, true);
+    xTaskNotifyGive(oled_render_task_handle);
+  }
+  return true;
+}
@@ -0,0 +1,127 @@
+#ifndef OLED_SH1106_PORT_H
+#define OLED_SH1106_PORT_H
+
+#include "oled_sh1106_config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Host port of the display transport: the command/data stream is decoded by a simulated SH1106 controller, so the
+// driver, the menu and the pages can be tested and benchmarked on PC.
+
+enum { OLED_SIM_RAM_COLS = 132 }; // SH1106 RAM is wider than the panel, the panel shows columns 2 - 129
+
+// ---------------------------------------------------------------------------------
+
+/**
+ * @brief Simulated SH1106 controller: display RAM, decoded registers and transfer statistics;
+ */
+typedef struct {
+  uint8_t ram[OLED_NUM_PAGES][OLED_SIM_RAM_COLS]; // Display RAM, one byte holds 8 rows of a column
+  uint8_t page;                                   // Page address
+  uint8_t col;                                    // Column address, incremented by every data byte
+  uint8_t pending_cmd;                            // Double byte command waiting for its value, 0 if none
+  uint8_t contrast;                               // Contrast value
+  bool display_on;                                // false in sleep mode
+  bool inverted;                                  // Negative display
+  uint32_t resets;                                // Number of hardware resets
+  uint32_t transfers;                             // Number of bursts (SPI transactions)
+  uint32_t cmd_bytes;                             // Number of command bytes
+  uint32_t data_bytes;                            // Number of data bytes
+  bool frame_in_flight;                           // Set by the tests, oled_swap_buffers() refuses frames like during a transfer
+} oled_sim_t;
+
+/**
+ * @brief Display handle of the host port, points to the simulated controller
+ */
+typedef struct {
+  oled_sim_t *sim;
+} ext_spi_handle_t;
+
+/**
+ * @brief Callback called when the whole published frame has been sent;
+ */
+typedef void (*oled_frame_done_cb_t)(void *arg);
+
+/**
+ * @brief Starts the asynchronous display mode.
+ *
+ * Same API as the ESP-IDF port, but there is no render task: oled_swap_buffers() sends the published spans from the
+ * front buffer to the simulated controller before it returns. Can be called again, e.g. by every test.
+ *
+ * @param ext_spi display handle of the simulated controller
+ * @param frame_done_cb callback called when a published frame has been sent, can be NULL
+ * @param arg argument passed to the callback
+ *
+ * @return void
+ */
+void oled_async_start(ext_spi_handle_t ext_spi, oled_frame_done_cb_t frame_done_cb, void *arg);
+
+/**
+ * @brief Publishes the video buffer (back buffer) to the simulated controller.
+ *
+ * Changed bytes of the back buffer are copied into the front buffer and sent. If frame_in_flight of the simulated
+ * controller is set, nothing is published and the back buffer keeps its changes for the next call.
+ *
+ * @return true if the frame was published; false if the previous frame is still being sent
+ */
+bool oled_swap_buffers(void);
+
+/**
+ * @brief Initializes the simulated controller to its power-on state and clears the statistics.
+ *
+ * @param sim simulated controller
+ *
+ * @return void
+ */
+void oled_sim_init(oled_sim_t *sim);
+
+/**
+ * @brief Clears the transfer statistics of the simulated controller.
+ *
+ * @param sim simulated controller
+ *
+ * @return void
+ */
+void oled_sim_reset_stats(oled_sim_t *sim);
+
+/**
+ * @brief Copies the part of the controller RAM visible on the panel, in the video buffer layout.
+ *
+ * @param sim simulated controller
+ * @param frame destination frame
+ *
+ * @return void
+ */
+void oled_sim_get_frame(const oled_sim_t *sim, uint8_t frame[OLED_NUM_PAGES][OLED_WIDTH]);
+
+/**
+ * @brief Gets a pixel as shown on the panel, including sleep mode and negative display.
+ *
+ * @param sim simulated controller
+ * @param x x coordinate
+ * @param y y coordinate
+ *
+ * @return true if the pixel is lit
+ */
+bool oled_sim_get_pixel(const oled_sim_t *sim, uint8_t x, uint8_t y);
+
+/**
+ * @brief Writes the panel content as a binary PBM (P4) image.
+ *
+ * @param sim simulated controller
+ * @param path output file path
+ *
+ * @return true on success
+ */
+bool oled_sim_dump_pbm(const oled_sim_t *sim, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OLED_SH1106_PORT_H
@@ -0,0 +1,182 @@
+#include "oled_sh1106.h"
+#include "oled_sh1106_commands.h"
+#include "oled_sh1106_fb.h"
+#include "oled_sh1106_port.h"
+#include "oled_sh1106_transport.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+// Power-on value of the contrast register
+enum { OLED_SIM_RESET_CONTRAST = 0x80 };
+
+// Asynchronous mode state
+static ext_spi_handle_t oled_async_spi = {NULL};
+static oled_frame_done_cb_t oled_frame_done_cb = NULL;
+static void *oled_frame_done_arg = NULL;
+
+// Registers are set to their reset values, the RAM content is kept like in the real controller
+static void oled_sim_reset_registers(oled_sim_t *sim) {
+  sim->page = 0;
+  sim->col = 0;
+  sim->pending_cmd = 0;
+  sim->contrast = OLED_SIM_RESET_CONTRAST;
+  sim->display_on = false;
+  sim->inverted = false;
+}
+
+static void oled_sim_command(oled_sim_t *sim, uint8_t cmd) {
+  if(0 != sim->pending_cmd) {
+    // Second byte of a double byte command
+    if(OLED_SET_CONTRAST == sim->pending_cmd) {
+      sim->contrast = cmd;
+    }
+    sim->pending_cmd = 0;
+    return;
+  }
+  if(cmd < OLED_BASE_COL_ADDR_H) {
+    sim->col = (sim->col & 0xF0) | cmd;
+  } else if(cmd < OLED_BASE_COL_ADDR_H + 0x10) {
+    sim->col = (sim->col & 0x0F) | ((cmd & 0x0F) << 4);
+  } else if(cmd >= OLED_FIRST_PAGE_ADDR && cmd <= OLED_LAST_PAGE_ADDR) {
+    sim->page = cmd - OLED_FIRST_PAGE_ADDR;
+  } else {
+    switch(cmd) {
+    case OLED_SLEEP_MODE_ON:
+      sim->display_on = false;
+      break;
+    case OLED_SLEEP_MODE_OFF:
+      sim->display_on = true;
+      break;
+    case OLED_DISPLAY_POSITIVE:
+      sim->inverted = false;
+      break;
+    case OLED_DISPLAY_NEGATIVE:
+      sim->inverted = true;
+      break;
+    case OLED_SET_CONTRAST:
+    case OLED_SET_MUX_ROT:
+    case OLED_SET_DC_DC:
+    case OLED_SET_DISP_OFFSET:
+    case OLED_SET_CLK_DIV:
+    case OLED_SET_PRECHARGE:
+    case OLED_SET_COM_PINS:
+    case OLED_SET_VCOM_DESEL:
+      sim->pending_cmd = cmd;
+      break;
+    default:
+      // Remaining commands don't change the content of the panel
+      break;
+    }
+  }
+}
+
+static void oled_sim_data(oled_sim_t *sim, uint8_t data) {
+  // Column address stops incrementing after the last RAM column
+  if(sim->col < OLED_SIM_RAM_COLS) {
+    sim->ram[sim->page][sim->col++] = data;
+  }
+}
+
+void oled_sim_init(oled_sim_t *sim) {
+  memset(sim, 0, sizeof(*sim));
+  oled_sim_reset_registers(sim);
+}
+
+void oled_sim_reset_stats(oled_sim_t *sim) {
+  sim->resets = 0;
+  sim->transfers = 0;
+  sim->cmd_bytes = 0;
+  sim->data_bytes = 0;
+}
+
+void oled_sim_get_frame(const oled_sim_t *sim, uint8_t frame[OLED_NUM_PAGES][OLED_WIDTH]) {
+  for(uint8_t page = 0; page < OLED_NUM_PAGES; page++) {
+    memcpy(frame[page], &sim->ram[page][OLED_BASE_COL_ADDR_L], OLED_WIDTH);
+  }
+}
+
+bool oled_sim_get_pixel(const oled_sim_t *sim, uint8_t x, uint8_t y) {
+  if(!sim->display_on) {
+    return false;
+  }
+  bool lit = (sim->ram[y / 8][OLED_BASE_COL_ADDR_L + x] >> (y % 8)) & 0x01;
+  return lit != sim->inverted;
+}
+
+bool oled_sim_dump_pbm(const oled_sim_t *sim, const char *path) {
+  FILE *file = fopen(path, "wb");
+  if(NULL == file) {
+    return false;
+  }
+  fprintf(file, "P4\n%d %d\n", OLED_WIDTH, OLED_HEIGHT);
+  // P4 rows are packed MSB first and 1 is black, so lit pixels are written as 0
+  for(uint8_t y = 0; y < OLED_HEIGHT; y++) {
+    uint8_t row[OLED_WIDTH / 8];
+    memset(row, 0, sizeof(row));
+    for(uint8_t x = 0; x < OLED_WIDTH; x++) {
+      if(!oled_sim_get_pixel(sim, x, y)) {
+        row[x / 8] |= 0x80 >> (x % 8);
+      }
+    }
+    fwrite(row, 1, sizeof(row), file);
+  }
+  return 0 == fclose(file);
+}
+
+void oled_transport_reset(ext_spi_handle_t ext_spi) {
+  oled_sim_reset_registers(ext_spi.sim);
+  ext_spi.sim->resets++;
+}
+
+void oled_transport_write(ext_spi_handle_t ext_spi, const uint8_t *buf, size_t len, uint8_t dc) {
+  oled_sim_t *sim = ext_spi.sim;
+  sim->transfers++;
+  if(OLED_DATA == dc) {
+    sim->data_bytes += len;
+    for(size_t i = 0; i < len; i++) {
+      oled_sim_data(sim, buf[i]);
+    }
+  } else {
+    sim->cmd_bytes += len;
+    for(size_t i = 0; i < len; i++) {
+      oled_sim_command(sim, buf[i]);
+    }
+  }
+}
+
+void oled_async_start(ext_spi_handle_t ext_spi, oled_frame_done_cb_t frame_done_cb, void *arg) {
+  oled_async_spi = ext_spi;
+  oled_frame_done_cb = frame_done_cb;
+  oled_frame_done_arg = arg;
+}
+
+bool oled_swap_buffers(void) {
+  assert(NULL != oled_async_spi.sim);
+  if(oled_async_spi.sim->frame_in_flight) {
+    return false;
+  }
+  // Spans are sent from the front buffer like the DMA transactions of the render task on the target
+  bool published = false;
+  for(uint8_t page = oled_sh1106_attributes.first_page; page <= oled_sh1106_attributes.last_page; page++) {
+    oled_span_t span = oled_trim_dirty(page);
+    if(span.min_col <= span.max_col) {
+      memcpy(&oled_front_buf[page][span.min_col], &oled_buf[page][span.min_col], span.max_col - span.min_col + 1);
+      uint8_t cmds[OLED_CURSOR_CMDS_LEN];
+      oled_cursor_cmds(page, span.min_col, cmds);
+      oled_transport_write(oled_async_spi, cmds, sizeof(cmds), OLED_CMD);
+      oled_transport_write(oled_async_spi, &oled_front_buf[page][span.min_col], span.max_col - span.min_col + 1, OLED_DATA);
+      published = true;
+    }
+  }
+  oled_mark_clean(oled_dirty);
+  if(published && NULL != oled_frame_done_cb) {
+    oled_frame_done_cb(oled_frame_done_arg);
+  }
+  return true;
+}
+
+void oled_transport_delay_ms(uint32_t ms) {
+  // Simulated time isn't needed by the tests, the delays only slow them down
+  (void)ms;
+}
@@ -1,6 +1,90 @@
 #ifndef STEP_COUNTER_H
 #define STEP_COUNTER_H
 
-namespace pedometer {}
+#include "step_counter_config.hpp"
+#include "step_detector.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace pedometer {
+
+  /**
+   * @brief Counters of the step counter. Cycles are CPU cycles on the target and nanoseconds on the host.
+   */
+  struct StepCounterStats {
+    uint32_t samples;        // Processed samples
+    uint32_t steps;          // Detected steps
+    uint32_t batches;        // Processed batches
+    uint64_t cycles;         // Cycles spent in the detector
+    uint32_t maxBatchCycles; // Cycles of the longest batch
+
+    /**
+     * @brief Returns the average cycles per sample, compared with STEP_CYCLES_PER_SAMPLE_BUDGET on the target.
+     */
+    uint32_t cyclesPerSample(void) const { return (0 == samples) ? 0 : static_cast<uint32_t>(cycles / samples); }
+  };
+
+  /**
+   * @brief Class that counts the steps of the accelerometer samples into DATA_STEPS.
+   *
+   * Batches drained from the accelerometer FIFO are passed to the step detector in the main task, detected steps are
+   * added to SystemData and the cost of the detector is measured per batch.
+   */
+  class StepCounter {
+  private:
+    StepDetector mDetector;
+    StepCounterStats mStats = {};
+    bool mIsInitialized = false;
+
+    // Adds the batch to the counters and the steps to SystemData
+    void commit(size_t count, uint32_t steps, uint32_t cycles);
+
+    // One default constructor, disable copying
+    StepCounter(void) = default;
+    StepCounter(const StepCounter &) = delete;
+    StepCounter &operator=(const StepCounter &) = delete;
+    StepCounter(StepCounter &&) = delete;
+    StepCounter &operator=(StepCounter &&) = delete;
+
+  public:
+    /**
+     * @brief Static constructor for Singleton instance. After calling the constructor, method init() should be called once.
+     */
+    static StepCounter &GetInstance(void) {
+      static StepCounter stepCounter;
+      return stepCounter;
+    }
+
+    /**
+     * @brief Initializes the step counter with the detector parameters.
+     * @note Calling the method more than once will throw std::runtime_error, invalid parameters throw
+     * std::invalid_argument.
+     */
+    void init(const StepDetectorParams &params = StepDetectorParams());
+
+    /**
+     * @brief Processes a batch of samples and adds the detected steps to DATA_STEPS.
+     * @param samples samples with int16_t members x, y and z, e.g. adxl345_sample_t
+     * @param count number of samples
+     * @return number of steps detected in the batch
+     */
+    template <typename Sample> uint32_t process(const Sample *samples, size_t count) {
+      uint32_t start = getCycleCount();
+      uint32_t steps = mDetector.process(samples, count);
+      commit(count, steps, getCycleCount() - start);
+      return steps;
+    }
+
+    /**
+     * @brief Returns the counters of the step counter.
+     */
+    const StepCounterStats &getStats(void) const { return mStats; }
+
+    /**
+     * @brief Returns the time stamp of the counters: CPU cycles on the target, nanoseconds on the host.
+     */
+    static uint32_t getCycleCount(void);
+  };
+} // namespace pedometer
 
 #endif // STEP_COUNTER_H
@@ -0,0 +1,32 @@
+#ifndef STEP_COUNTER_CONFIG_H
+#define STEP_COUNTER_CONFIG_H
+
+#include <cstdint>
+
+namespace pedometer {
+  // Method of the integer magnitude of the acceleration vector
+  enum MagnitudeMethod : uint8_t { MAGNITUDE_ISQRT, MAGNITUDE_ALPHA_MAX_BETA_MIN, MAGNITUDE_METHOD_NUM };
+
+  // Fixed point of the filtered signal, 4 fractional bits
+  enum : uint8_t { STEP_SIGNAL_FRAC_BITS = 4 };
+
+  // Default detector parameters for 100 Hz samples in 256 LSB/g. Exponential filters with shift k have a cutoff of
+  // about fs / (2 * pi * 2^k): the low-pass at 4 Hz removes the jitter, the high-pass at 0.5 Hz removes gravity and
+  // the orientation, so walking cadences of 1 - 3 steps/s pass.
+  enum : uint8_t {
+    STEP_LOW_PASS_SHIFT = 2,
+    STEP_HIGH_PASS_SHIFT = 5,
+    STEP_ENVELOPE_SHIFT = 2,    // Weight of a new peak in the envelope of the peaks
+    STEP_DECAY_SHIFT = 9,       // Decay of the envelope without peaks, about 5 s
+    STEP_THRESHOLD_RATIO = 128, // Threshold as a fraction of the envelope, 256 = 1
+  };
+  enum : uint16_t {
+    STEP_MIN_THRESHOLD = 12,   // Minimum peak height in LSB, about 0.05 g
+    STEP_MIN_INTERVAL = 25,    // Minimum samples between two steps, 250 ms -> at most 4 steps/s
+  };
+
+  // Budget of the detector in CPU cycles per sample on the target, 100 Hz x 250 cycles is 0.02 % of the 160 MHz core
+  enum : uint32_t { STEP_CYCLES_PER_SAMPLE_BUDGET = 250 };
+} // namespace pedometer
+
+#endif // STEP_COUNTER_CONFIG_H
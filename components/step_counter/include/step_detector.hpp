@@ -0,0 +1,133 @@
+#ifndef STEP_DETECTOR_H
+#define STEP_DETECTOR_H
+
+#include "step_counter_config.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace pedometer {
+
+  /**
+   * @brief Returns the integer square root, the largest root whose square doesn't exceed the value.
+   */
+  constexpr uint32_t isqrt(uint32_t value) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while(bit > value) {
+      bit >>= 2;
+    }
+    // One result bit per iteration, no division or multiplication
+    while(0 != bit) {
+      if(value >= root + bit) {
+        value -= root + bit;
+        root = (root >> 1) + bit;
+      } else {
+        root >>= 1;
+      }
+      bit >>= 2;
+    }
+    return root;
+  }
+
+  /**
+   * @brief Returns the length of the vector approximated by max + 10/32 mid + 9/32 min, the error is below 9 %.
+   */
+  constexpr uint32_t alphaMaxBetaMin(int16_t x, int16_t y, int16_t z) {
+    uint32_t a = static_cast<uint32_t>((x < 0) ? -x : x);
+    uint32_t b = static_cast<uint32_t>((y < 0) ? -y : y);
+    uint32_t c = static_cast<uint32_t>((z < 0) ? -z : z);
+    uint32_t max = (a > b) ? a : b;
+    uint32_t min = (a > b) ? b : a;
+    uint32_t mid = (c > max) ? max : ((c > min) ? c : min);
+    min = (c < min) ? c : min;
+    max = (c > max) ? c : max;
+    return max + ((10 * mid + 9 * min) >> 5);
+  }
+
+  /**
+   * @brief Parameters of the step detector, the defaults are tuned for 100 Hz samples in 256 LSB/g.
+   */
+  struct StepDetectorParams {
+    MagnitudeMethod magnitude = MAGNITUDE_ISQRT;
+    uint8_t lowPassShift = STEP_LOW_PASS_SHIFT;
+    uint8_t highPassShift = STEP_HIGH_PASS_SHIFT;
+    uint8_t envelopeShift = STEP_ENVELOPE_SHIFT;
+    uint8_t decayShift = STEP_DECAY_SHIFT;
+    uint8_t thresholdRatio = STEP_THRESHOLD_RATIO;
+    uint16_t minThreshold = STEP_MIN_THRESHOLD;
+    uint16_t minInterval = STEP_MIN_INTERVAL;
+
+    /**
+     * @brief Returns true if the parameters can be used by the detector.
+     */
+    constexpr bool isValid(void) const {
+      return magnitude < MAGNITUDE_METHOD_NUM && lowPassShift > 0 && lowPassShift < highPassShift && highPassShift < 16 &&
+             envelopeShift < 16 && decayShift > 0 && decayShift < 16 && thresholdRatio > 0 && minInterval > 0;
+    }
+  };
+
+  /**
+   * @brief Class that detects steps in a stream of accelerometer samples, integer only.
+   *
+   * Every sample goes through the pipeline: magnitude of the acceleration vector, band-pass filter of walking
+   * frequencies, peak detection with a threshold adapted to the envelope of the recent peaks, and a minimum interval
+   * between two steps. The detector has no global state, any number of instances can run in parallel.
+   */
+  class StepDetector {
+  private:
+    StepDetectorParams mParams;
+    int32_t mLowPass = 0;      // Low-passed magnitude, STEP_SIGNAL_FRAC_BITS fixed point
+    int32_t mBaseline = 0;     // Low-passed mLowPass, subtracted as the high-pass
+    int32_t mEnvelope = 0;     // Envelope of the peak heights
+    int32_t mPeak = 0;         // Height of the current peak
+    uint32_t mSinceStep = 0;   // Samples since the last step
+    bool mIsStarted = false;   // false until the first sample sets the filter state
+    bool mIsInPeak = false;    // true while the signal is above the threshold
+
+    // Processes one sample, returns true if a step was detected
+    bool step(int16_t x, int16_t y, int16_t z);
+
+  public:
+    /**
+     * @brief Creates the detector with the given parameters.
+     * @note Throws std::invalid_argument if the parameters aren't valid.
+     */
+    explicit StepDetector(const StepDetectorParams &params = StepDetectorParams());
+
+    /**
+     * @brief Returns the detector to its initial state, parameters are kept.
+     */
+    void reset(void);
+
+    /**
+     * @brief Returns the parameters of the detector.
+     */
+    const StepDetectorParams &getParams(void) const { return mParams; }
+
+    /**
+     * @brief Processes a batch of samples, e.g. drained from the accelerometer FIFO.
+     * @param samples samples with int16_t members x, y and z
+     * @param count number of samples
+     * @return number of steps detected in the batch
+     */
+    template <typename Sample> uint32_t process(const Sample *samples, size_t count) {
+      uint32_t steps = 0;
+      for(size_t i = 0; i < count; i++) {
+        steps += step(samples[i].x, samples[i].y, samples[i].z) ? 1 : 0;
+      }
+      return steps;
+    }
+
+    /**
+     * @brief Returns the band-passed signal of the last sample, STEP_SIGNAL_FRAC_BITS fixed point.
+     */
+    int32_t getSignal(void) const { return mLowPass - mBaseline; }
+
+    /**
+     * @brief Returns the current threshold of the peaks, STEP_SIGNAL_FRAC_BITS fixed point.
+     */
+    int32_t getThreshold(void) const;
+  };
+} // namespace pedometer
+
+#endif // STEP_DETECTOR_H
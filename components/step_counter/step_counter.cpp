@@ -1,3 +1,41 @@
 #include "step_counter.hpp"
+#include "step_counter_config.hpp"
+#include "system_data.hpp"
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#else
+#include <chrono>
+#endif
+#include <cstdint>
+#include <stdexcept>
 
 using namespace pedometer;
+
+uint32_t StepCounter::getCycleCount(void) {
+#ifdef ESP_PLATFORM
+  return esp_cpu_get_cycle_count();
+#else
+  return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+void StepCounter::init(const StepDetectorParams &params) {
+  if(mIsInitialized) {
+    throw std::runtime_error("StepCounter instance is already initialized.");
+  }
+  mDetector = StepDetector(params);
+  mIsInitialized = true;
+}
+
+void StepCounter::commit(size_t count, uint32_t steps, uint32_t cycles) {
+  mStats.samples += static_cast<uint32_t>(count);
+  mStats.steps += steps;
+  mStats.batches++;
+  mStats.cycles += cycles;
+  if(cycles > mStats.maxBatchCycles) {
+    mStats.maxBatchCycles = cycles;
+  }
+  if(0 != steps) {
+    SystemData::GetInstance().add<DATA_STEPS>(steps);
+  }
+}
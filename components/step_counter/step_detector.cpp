@@ -0,0 +1,80 @@
+#include "step_detector.hpp"
+#include "step_counter_config.hpp"
+#include <cstdint>
+#include <stdexcept>
+
+using namespace pedometer;
+
+StepDetector::StepDetector(const StepDetectorParams &params) : mParams(params) {
+  if(!params.isValid()) {
+    throw std::invalid_argument("Invalid step detector parameters.");
+  }
+  reset();
+}
+
+void StepDetector::reset(void) {
+  mLowPass = 0;
+  mBaseline = 0;
+  mEnvelope = 0;
+  mPeak = 0;
+  // The first step isn't delayed by the minimum interval
+  mSinceStep = mParams.minInterval;
+  mIsStarted = false;
+  mIsInPeak = false;
+}
+
+int32_t StepDetector::getThreshold(void) const {
+  int32_t threshold = (mEnvelope * mParams.thresholdRatio) >> 8;
+  int32_t minThreshold = static_cast<int32_t>(mParams.minThreshold) << STEP_SIGNAL_FRAC_BITS;
+  return (threshold > minThreshold) ? threshold : minThreshold;
+}
+
+bool StepDetector::step(int16_t x, int16_t y, int16_t z) {
+  uint32_t magnitude;
+  if(MAGNITUDE_ISQRT == mParams.magnitude) {
+    // Squares of int16_t fit int32_t, their sum fits uint32_t
+    magnitude = isqrt(static_cast<uint32_t>(x * x) + static_cast<uint32_t>(y * y) + static_cast<uint32_t>(z * z));
+  } else {
+    magnitude = alphaMaxBetaMin(x, y, z);
+  }
+  int32_t value = static_cast<int32_t>(magnitude << STEP_SIGNAL_FRAC_BITS);
+  if(!mIsStarted) {
+    // Filters start settled on the first sample, gravity doesn't make a step response
+    mLowPass = value;
+    mBaseline = value;
+    mIsStarted = true;
+  }
+
+  // Band-pass: low-pass of the magnitude minus its slower low-pass
+  mLowPass += (value - mLowPass) >> mParams.lowPassShift;
+  mBaseline += (mLowPass - mBaseline) >> mParams.highPassShift;
+  int32_t signal = mLowPass - mBaseline;
+
+  mEnvelope -= mEnvelope >> mParams.decayShift;
+  if(mSinceStep < UINT32_MAX) {
+    mSinceStep++;
+  }
+
+  if(!mIsInPeak) {
+    if(signal > getThreshold()) {
+      mIsInPeak = true;
+      mPeak = signal;
+    }
+    return false;
+  }
+  if(signal > mPeak) {
+    mPeak = signal;
+  }
+  // The peak ends when the signal crosses zero, one swing of the magnitude is one step candidate
+  if(signal > 0) {
+    return false;
+  }
+  mIsInPeak = false;
+  mEnvelope += (mPeak - mEnvelope) >> mParams.envelopeShift;
+  // Peaks closer than the minimum interval are bounces of the same step
+  if(mSinceStep < mParams.minInterval) {
+    return false;
+  }
+  mSinceStep = 0;
+  return true;
+}
@@ -1,24 +1,99 @@
 #ifndef SYSTEM_DATA_H
 #define SYSTEM_DATA_H
 
+#include "system_data_config.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
-#include <map>
+#include <stdexcept>
+#include <tuple>
 #include <variant>
 
 namespace pedometer {
 
   enum : bool { SYSTEM_DECREASE_VAL = false, SYSTEM_INCREASE_VAL = true };
 
-  enum DataField : uint8_t { DATA_STEPS, DATA_TARGET_STEPS, DATA_HOURS, DATA_MINUTES, DATA_SECONDS };
+  enum : uint32_t { DATA_ALL_FIELDS = (1UL << DATA_FIELD_NUM) - 1, DATA_STORED_FIELDS = (1UL << DATA_FIRST_DERIVED) - 1 };
+
+  /**
+   * @brief Returns true if the data field is computed from other fields instead of being stored.
+   */
+  constexpr bool isDerived(DataField dataField) { return dataField >= DATA_FIRST_DERIVED && dataField < DATA_FIELD_NUM; }
+
+  /**
+   * @brief Returns the derived schema row of the derived data field.
+   */
+  constexpr const DerivedSchema &derivedSchema(DataField dataField) { return DERIVED_DATA_SCHEMA[dataField - DATA_FIRST_DERIVED]; }
+
+  /**
+   * @brief Adds the derived data fields whose inputs are in the mask of changed stored fields.
+   */
+  constexpr uint32_t withDerived(uint32_t changed) {
+    for(const DerivedSchema &row : DERIVED_DATA_SCHEMA) {
+      if(changed & row.inputs) {
+        changed |= dataMask(row.field);
+      }
+    }
+    return changed;
+  }
+
+  /**
+   * @brief Checks the schema: rows in the DataField order, default within the limits and limits within the type. Derived
+   *        fields depend only on stored fields and their defaults are derived from the stored defaults.
+   */
+  constexpr bool isSchemaValid(void) {
+    uint32_t defaults[DATA_FIELD_NUM] = {};
+    for(uint8_t i = 0; i < DATA_FIELD_NUM; i++) {
+      const DataSchema &row = SYSTEM_DATA_SCHEMA[i];
+      uint32_t typeMax = (PARAM_UINT8 == row.type) ? UINT8_MAX : (PARAM_BOOL == row.type) ? 1 : UINT32_MAX;
+      if(row.field != i || row.min > row.def || row.def > row.max || row.max > typeMax) {
+        return false;
+      }
+      defaults[i] = row.def;
+    }
+    for(uint8_t i = DATA_FIRST_DERIVED; i < DATA_FIELD_NUM; i++) {
+      const DerivedSchema &row = derivedSchema(static_cast<DataField>(i));
+      if(row.field != i || 0 == row.inputs || (row.inputs & ~DATA_STORED_FIELDS) || nullptr == row.derive ||
+         row.derive(defaults) != SYSTEM_DATA_SCHEMA[i].def) {
+        return false;
+      }
+    }
+    return true;
+  }
+  static_assert(isSchemaValid(), "SYSTEM_DATA_SCHEMA is invalid.");
+
+  // C++ type of the values of the ParamType
+  template <ParamType T> struct ParamStorage;
+  template <> struct ParamStorage<PARAM_UINT8> {
+    using Type = uint8_t;
+  };
+  template <> struct ParamStorage<PARAM_UINT32> {
+    using Type = uint32_t;
+  };
+  template <> struct ParamStorage<PARAM_BOOL> {
+    using Type = bool;
+  };
+
+  /**
+   * @brief C++ type of the data field, resolved at compile time from the schema.
+   */
+  template <DataField F> using DataType = typename ParamStorage<SYSTEM_DATA_SCHEMA[F].type>::Type;
 
   /**
    * @brief This is a template class for parameter that has its minimum and maximum value
+   * @note All types are stored as uint32_t (bool as 0 and 1), so the value is clamped by the same branch-free min/max for
+   *       every type. The type is checked only when the value is passed in or out as std::variant.
    */
   class SystemParam {
   private:
-    std::variant<uint8_t, uint32_t, bool> mValue;
-    std::variant<uint8_t, uint32_t, bool> mMin;
-    std::variant<uint8_t, uint32_t, bool> mMax;
+    uint32_t mValue;
+    uint32_t mMin;
+    uint32_t mMax;
+    ParamType mType;
+
+    // Clamps the value to the range
+    uint32_t clamp(uint32_t value) const { return std::min(std::max(value, mMin), mMax); }
 
   public:
     /**
@@ -36,7 +111,21 @@ namespace pedometer {
      * @brief Returns the value
      * @return value
      */
-    std::variant<uint8_t, uint32_t, bool> getValue(void) const;
+    std::variant<uint8_t, uint32_t, bool> getValue(void) const {
+      switch(mType) {
+      case PARAM_UINT8:
+        return static_cast<uint8_t>(mValue);
+      case PARAM_UINT32:
+        return mValue;
+      default:
+        return static_cast<bool>(mValue);
+      }
+    }
+
+    /**
+     * @brief Returns the value as uint32_t, bool is returned as 0 or 1
+     */
+    uint32_t getRawValue(void) const { return mValue; }
 
     /**
      * @brief Sets the range - minimum and maximum values
@@ -48,25 +137,214 @@ namespace pedometer {
      * @brief Sets the range - minimum and maximum values
      * @note Value is set always within the limits
      */
-    void increaseValue(void);
+    void increaseValue(void) {
+      // Maximum of every type fits uint32_t, the value can't overflow
+      mValue += static_cast<uint32_t>(mValue < mMax);
+    }
 
     /**
      * @brief Sets the range - minimum and maximum values
      * @note Value is set always within the limits
      */
-    void decreaseValue(void);
+    void decreaseValue(void) { mValue -= static_cast<uint32_t>(mValue > mMin); }
+  };
+
+  /**
+   * @brief Interface of an object that is notified when subscribed data fields change.
+   */
+  class DataObserver {
+  public:
+    /**
+     * @brief Called by SystemData in the context of the writer, once per write or committed transaction.
+     * @param fields mask of the subscribed data fields whose values have changed
+     * @note Should only record the change, e.g. set a flag; it must not modify the system data.
+     */
+    virtual void onDataChanged(uint32_t fields) = 0;
+    virtual ~DataObserver() = default;
+  };
+
+  /**
+   * @brief Consistent copy of a group of data fields, created by SystemData::snapshot(). Derived fields are computed
+   *        from the stored values of the same snapshot.
+   */
+  class DataSnapshot {
+  private:
+    std::array<uint32_t, DATA_FIELD_NUM> mValues = {};
+    uint32_t mFields = 0;
+    uint32_t mVersion = 0;
+
+    friend class SystemData;
+    friend class DataTransaction;
+
+  public:
+    /**
+     * @brief Returns the mask of the data fields in the snapshot.
+     */
+    uint32_t getFields(void) const { return mFields; }
+
+    /**
+     * @brief Returns the data version of the snapshot, see SystemData::changedSince().
+     */
+    uint32_t getVersion(void) const { return mVersion; }
+
+    /**
+     * @brief Returns the value of the data field, the field should be in the snapshot; otherwise 0 is returned.
+     */
+    template <DataField F> DataType<F> get(void) const {
+      static_assert(F < DATA_FIELD_NUM, "Invalid data field.");
+      return static_cast<DataType<F>>(mValues[F]);
+    }
+  };
+
+  class SystemData;
+
+  /**
+   * @brief Group of updates applied to the system data at once, created by SystemData::transaction().
+   *
+   * Updates are staged in the transaction and published by commit() in one write, so readers see either all old or all
+   * new values and observers are notified once. The transaction starts with a snapshot of the data; values staged by set()
+   * are returned by get(), other fields come from the snapshot. Commit writes only the staged fields, a change made by
+   * another writer between the snapshot and the commit is overwritten.
+   */
+  class DataTransaction {
+  private:
+    SystemData &mSystemData;
+    DataSnapshot mSnapshot;
+    uint32_t mStaged = 0;
+
+    friend class SystemData;
+    DataTransaction(SystemData &systemData, const DataSnapshot &snapshot) : mSystemData(systemData), mSnapshot(snapshot) {}
+
+  public:
+    /**
+     * @brief Returns the staged value of the data field or its value at the start of the transaction.
+     */
+    template <DataField F> DataType<F> get(void) const { return mSnapshot.get<F>(); }
+
+    /**
+     * @brief Stages the value of the data field, the value is clamped when the transaction is committed.
+     */
+    template <DataField F> DataTransaction &set(DataType<F> value) {
+      static_assert(F < DATA_FIRST_DERIVED, "Only stored data fields can be set.");
+      mSnapshot.mValues[F] = static_cast<uint32_t>(value);
+      mStaged |= dataMask(F);
+      return *this;
+    }
+
+    /**
+     * @brief Returns the mask of the staged data fields.
+     */
+    uint32_t getStaged(void) const { return mStaged; }
+
+    /**
+     * @brief Publishes all staged values at once and notifies observers of the changed fields. The transaction is
+     *        empty after the commit.
+     * @return mask of the data fields whose values have changed
+     */
+    uint32_t commit(void);
   };
 
+  /**
+   * @brief Clamps the raw value to the schema limits of the data field.
+   */
+  constexpr uint32_t clampData(DataField dataField, uint32_t value) {
+    return std::min(std::max(value, SYSTEM_DATA_SCHEMA[dataField].min), SYSTEM_DATA_SCHEMA[dataField].max);
+  }
+
   /**
    * @brief Class that represents system database.
+   *
+   * Values are kept as std::atomic<uint32_t> (types and limits come from SYSTEM_DATA_SCHEMA) and protected by a sequence
+   * lock. A single field is always read in one load, so it can't be torn. Writers serialize on a short critical section and
+   * make the sequence odd while they store, readers of several fields retry until they see the same even sequence before
+   * and after reading. Readers never block writers and writers never wait for readers.
+   *
+   * All writes are ISR safe (the critical section disables interrupts on the target), e.g. the step detection may call
+   * add<DATA_STEPS>() from an interrupt. Observers are called after the critical section in the context of the writer,
+   * observers of fields written from an ISR must be ISR safe too. Subscriptions are not synchronized and should be made
+   * during initialization.
+   *
+   * Derived fields (SYSTEM_DATA_SCHEMA rows from DATA_FIRST_DERIVED) are read like stored fields but can't be written.
+   * They are computed on read and memoized with the data version; the value is computed again only after one of its
+   * input fields has changed. The computation reads the inputs like any other reader and never enters the critical
+   * section. Observers of a derived field are notified when its inputs change.
    */
   class SystemData {
   private:
-    std::map<DataField, SystemParam> mData;
+    std::array<std::atomic<uint32_t>, DATA_FIRST_DERIVED> mValues;
+    std::atomic<uint32_t> mSequence{0};
+    std::atomic<uint32_t> mVersion{0};
+    std::array<std::atomic<uint32_t>, DATA_FIRST_DERIVED> mFieldVersions = {};
+    // Memoized derived values with the data version they are valid for, updated on read under their own sequence
+    struct DerivedValue {
+      std::atomic<uint32_t> value;
+      std::atomic<uint32_t> version;
+      std::atomic<uint32_t> sequence;
+    };
+    mutable std::array<DerivedValue, DATA_FIELD_NUM - DATA_FIRST_DERIVED> mDerived;
+    // Observers with the masks of their data fields, the first empty slot ends the list
+    struct Subscription {
+      DataObserver *observer;
+      uint32_t fields;
+    };
+    std::array<Subscription, SYSTEM_MAX_OBSERVERS> mObservers = {};
     bool mIsInitialized = false;
 
+    // Writer side of the sequence lock: enters the critical section and makes the sequence odd, then publishes the
+    // versions of the changed fields and makes the sequence even
+    void beginWrite(void);
+    void endWrite(uint32_t changed);
+
+    // Reader side of the sequence lock: waits for an even sequence and returns it, then checks that it hasn't changed
+    uint32_t beginRead(void) const {
+      uint32_t sequence;
+      while((sequence = mSequence.load(std::memory_order_acquire)) & 1) {
+      }
+      return sequence;
+    }
+    bool endRead(uint32_t sequence) const {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return sequence == mSequence.load(std::memory_order_relaxed);
+    }
+
+    // Stores the clamped value, must be called between beginWrite() and endWrite(); returns the mask of the field if
+    // the value has changed
+    uint32_t store(DataField dataField, uint32_t value) {
+      value = clampData(dataField, value);
+      uint32_t previous = mValues[dataField].load(std::memory_order_relaxed);
+      mValues[dataField].store(value, std::memory_order_relaxed);
+      return (previous != value) ? dataMask(dataField) : 0;
+    }
+
+    // Notifies every observer of the changed fields (and the derived fields depending on them) once
+    void notifyChanged(uint32_t changed) const;
+
+    // Returns the memoized value of the derived field, computes it again if its inputs have changed; doesn't block
+    uint32_t derive(DataField dataField) const;
+
+    // Stores the values of all fields in the mask at once and notifies observers; returns the mask of changed fields
+    uint32_t writeFields(uint32_t fields, const std::array<uint32_t, DATA_FIELD_NUM> &values);
+
+    friend class DataTransaction;
+
+    // Checks that the data field exists, throws std::invalid_argument otherwise
+    static DataField checkField(DataField dataField) {
+      if(dataField >= DATA_FIELD_NUM) {
+        throw std::invalid_argument("Invalid key.");
+      }
+      return dataField;
+    }
+
+    // Checks that the data field exists and is stored, throws std::invalid_argument otherwise
+    static DataField checkStoredField(DataField dataField) {
+      if(isDerived(checkField(dataField))) {
+        throw std::invalid_argument("Derived data field can't be set.");
+      }
+      return dataField;
+    }
+
     // One default constructor, disable copying
-    SystemData(void) = default;
+    SystemData(void);
     SystemData(const SystemData &) = delete;
     SystemData &operator=(const SystemData &) = delete;
     SystemData(SystemData &&) = delete;
@@ -75,10 +353,11 @@ namespace pedometer {
   public:
     /**
      * @brief Static constructor for Singleton instance. After calling the constructor, method init() should be called once.
+     * @note The instance is a static object, the system data doesn't use the heap.
      */
     static SystemData &GetInstance(void) {
-      static SystemData *systemData = new SystemData();
-      return *systemData;
+      static SystemData systemData;
+      return systemData;
     }
 
     /**
@@ -95,13 +374,147 @@ namespace pedometer {
 
     /**
      * @brief Sets the data value in the given data field
+     * @note Throws std::invalid_argument if the field doesn't exist, is derived or the value has another type than the
+     *       field.
      */
     void setData(std::variant<uint8_t, uint32_t, bool> value, DataField dataField);
 
+    /**
+     * @brief Returns the value of the data field with its type from the schema, e.g. get<DATA_STEPS>() returns uint32_t.
+     * @note Field and type are checked at compile time, the accessor doesn't throw.
+     */
+    template <DataField F> DataType<F> get(void) const {
+      static_assert(F < DATA_FIELD_NUM, "Invalid data field.");
+      if constexpr(isDerived(F)) {
+        return static_cast<DataType<F>>(derive(F));
+      } else {
+        return static_cast<DataType<F>>(mValues[F].load(std::memory_order_relaxed));
+      }
+    }
+
+    /**
+     * @brief Returns consistent values of several stored data fields, e.g. auto [h, m, s] = read<DATA_HOURS, DATA_MINUTES,
+     *        DATA_SECONDS>(). The values are read again if a writer changed the data meanwhile.
+     * @note Derived fields are read consistently with their inputs by snapshot().
+     */
+    template <DataField... F> std::tuple<DataType<F>...> read(void) const {
+      static_assert(((F < DATA_FIRST_DERIVED) && ...), "Only stored data fields can be read at once.");
+      std::tuple<DataType<F>...> values;
+      uint32_t sequence;
+      do {
+        sequence = beginRead();
+        values = std::tuple<DataType<F>...>(static_cast<DataType<F>>(mValues[F].load(std::memory_order_relaxed))...);
+      } while(!endRead(sequence));
+      return values;
+    }
+
+    /**
+     * @brief Returns a consistent copy of the given data fields, e.g. snapshot(dataMask(DATA_HOURS) | dataMask(DATA_MINUTES)).
+     */
+    DataSnapshot snapshot(uint32_t fields = DATA_ALL_FIELDS) const;
+
+    /**
+     * @brief Returns the data version. The version is increased by every write that changes at least one field.
+     */
+    uint32_t getVersion(void) const { return mVersion.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Returns the data version of the last change of the data field, the latest change of the inputs of a derived
+     *        field.
+     */
+    uint32_t getFieldVersion(DataField dataField) const;
+
+    /**
+     * @brief Returns the mask of the data fields changed after the given version. Versions wrap around, the result is
+     *        valid for versions less than 2^31 writes old.
+     * @param current returns the current data version, changes are polled again from it
+     */
+    uint32_t changedSince(uint32_t version, uint32_t &current) const;
+    uint32_t changedSince(uint32_t version) const {
+      uint32_t current;
+      return changedSince(version, current);
+    }
+
+    /**
+     * @brief Starts a transaction over a snapshot of the given stored data fields.
+     */
+    DataTransaction transaction(uint32_t fields = DATA_STORED_FIELDS) { return DataTransaction(*this, snapshot(fields)); }
+
+    /**
+     * @brief Sets the value of the data field, e.g. set<DATA_HOURS>(12). Observers are notified if the value changes.
+     * @note Field and type are checked at compile time, the accessor doesn't throw. Value is set always within the limits.
+     */
+    template <DataField F> void set(DataType<F> value) { write<F>(value); }
+
+    /**
+     * @brief Sets several data fields at once, e.g. write<DATA_HOURS, DATA_MINUTES>(12, 30). Readers of the fields see
+     *        either all old or all new values.
+     */
+    template <DataField... F> void write(DataType<F>... values) {
+      static_assert(((F < DATA_FIRST_DERIVED) && ...), "Only stored data fields can be set.");
+      uint32_t changed = 0;
+      beginWrite();
+      ((changed |= store(F, static_cast<uint32_t>(values))), ...);
+      endWrite(changed);
+      notifyChanged(changed);
+    }
+
+    /**
+     * @brief Adds to the value of the data field, the sum is clamped to the maximum. ISR safe.
+     */
+    template <DataField F> void add(DataType<F> delta) {
+      static_assert(F < DATA_FIRST_DERIVED && PARAM_BOOL != SYSTEM_DATA_SCHEMA[F].type, "Only stored numbers can be added.");
+      beginWrite();
+      uint32_t value = mValues[F].load(std::memory_order_relaxed);
+      // Saturating sum, the maximum of the field is below UINT32_MAX
+      uint32_t changed = store(F, (delta > SYSTEM_DATA_SCHEMA[F].max - value) ? SYSTEM_DATA_SCHEMA[F].max : value + delta);
+      endWrite(changed);
+      notifyChanged(changed);
+    }
+
     /**
      * @brief Changes the given value: increases or decreases it
      */
     void changeValue(DataField dataField, bool increase);
+
+    /**
+     * @brief Subscribes the observer to changes of the data field. Observers are notified only if the value really changes;
+     *        an observer of several fields is notified once per write with the mask of its changed fields.
+     * @note The observer has to unsubscribe before it is destroyed. Throws std::length_error if there already are
+     *       SYSTEM_MAX_OBSERVERS other observers.
+     */
+    void subscribe(DataField dataField, DataObserver *observer);
+
+    /**
+     * @brief Removes the observer subscription of the data field.
+     */
+    void unsubscribe(DataField dataField, DataObserver *observer);
+  };
+
+  /**
+   * @brief Dirty field tracking of a single consumer, e.g. the menu, the persistence or a BLE notifier. Each consumer has
+   *        its own tracker, so polling by one consumer doesn't hide the changes from the others.
+   */
+  class DataChangeTracker {
+  private:
+    const SystemData &mSystemData;
+    uint32_t mVersion;
+
+  public:
+    /**
+     * @brief Starts tracking from the current data version.
+     */
+    explicit DataChangeTracker(const SystemData &systemData) : mSystemData(systemData), mVersion(systemData.getVersion()) {}
+
+    /**
+     * @brief Returns the mask of the data fields changed since the last poll without clearing it.
+     */
+    uint32_t peek(void) const { return mSystemData.changedSince(mVersion); }
+
+    /**
+     * @brief Returns the mask of the data fields changed since the last poll and clears it.
+     */
+    uint32_t poll(void) { return mSystemData.changedSince(mVersion, mVersion); }
   };
 } // namespace pedometer
 
@@ -1,13 +1,90 @@
 #ifndef SYSTEM_DATA_CONFIG_H
 #define SYSTEM_DATA_CONFIG_H
 
+#include <cstdint>
+
 namespace pedometer {
-  enum : uint32_t { SYSTEM_STEPS_MIN = 0, SYSTEM_STEPS_DEFAULT = 0, SYSTEM_STEPS_MAX = 99999 };
-  enum : uint32_t { SYSTEM_TARGET_STEPS_MIN = 100, SYSTEM_TARGET_STEPS_DEFAULT = 1000, SYSTEM_TARGET_STEPS_MAX = 99999 };
 
-  enum : uint8_t { SYSTEM_HOURS_MIN = 0, SYSTEM_HOURS_DEFAULT = 0, SYSTEM_HOURS_MAX = 23 };
-  enum : uint8_t { SYSTEM_MINUTES_MIN = 0, SYSTEM_MINUTES_DEFAULT = 0, SYSTEM_MINUTES_MAX = 59 };
-  enum : uint8_t { SYSTEM_SECONDS_MIN = 0, SYSTEM_SECONDS_DEFAULT = 0, SYSTEM_SECONDS_MAX = 59 };
+  // Stored data fields are followed by derived fields, which are computed from the stored ones
+  enum DataField : uint8_t {
+    DATA_STEPS,
+    DATA_TARGET_STEPS,
+    DATA_HOURS,
+    DATA_MINUTES,
+    DATA_SECONDS,
+    DATA_GOAL_PERCENT,
+    DATA_REMAINING_STEPS,
+    DATA_PACE,
+    DATA_FIELD_NUM
+  };
+  inline constexpr DataField DATA_FIRST_DERIVED = DATA_GOAL_PERCENT;
+
+  /**
+   * @brief Returns the mask of the data field, masks of several fields are combined with |.
+   */
+  constexpr uint32_t dataMask(DataField dataField) { return 1UL << dataField; }
+
+  // Type of the value stored in the data field
+  enum ParamType : uint8_t { PARAM_UINT8, PARAM_UINT32, PARAM_BOOL };
+
+  /**
+   * @brief Row of the system data schema. Values of all types are given as uint32_t, bool as 0 and 1.
+   */
+  struct DataSchema {
+    DataField field;
+    ParamType type;
+    uint32_t min;
+    uint32_t def;
+    uint32_t max;
+  };
+
+  // Schema of the system data in the DataField order
+  inline constexpr DataSchema SYSTEM_DATA_SCHEMA[DATA_FIELD_NUM] = {
+      // field                 type          min    default  max
+      {DATA_STEPS,            PARAM_UINT32, 0,     0,       99999},
+      {DATA_TARGET_STEPS,     PARAM_UINT32, 100,   1000,    99999},
+      {DATA_HOURS,            PARAM_UINT8,  0,     0,       23},
+      {DATA_MINUTES,          PARAM_UINT8,  0,     0,       59},
+      {DATA_SECONDS,          PARAM_UINT8,  0,     0,       59},
+      {DATA_GOAL_PERCENT,     PARAM_UINT32, 0,     0,       100},
+      {DATA_REMAINING_STEPS,  PARAM_UINT32, 0,     1000,    99999},
+      {DATA_PACE,             PARAM_UINT32, 0,     0,       999},
+  };
+
+  /**
+   * @brief Row of the derived data schema. The value is computed from the values of the input fields (indexed by
+   *        DataField) and clamped to the limits of the field in SYSTEM_DATA_SCHEMA.
+   */
+  struct DerivedSchema {
+    DataField field;
+    uint32_t inputs;
+    uint32_t (*derive)(const uint32_t *values);
+  };
+
+  // Percentage of the target steps reached, the target is never 0
+  constexpr uint32_t deriveGoalPercent(const uint32_t *values) {
+    return (values[DATA_STEPS] >= values[DATA_TARGET_STEPS]) ? 100 : values[DATA_STEPS] * 100 / values[DATA_TARGET_STEPS];
+  }
+
+  constexpr uint32_t deriveRemainingSteps(const uint32_t *values) {
+    return (values[DATA_STEPS] >= values[DATA_TARGET_STEPS]) ? 0 : values[DATA_TARGET_STEPS] - values[DATA_STEPS];
+  }
+
+  // Average steps per minute since midnight, ClockCounter resets the steps at midnight; the first minute counts as one
+  constexpr uint32_t derivePace(const uint32_t *values) {
+    uint32_t minutes = values[DATA_HOURS] * 60 + values[DATA_MINUTES];
+    return values[DATA_STEPS] / ((0 == minutes) ? 1 : minutes);
+  }
+
+  // Derived data fields in the DataField order, starting with DATA_FIRST_DERIVED
+  inline constexpr DerivedSchema DERIVED_DATA_SCHEMA[DATA_FIELD_NUM - DATA_FIRST_DERIVED] = {
+      {DATA_GOAL_PERCENT, dataMask(DATA_STEPS) | dataMask(DATA_TARGET_STEPS), deriveGoalPercent},
+      {DATA_REMAINING_STEPS, dataMask(DATA_STEPS) | dataMask(DATA_TARGET_STEPS), deriveRemainingSteps},
+      {DATA_PACE, dataMask(DATA_STEPS) | dataMask(DATA_HOURS) | dataMask(DATA_MINUTES), derivePace},
+  };
+
+  // Maximum number of observers of the system data, observers are kept in a fixed array
+  enum : uint8_t { SYSTEM_MAX_OBSERVERS = 4 };
 } // namespace pedometer
 
 #endif // SYSTEM_DATA_CONFIG_H
@@ -1,6 +1,10 @@
 #include "system_data.hpp"
 #include "system_data_config.hpp"
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#endif
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <stdexcept>
 #include <type_traits>
@@ -11,134 +15,301 @@ using namespace pedometer;
 SystemParam::SystemParam(std::variant<uint8_t, uint32_t, bool> value, std::variant<uint8_t, uint32_t, bool> min,
                          std::variant<uint8_t, uint32_t, bool> max) {
   if(std::holds_alternative<uint8_t>(value) && std::holds_alternative<uint8_t>(min) && std::holds_alternative<uint8_t>(max)) {
-    mMin = min;
-    mMax = max;
-    mValue = std::clamp(value, mMin, mMax);
+    mType = PARAM_UINT8;
+    mMin = std::get<uint8_t>(min);
+    mMax = std::get<uint8_t>(max);
+    mValue = clamp(std::get<uint8_t>(value));
   } else if(std::holds_alternative<uint32_t>(value) && std::holds_alternative<uint32_t>(min) && std::holds_alternative<uint32_t>(max)) {
-    mMin = min;
-    mMax = max;
-    mValue = std::clamp(value, mMin, mMax);
+    mType = PARAM_UINT32;
+    mMin = std::get<uint32_t>(min);
+    mMax = std::get<uint32_t>(max);
+    mValue = clamp(std::get<uint32_t>(value));
   } else if(std::holds_alternative<bool>(value) && std::holds_alternative<bool>(min) && std::holds_alternative<bool>(max)) {
+    // Limits of bool are ignored
+    mType = PARAM_BOOL;
     mMin = false;
     mMax = true;
-    mValue = value;
+    mValue = std::get<bool>(value);
   } else {
     throw std::invalid_argument("All the arguments must be the same type. Available types: uint8_t, uint32_t or bool.");
   }
 }
 
-std::variant<uint8_t, uint32_t, bool> SystemParam::getValue(void) const {
-  if(std::holds_alternative<uint8_t>(mValue) || std::holds_alternative<uint32_t>(mValue) || std::holds_alternative<bool>(mValue)) {
-    return mValue;
-  } else {
-    return (uint8_t)0;
-  }
-}
-
 void SystemParam::setValue(std::variant<uint8_t, uint32_t, bool> value) {
-  if(std::holds_alternative<uint8_t>(mValue) && std::holds_alternative<uint8_t>(value)) {
-    mValue = std::clamp(value, mMin, mMax);
-  } else if(std::holds_alternative<uint32_t>(mValue) && std::holds_alternative<uint32_t>(value)) {
-    mValue = std::clamp(value, mMin, mMax);
-  } else if(std::holds_alternative<bool>(mValue) && std::holds_alternative<bool>(value)) {
-    mValue = value;
-  } else {
+  if(value.index() != mType) {
     throw std::invalid_argument("Argument must be of uint8_t, uint32_t or bool type and the same as currently stored type.");
   }
+  mValue = clamp(std::visit([](auto raw) { return static_cast<uint32_t>(raw); }, value));
 }
 
-void SystemParam::increaseValue(void) {
-  if(std::holds_alternative<uint8_t>(mValue)) {
-    if(UINT8_MAX > std::get<uint8_t>(mValue)) {
-      mValue = std::clamp(static_cast<uint8_t>(std::get<uint8_t>(mValue) + 1), std::get<uint8_t>(mMin), std::get<uint8_t>(mMax));
-    }
-  } else if(std::holds_alternative<uint32_t>(mValue)) {
-    if(UINT32_MAX > std::get<uint32_t>(mValue)) {
-      mValue = std::clamp(static_cast<uint32_t>(std::get<uint32_t>(mValue) + 1), std::get<uint32_t>(mMin), std::get<uint32_t>(mMax));
-    }
-  } else if(std::holds_alternative<bool>(mValue)) {
-    if(false == std::get<bool>(mValue)) {
-      mValue = true;
-    }
+// Writers are serialized by a critical section; on the target it disables interrupts, so it can be entered from an ISR
+#ifdef ESP_PLATFORM
+static portMUX_TYPE sWriteLock = portMUX_INITIALIZER_UNLOCKED;
+
+static void lockWrites(void) {
+  portENTER_CRITICAL_SAFE(&sWriteLock);
+}
+
+static void unlockWrites(void) {
+  portEXIT_CRITICAL_SAFE(&sWriteLock);
+}
+#else
+static std::atomic_flag sWriteLock = ATOMIC_FLAG_INIT;
+
+static void lockWrites(void) {
+  while(sWriteLock.test_and_set(std::memory_order_acquire)) {
   }
 }
 
-void SystemParam::decreaseValue(void) {
-  if(std::holds_alternative<uint8_t>(mValue)) {
-    if(0 < std::get<uint8_t>(mValue)) {
-      mValue = std::clamp(static_cast<uint8_t>(std::get<uint8_t>(mValue) - 1), std::get<uint8_t>(mMin), std::get<uint8_t>(mMax));
-    }
-  } else if(std::holds_alternative<uint32_t>(mValue)) {
-    if(0 < std::get<uint32_t>(mValue)) {
-      mValue = std::clamp(static_cast<uint32_t>(std::get<uint32_t>(mValue) - 1), std::get<uint32_t>(mMin), std::get<uint32_t>(mMax));
-    }
-  } else if(std::holds_alternative<bool>(mValue)) {
-    if(true == std::get<bool>(mValue)) {
-      mValue = false;
+static void unlockWrites(void) {
+  sWriteLock.clear(std::memory_order_release);
+}
+#endif
+
+SystemData::SystemData(void) {
+  for(uint8_t field = 0; field < DATA_FIELD_NUM; field++) {
+    if(isDerived(static_cast<DataField>(field))) {
+      // Defaults of the derived fields are derived from the stored defaults, they are valid for the initial version
+      mDerived[field - DATA_FIRST_DERIVED].value.store(SYSTEM_DATA_SCHEMA[field].def, std::memory_order_relaxed);
+      mDerived[field - DATA_FIRST_DERIVED].version.store(0, std::memory_order_relaxed);
+      mDerived[field - DATA_FIRST_DERIVED].sequence.store(0, std::memory_order_relaxed);
+    } else {
+      mValues[field].store(SYSTEM_DATA_SCHEMA[field].def, std::memory_order_relaxed);
     }
   }
 }
 
 void SystemData::init(void) {
   if(!mIsInitialized) {
-    mData.insert({DATA_STEPS, SystemParam(static_cast<uint32_t>(SYSTEM_STEPS_MIN), static_cast<uint32_t>(SYSTEM_STEPS_DEFAULT),
-                                          static_cast<uint32_t>(SYSTEM_STEPS_MAX))});
-    mData.insert({DATA_TARGET_STEPS, SystemParam(static_cast<uint32_t>(SYSTEM_TARGET_STEPS_MIN), static_cast<uint32_t>(SYSTEM_TARGET_STEPS_DEFAULT),
-                                                 static_cast<uint32_t>(SYSTEM_TARGET_STEPS_MAX))});
-    mData.insert({DATA_HOURS, SystemParam(static_cast<uint8_t>(SYSTEM_HOURS_MIN), static_cast<uint8_t>(SYSTEM_HOURS_DEFAULT),
-                                          static_cast<uint8_t>(SYSTEM_HOURS_MAX))});
-    mData.insert({DATA_MINUTES, SystemParam(static_cast<uint8_t>(SYSTEM_MINUTES_MIN), static_cast<uint8_t>(SYSTEM_MINUTES_DEFAULT),
-                                            static_cast<uint8_t>(SYSTEM_MINUTES_MAX))});
-    mData.insert({DATA_SECONDS, SystemParam(static_cast<uint8_t>(SYSTEM_SECONDS_MIN), static_cast<uint8_t>(SYSTEM_SECONDS_DEFAULT),
-                                            static_cast<uint8_t>(SYSTEM_SECONDS_MAX))});
+    uint32_t changed = 0;
+    beginWrite();
+    for(uint8_t field = 0; field < DATA_FIRST_DERIVED; field++) {
+      changed |= store(static_cast<DataField>(field), SYSTEM_DATA_SCHEMA[field].def);
+    }
+    endWrite(changed);
     mIsInitialized = true;
   } else {
     throw std::runtime_error("SystemData instance is already initialized.");
   }
 }
 
-std::variant<uint8_t, uint32_t, bool> SystemData::getData(DataField dataField) const {
-  auto data = mData.find(dataField);
-  if(data != mData.end()) {
-    if(std::holds_alternative<uint8_t>(data->second.getValue())) {
-      return std::get<uint8_t>(data->second.getValue());
-    } else if(std::holds_alternative<uint32_t>(data->second.getValue())) {
-      return std::get<uint32_t>(data->second.getValue());
-    } else if(std::holds_alternative<bool>(data->second.getValue())) {
-      return std::get<bool>(data->second.getValue());
-    } else {
-      // throw std::invalid_argument("Invalid key.");
-      return (uint8_t)0;
+void SystemData::beginWrite(void) {
+  lockWrites();
+  mSequence.store(mSequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SystemData::endWrite(uint32_t changed) {
+  if(0 != changed) {
+    uint32_t version = mVersion.load(std::memory_order_relaxed) + 1;
+    for(uint8_t field = 0; field < DATA_FIRST_DERIVED; field++) {
+      if(changed & dataMask(static_cast<DataField>(field))) {
+        mFieldVersions[field].store(version, std::memory_order_relaxed);
+      }
     }
-  } else {
-    throw std::invalid_argument("Invalid key.");
+    mVersion.store(version, std::memory_order_release);
   }
+  mSequence.store(mSequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  unlockWrites();
 }
 
-void SystemData::setData(std::variant<uint8_t, uint32_t, bool> value, DataField dataField) {
-  auto data = mData.find(dataField);
-  if(data != mData.end()) {
-    if(std::holds_alternative<uint8_t>(data->second.getValue())) {
-      data->second.setValue(std::get<uint8_t>(value));
-    } else if(std::holds_alternative<uint32_t>(data->second.getValue())) {
-      data->second.setValue(std::get<uint32_t>(value));
-    } else if(std::holds_alternative<bool>(data->second.getValue())) {
-      data->second.setValue(std::get<bool>(value));
+uint32_t SystemData::derive(DataField dataField) const {
+  DerivedValue &derived = mDerived[dataField - DATA_FIRST_DERIVED];
+  const DerivedSchema &schema = derivedSchema(dataField);
+  // Memo has its own sequence, odd while a reader publishes it; a memo read during the publishing isn't used
+  uint32_t memoSequence = derived.sequence.load(std::memory_order_acquire);
+  uint32_t memoized = derived.version.load(std::memory_order_relaxed);
+  uint32_t value = derived.value.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  bool isMemoValid = !(memoSequence & 1) && memoSequence == derived.sequence.load(std::memory_order_relaxed);
+  // Memoized value is valid while the data version doesn't change
+  if(isMemoValid && memoized == mVersion.load(std::memory_order_acquire)) {
+    return value;
+  }
+  // Inputs, their versions and the data version are read like any other fields, readers retry when a writer interferes
+  uint32_t values[DATA_FIRST_DERIVED] = {};
+  uint32_t version;
+  bool isStale;
+  uint32_t sequence;
+  do {
+    sequence = beginRead();
+    isStale = !isMemoValid;
+    for(uint8_t field = 0; field < DATA_FIRST_DERIVED; field++) {
+      if(schema.inputs & dataMask(static_cast<DataField>(field))) {
+        values[field] = mValues[field].load(std::memory_order_relaxed);
+        isStale |= static_cast<int32_t>(mFieldVersions[field].load(std::memory_order_relaxed) - memoized) > 0;
+      }
     }
-  } else {
-    throw std::invalid_argument("Invalid key.");
+    version = mVersion.load(std::memory_order_relaxed);
+  } while(!endRead(sequence));
+  if(isStale) {
+    value = clampData(dataField, schema.derive(values));
   }
+  // Memo is published only if nobody has touched it since it was read, so it never goes back to an older version.
+  // A reader that loses the race just returns its value, readers never wait for each other.
+  if(isMemoValid && derived.sequence.compare_exchange_strong(memoSequence, memoSequence + 1, std::memory_order_relaxed)) {
+    std::atomic_thread_fence(std::memory_order_release);
+    derived.value.store(value, std::memory_order_relaxed);
+    derived.version.store(version, std::memory_order_relaxed);
+    derived.sequence.store(memoSequence + 2, std::memory_order_release);
+  }
+  return value;
 }
 
-void SystemData::changeValue(DataField dataField, bool increase) {
-  auto data = mData.find(dataField);
-  if(data != mData.end()) {
-    if(SYSTEM_INCREASE_VAL == increase) {
-      data->second.increaseValue();
-    } else {
-      data->second.decreaseValue();
+uint32_t SystemData::getFieldVersion(DataField dataField) const {
+  if(!isDerived(checkField(dataField))) {
+    return mFieldVersions[dataField].load(std::memory_order_acquire);
+  }
+  // Latest version of the inputs, versions are compared by their wrap-around safe difference
+  uint32_t latest = 0;
+  for(uint8_t field = 0; field < DATA_FIRST_DERIVED; field++) {
+    uint32_t version = mFieldVersions[field].load(std::memory_order_acquire);
+    if((derivedSchema(dataField).inputs & dataMask(static_cast<DataField>(field))) && static_cast<int32_t>(version - latest) > 0) {
+      latest = version;
     }
+  }
+  return latest;
+}
+
+std::variant<uint8_t, uint32_t, bool> SystemData::getData(DataField dataField) const {
+  uint32_t value = isDerived(checkField(dataField)) ? derive(dataField) : mValues[dataField].load(std::memory_order_relaxed);
+  switch(SYSTEM_DATA_SCHEMA[dataField].type) {
+  case PARAM_UINT8:
+    return static_cast<uint8_t>(value);
+  case PARAM_UINT32:
+    return value;
+  default:
+    return static_cast<bool>(value);
+  }
+}
+
+void SystemData::setData(std::variant<uint8_t, uint32_t, bool> value, DataField dataField) {
+  if(value.index() != SYSTEM_DATA_SCHEMA[checkStoredField(dataField)].type) {
+    throw std::invalid_argument("Argument must be of uint8_t, uint32_t or bool type and the same as currently stored type.");
+  }
+  beginWrite();
+  uint32_t changed = store(dataField, std::visit([](auto raw) { return static_cast<uint32_t>(raw); }, value));
+  endWrite(changed);
+  notifyChanged(changed);
+}
+
+void SystemData::changeValue(DataField dataField, bool increase) {
+  const DataSchema &schema = SYSTEM_DATA_SCHEMA[checkStoredField(dataField)];
+  beginWrite();
+  uint32_t value = mValues[dataField].load(std::memory_order_relaxed);
+  if(SYSTEM_INCREASE_VAL == increase) {
+    value += static_cast<uint32_t>(value < schema.max);
   } else {
-    throw std::invalid_argument("Invalid key.");
+    value -= static_cast<uint32_t>(value > schema.min);
+  }
+  uint32_t changed = store(dataField, value);
+  endWrite(changed);
+  notifyChanged(changed);
+}
+
+DataSnapshot SystemData::snapshot(uint32_t fields) const {
+  DataSnapshot snapshot;
+  snapshot.mFields = fields & DATA_ALL_FIELDS;
+  // Inputs of the derived fields are read with the requested fields
+  uint32_t stored = snapshot.mFields & DATA_STORED_FIELDS;
+  for(const DerivedSchema &row : DERIVED_DATA_SCHEMA) {
+    stored |= (snapshot.mFields & dataMask(row.field)) ? row.inputs : 0;
+  }
+  uint32_t sequence;
+  do {
+    sequence = beginRead();
+    for(uint8_t field = 0; field < DATA_FIRST_DERIVED; field++) {
+      if(stored & dataMask(static_cast<DataField>(field))) {
+        snapshot.mValues[field] = mValues[field].load(std::memory_order_relaxed);
+      }
+    }
+    snapshot.mVersion = mVersion.load(std::memory_order_relaxed);
+  } while(!endRead(sequence));
+  for(const DerivedSchema &row : DERIVED_DATA_SCHEMA) {
+    if(snapshot.mFields & dataMask(row.field)) {
+      snapshot.mValues[row.field] = clampData(row.field, row.derive(snapshot.mValues.data()));
+    }
+  }
+  return snapshot;
+}
+
+uint32_t SystemData::changedSince(uint32_t version, uint32_t &current) const {
+  uint32_t changed;
+  uint32_t sequence;
+  do {
+    sequence = beginRead();
+    changed = 0;
+    for(uint8_t field = 0; field < DATA_FIRST_DERIVED; field++) {
+      // Difference of the versions is wrap-around safe
+      if(static_cast<int32_t>(mFieldVersions[field].load(std::memory_order_relaxed) - version) > 0) {
+        changed |= dataMask(static_cast<DataField>(field));
+      }
+    }
+    current = mVersion.load(std::memory_order_relaxed);
+  } while(!endRead(sequence));
+  return withDerived(changed);
+}
+
+uint32_t SystemData::writeFields(uint32_t fields, const std::array<uint32_t, DATA_FIELD_NUM> &values) {
+  uint32_t changed = 0;
+  beginWrite();
+  for(uint8_t field = 0; field < DATA_FIRST_DERIVED; field++) {
+    if(fields & dataMask(static_cast<DataField>(field))) {
+      changed |= store(static_cast<DataField>(field), values[field]);
+    }
+  }
+  endWrite(changed);
+  notifyChanged(changed);
+  return changed;
+}
+
+uint32_t DataTransaction::commit(void) {
+  uint32_t changed = mSystemData.writeFields(mStaged, mSnapshot.mValues);
+  mStaged = 0;
+  return changed;
+}
+
+void SystemData::subscribe(DataField dataField, DataObserver *observer) {
+  if(nullptr == observer) {
+    throw std::invalid_argument("Observer can't be null.");
+  }
+  uint32_t field = dataMask(checkField(dataField));
+  for(Subscription &subscription : mObservers) {
+    if(observer == subscription.observer) {
+      subscription.fields |= field;
+      return;
+    }
+    if(nullptr == subscription.observer) {
+      subscription = Subscription{observer, field};
+      return;
+    }
+  }
+  throw std::length_error("Too many observers of the system data.");
+}
+
+void SystemData::unsubscribe(DataField dataField, DataObserver *observer) {
+  uint32_t field = dataMask(checkField(dataField));
+  for(Subscription &subscription : mObservers) {
+    if(observer == subscription.observer) {
+      subscription.fields &= ~field;
+    }
+  }
+  // Observers without fields are removed, remaining ones are moved to the front
+  auto end = std::remove_if(mObservers.begin(), mObservers.end(), [](const Subscription &subscription) { return 0 == subscription.fields; });
+  std::fill(end, mObservers.end(), Subscription{nullptr, 0});
+}
+
+void SystemData::notifyChanged(uint32_t changed) const {
+  if(0 == changed) {
+    return;
+  }
+  changed = withDerived(changed);
+  for(const Subscription &subscription : mObservers) {
+    if(nullptr == subscription.observer) {
+      break;
+    }
+    if(subscription.fields & changed) {
+      subscription.observer->onDataChanged(subscription.fields & changed);
+    }
   }
 }
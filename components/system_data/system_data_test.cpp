@@ -62,5 +62,5 @@ TEST(SystemDataTest, ChangeValue) {
 
   uint8_t before = std::get<uint8_t>(data.getData(DATA_MINUTES));
   data.changeValue(DATA_MINUTES, SYSTEM_INCREASE_VAL);
-  EXPECT_EQ(std::get<uint8_t>(data.getData(DATA_MINUTES)), std::min<uint8_t>(before + 1, SYSTEM_MINUTES_MAX));
+  EXPECT_EQ(std::get<uint8_t>(data.getData(DATA_MINUTES)), std::min<uint8_t>(before + 1, SYSTEM_DATA_SCHEMA[DATA_MINUTES].max));
 }
@@ -0,0 +1,161 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "timer_wheel_config.hpp"
+#include <array>
+#include <cstdint>
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#endif
+
+namespace pedometer {
+
+  enum : uint32_t { TIMER_WHEEL_SLOTS = 1UL << TIMER_WHEEL_SLOT_BITS };
+
+  // Longest delay in ticks, the last level can't hold a timer a whole turn ahead
+  enum : uint64_t { TIMER_WHEEL_MAX_TICKS = (static_cast<uint64_t>(TIMER_WHEEL_SLOTS - 1) << (TIMER_WHEEL_SLOT_BITS * (TIMER_WHEEL_LEVELS - 1))) - 1 };
+
+  /**
+   * @brief Function called when a scheduled timer expires.
+   */
+  using TimerCallback = void (*)(void *context);
+
+  /**
+   * @brief Timer scheduled by TimerWheel. The object is owned by the user and linked into the wheel while it is active,
+   *        the wheel doesn't allocate. The timer must be cancelled before it is destroyed.
+   */
+  class ScheduledTimer {
+  private:
+    TimerCallback mCallback;
+    void *mContext;
+    uint64_t mExpiryTick = 0;
+    uint64_t mPeriodTicks = 0;
+    ScheduledTimer *mPrev = nullptr;
+    ScheduledTimer *mNext = nullptr;
+    // List the timer is linked in, nullptr if the timer isn't active
+    ScheduledTimer **mList = nullptr;
+
+    friend class TimerWheel;
+
+  public:
+    /**
+     * @brief Constructor.
+     */
+    explicit ScheduledTimer(TimerCallback callback, void *context = nullptr) : mCallback(callback), mContext(context) {}
+
+    // Disable copying, the wheel links the object itself
+    ScheduledTimer(const ScheduledTimer &) = delete;
+    ScheduledTimer &operator=(const ScheduledTimer &) = delete;
+
+    /**
+     * @brief Returns true if the timer is scheduled.
+     */
+    bool isActive(void) const { return nullptr != mList; }
+  };
+
+  /**
+   * @brief Class that represents the hierarchical timing wheel of the firmware.
+   *
+   * Level L has TIMER_WHEEL_SLOTS slots of 2^(L * TIMER_WHEEL_SLOT_BITS) ticks. A timer is linked into the slot of the
+   * highest digit in which its expiry differs from the current tick, so starting and cancelling is O(1). When the time
+   * reaches a slot of a higher level, its timers move down to the lower levels and expire from the first one. Each level
+   * keeps a bitmap of occupied slots, the next deadline is found without walking the slots.
+   *
+   * The wheel isn't synchronized, all methods should be called from one task. On the target init() creates one esp_timer
+   * which is armed for the next deadline only and posts EVENT_TIMER, the main task advances the wheel in the handler.
+   */
+  class TimerWheel {
+  private:
+    // Heads of the slot lists, slot S of level L is at L * TIMER_WHEEL_SLOTS + S
+    std::array<ScheduledTimer *, TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS> mSlots = {};
+    std::array<uint64_t, TIMER_WHEEL_LEVELS> mOccupied = {};
+    // Timers expired in the current tick and timers whose callbacks are being called
+    ScheduledTimer *mExpired = nullptr;
+    ScheduledTimer *mFiring = nullptr;
+    uint64_t mCurrentTick = 0;
+    uint32_t mActive = 0;
+#ifdef ESP_PLATFORM
+    esp_timer_handle_t mTimer = nullptr;
+    uint64_t mArmedUs = TIMER_WHEEL_NO_DEADLINE;
+
+    // Callback of the esp_timer, wakes the main task
+    static void onDeadline(void *args);
+
+    // Handler of EVENT_TIMER in the main task
+    static void onTimerEvent(void *context);
+#endif
+
+    // Links the timer into the list of its expiry
+    void insert(ScheduledTimer &timer);
+
+    // Links the timer into the list, the slot bit is set by the caller
+    static void link(ScheduledTimer **list, ScheduledTimer &timer);
+
+    // Unlinks the timer and clears the bit of the slot if it becomes empty
+    void unlink(ScheduledTimer &timer);
+
+    // Arms the esp_timer for the next deadline if it has changed
+    void rearm(uint64_t nowUs);
+
+  public:
+    /**
+     * @brief Constructor of an empty wheel. The firmware uses the GetInstance() wheel, other instances serve e.g. tests.
+     */
+    TimerWheel(void) = default;
+
+    // Disable copying, active timers are linked into the wheel
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    /**
+     * @brief Static constructor for the Singleton instance of the firmware scheduler.
+     */
+    static TimerWheel &GetInstance(void) {
+      static TimerWheel timerWheel;
+      return timerWheel;
+    }
+
+    /**
+     * @brief Starts the timer. An active timer is started again.
+     * @param nowUs current time in microseconds, the wheel counts the ticks from the first timer
+     * @param delayUs time to the expiry, the timer never expires earlier; it is rounded up to whole ticks
+     * @param periodUs period of a periodic timer, 0 for a one-shot timer; missed periods are skipped
+     * @note Throws std::out_of_range if the expiry is more than TIMER_WHEEL_MAX_TICKS ahead.
+     */
+    void start(ScheduledTimer &timer, uint64_t nowUs, uint64_t delayUs, uint64_t periodUs = 0);
+
+    /**
+     * @brief Cancels the timer, an inactive timer is ignored.
+     */
+    void cancel(ScheduledTimer &timer);
+
+    /**
+     * @brief Moves the wheel to the current time and calls the callbacks of the expired timers. Callbacks may start and
+     *        cancel timers; a timer started to expire at once is called in the next advance().
+     * @param nowUs current time in microseconds, it must not go back
+     * @return number of called callbacks
+     */
+    uint32_t advance(uint64_t nowUs);
+
+    /**
+     * @brief Returns the time in microseconds when advance() has work to do: a timer expires or timers of a higher level
+     *        move down. TIMER_WHEEL_NO_DEADLINE if there is no active timer.
+     */
+    uint64_t getNextDeadlineUs(void) const;
+
+    /**
+     * @brief Returns the number of active timers.
+     */
+    uint32_t getActiveCount(void) const { return mActive; }
+
+#ifdef ESP_PLATFORM
+    /**
+     * @brief Creates the esp_timer of the wheel and sets the EVENT_TIMER handler, the EventLoop has to be initialized.
+     * @note Calling the method more than once will throw std::runtime_error.
+     */
+    void init(void);
+#endif
+  };
+} // namespace pedometer
+
+#endif // TIMER_WHEEL_H
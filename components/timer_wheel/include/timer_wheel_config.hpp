@@ -0,0 +1,14 @@
+#ifndef TIMER_WHEEL_CONFIG_H
+#define TIMER_WHEEL_CONFIG_H
+
+#include <cstdint>
+
+namespace pedometer {
+  // Wheel geometry: TIMER_WHEEL_LEVELS levels of 2^TIMER_WHEEL_SLOT_BITS slots, the first level has one slot per tick
+  enum : uint32_t { TIMER_WHEEL_TICK_US = 1000, TIMER_WHEEL_SLOT_BITS = 6, TIMER_WHEEL_LEVELS = 5 };
+
+  // Deadline of an empty wheel
+  enum : uint64_t { TIMER_WHEEL_NO_DEADLINE = UINT64_MAX };
+} // namespace pedometer
+
+#endif // TIMER_WHEEL_CONFIG_H
@@ -0,0 +1,208 @@
+#include "timer_wheel.hpp"
+#include "timer_wheel_config.hpp"
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#include "event_loop.hpp"
+#endif
+#include <cstdint>
+#include <stdexcept>
+
+using namespace pedometer;
+
+// Mask of the digit of one level
+static constexpr uint64_t SLOT_MASK = TIMER_WHEEL_SLOTS - 1;
+
+// Rotations of the slot bitmaps of one level
+static uint64_t rotateRight(uint64_t bits, uint32_t shift) {
+  shift &= SLOT_MASK;
+  return (0 == shift) ? bits : (bits >> shift) | (bits << (TIMER_WHEEL_SLOTS - shift));
+}
+
+static uint64_t rotateLeft(uint64_t bits, uint32_t shift) { return rotateRight(bits, TIMER_WHEEL_SLOTS - (shift & SLOT_MASK)); }
+
+void TimerWheel::link(ScheduledTimer **list, ScheduledTimer &timer) {
+  timer.mPrev = nullptr;
+  timer.mNext = *list;
+  if(nullptr != *list) {
+    (*list)->mPrev = &timer;
+  }
+  *list = &timer;
+  timer.mList = list;
+}
+
+void TimerWheel::unlink(ScheduledTimer &timer) {
+  if(nullptr != timer.mPrev) {
+    timer.mPrev->mNext = timer.mNext;
+  } else {
+    *timer.mList = timer.mNext;
+  }
+  if(nullptr != timer.mNext) {
+    timer.mNext->mPrev = timer.mPrev;
+  }
+  // Empty slot is removed from the bitmap of its level
+  if(nullptr == *timer.mList && timer.mList >= mSlots.data() && timer.mList < mSlots.data() + mSlots.size()) {
+    size_t index = timer.mList - mSlots.data();
+    mOccupied[index / TIMER_WHEEL_SLOTS] &= ~(1ULL << (index % TIMER_WHEEL_SLOTS));
+  }
+  timer.mPrev = timer.mNext = nullptr;
+  timer.mList = nullptr;
+}
+
+void TimerWheel::insert(ScheduledTimer &timer) {
+  if(timer.mExpiryTick <= mCurrentTick) {
+    link(&mExpired, timer);
+    return;
+  }
+  // Level of the highest digit in which the expiry differs from the current tick
+  uint32_t level = (63 - __builtin_clzll(timer.mExpiryTick ^ mCurrentTick)) / TIMER_WHEEL_SLOT_BITS;
+  level = (level < TIMER_WHEEL_LEVELS) ? level : TIMER_WHEEL_LEVELS - 1;
+  uint32_t slot = (timer.mExpiryTick >> (level * TIMER_WHEEL_SLOT_BITS)) & SLOT_MASK;
+  link(&mSlots[level * TIMER_WHEEL_SLOTS + slot], timer);
+  mOccupied[level] |= 1ULL << slot;
+}
+
+void TimerWheel::start(ScheduledTimer &timer, uint64_t nowUs, uint64_t delayUs, uint64_t periodUs) {
+  // Ticks of an empty wheel start from the current time
+  if(0 == mActive) {
+    mCurrentTick = nowUs / TIMER_WHEEL_TICK_US;
+  }
+  uint64_t expiryTick = (nowUs + delayUs + TIMER_WHEEL_TICK_US - 1) / TIMER_WHEEL_TICK_US;
+  if(expiryTick > mCurrentTick + TIMER_WHEEL_MAX_TICKS) {
+    throw std::out_of_range("Timer delay is out of the wheel range.");
+  }
+  cancel(timer);
+  timer.mExpiryTick = expiryTick;
+  timer.mPeriodTicks = (periodUs + TIMER_WHEEL_TICK_US - 1) / TIMER_WHEEL_TICK_US;
+  insert(timer);
+  mActive++;
+  rearm(nowUs);
+}
+
+void TimerWheel::cancel(ScheduledTimer &timer) {
+  if(timer.isActive()) {
+    unlink(timer);
+    mActive--;
+  }
+}
+
+uint32_t TimerWheel::advance(uint64_t nowUs) {
+  uint64_t nowTick = nowUs / TIMER_WHEEL_TICK_US;
+  if(nowTick > mCurrentTick) {
+    // Slots of every level whose time has come between the current and the new tick are moved to a pending list
+    ScheduledTimer *pending = nullptr;
+    for(uint32_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+      uint32_t shift = level * TIMER_WHEEL_SLOT_BITS;
+      uint64_t elapsed = (nowTick >> shift) - (mCurrentTick >> shift);
+      if(0 == elapsed) {
+        break;
+      }
+      // Slots after the current digit up to the new digit, all slots after a whole turn
+      uint64_t due = mOccupied[level];
+      if(elapsed < TIMER_WHEEL_SLOTS) {
+        due &= rotateLeft((1ULL << elapsed) - 1, (mCurrentTick >> shift) + 1);
+      }
+      while(0 != due) {
+        uint32_t slot = __builtin_ctzll(due);
+        due &= due - 1;
+        while(nullptr != mSlots[level * TIMER_WHEEL_SLOTS + slot]) {
+          ScheduledTimer &timer = *mSlots[level * TIMER_WHEEL_SLOTS + slot];
+          unlink(timer);
+          link(&pending, timer);
+        }
+      }
+    }
+    // Pending timers expire or move down to a lower level
+    mCurrentTick = nowTick;
+    while(nullptr != pending) {
+      ScheduledTimer &timer = *pending;
+      unlink(timer);
+      insert(timer);
+    }
+  }
+
+  // Callbacks of the timers expired so far are called, timers expired meanwhile wait for the next advance
+  ScheduledTimer *expired = mExpired;
+  mExpired = nullptr;
+  if(nullptr != expired) {
+    expired->mPrev = nullptr;
+    for(ScheduledTimer *timer = expired; nullptr != timer; timer = timer->mNext) {
+      timer->mList = &mFiring;
+    }
+    mFiring = expired;
+  }
+  uint32_t fired = 0;
+  while(nullptr != mFiring) {
+    ScheduledTimer &timer = *mFiring;
+    unlink(timer);
+    mActive--;
+    if(0 != timer.mPeriodTicks) {
+      // Next period is scheduled before the callback, so the callback may cancel it
+      timer.mExpiryTick += timer.mPeriodTicks;
+      if(timer.mExpiryTick <= mCurrentTick) {
+        timer.mExpiryTick = mCurrentTick + timer.mPeriodTicks;
+      }
+      insert(timer);
+      mActive++;
+    }
+    timer.mCallback(timer.mContext);
+    fired++;
+  }
+  rearm(nowUs);
+  return fired;
+}
+
+uint64_t TimerWheel::getNextDeadlineUs(void) const {
+  if(nullptr != mExpired) {
+    return mCurrentTick * TIMER_WHEEL_TICK_US;
+  }
+  uint64_t deadlineTick = TIMER_WHEEL_NO_DEADLINE;
+  for(uint32_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    if(0 == mOccupied[level]) {
+      continue;
+    }
+    // Start of the first occupied slot after the current digit
+    uint32_t shift = level * TIMER_WHEEL_SLOT_BITS;
+    uint64_t offset = __builtin_ctzll(rotateRight(mOccupied[level], (mCurrentTick >> shift) + 1)) + 1;
+    uint64_t slotTick = ((mCurrentTick >> shift) + offset) << shift;
+    deadlineTick = (slotTick < deadlineTick) ? slotTick : deadlineTick;
+  }
+  return (TIMER_WHEEL_NO_DEADLINE == deadlineTick) ? TIMER_WHEEL_NO_DEADLINE : deadlineTick * TIMER_WHEEL_TICK_US;
+}
+
+#ifdef ESP_PLATFORM
+void TimerWheel::onDeadline(void *args) { EventLoop::GetInstance().post(EVENT_TIMER); }
+
+void TimerWheel::onTimerEvent(void *context) {
+  TimerWheel &timerWheel = *static_cast<TimerWheel *>(context);
+  // One-shot esp_timer has expired, it is armed again by advance()
+  timerWheel.mArmedUs = TIMER_WHEEL_NO_DEADLINE;
+  timerWheel.advance(esp_timer_get_time());
+}
+
+void TimerWheel::init(void) {
+  if(nullptr != mTimer) {
+    throw std::runtime_error("TimerWheel instance is already initialized.");
+  }
+  const esp_timer_create_args_t timerArgs = {.callback = &TimerWheel::onDeadline,
+                                             .arg = this,
+                                             .dispatch_method = ESP_TIMER_TASK,
+                                             .name = "timer_wheel",
+                                             .skip_unhandled_events = true};
+  ESP_ERROR_CHECK(esp_timer_create(&timerArgs, &mTimer));
+  EventLoop::GetInstance().setHandler(EVENT_TIMER, &TimerWheel::onTimerEvent, this);
+}
+
+void TimerWheel::rearm(uint64_t nowUs) {
+  uint64_t deadlineUs = getNextDeadlineUs();
+  if(nullptr == mTimer || deadlineUs == mArmedUs) {
+    return;
+  }
+  esp_timer_stop(mTimer);
+  if(TIMER_WHEEL_NO_DEADLINE != deadlineUs) {
+    esp_timer_start_once(mTimer, (deadlineUs > nowUs) ? deadlineUs - nowUs : 0);
+  }
+  mArmedUs = deadlineUs;
+}
+#else
+void TimerWheel::rearm(uint64_t nowUs) { (void)nowUs; }
+#endif
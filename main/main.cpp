@@ -1,30 +1,83 @@
+#include "adxl345.h"
 #include "board_config.h"
 #include "clock_counter.hpp"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_mac.h"
+#include "event_loop.hpp"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "heap_guard.hpp"
 #include "menu.hpp"
 #include "oled_sh1106.h"
 #include "sdkconfig.h"
+#include "step_counter.hpp"
 #include "system_data.hpp"
-#include <atomic>
+#include "timer_wheel.hpp"
+#include <cinttypes>
 #include <stdio.h>
 
 using namespace pedometer;
 
-enum : uint64_t { TIMER_IRQ_PERIOD = 10000 };
+enum : uint64_t { STATS_REPORT_PERIOD_US = 60 * 1000000ULL };
+
+static const char *TAG = "main";
+
+// Statically allocated RAM of the components against their budgets in bytes, checked at compile time
+static constexpr RamBudget RAM_BUDGET[] = {
+    {"system_data", sizeof(SystemData), 256},
+    {"clock_counter", sizeof(ClockCounter), 64},
+    {"event_loop", sizeof(EventLoop), 256},
+    {"timer_wheel", sizeof(TimerWheel), 3072},
+    {"menu", sizeof(Menu), 256},
+    {"adxl345", ADXL345_FIFO_SIZE * sizeof(adxl345_sample_t), 256},
+    {"step_counter", sizeof(StepCounter), 128},
+    {"oled_sh1106", 2 * OLED_NUM_PAGES * OLED_WIDTH + OLED_RENDER_TASK_STACK + OLED_ASYNC_TRANS_NUM * sizeof(spi_transaction_t), 6144},
+};
+static_assert(isWithinBudget(RAM_BUDGET), "A component exceeds its RAM budget.");
 
 // Static variables for SPI and system parameters
 static spi_device_handle_t spi;
 static ext_spi_handle_t ext_spi;
 
-// Interrupt flags
-std::atomic<bool> tickCountFlag = false;
+// Accelerometer, samples are read from its FIFO in batches
+static i2c_master_bus_handle_t i2c_bus;
+static adxl345_handle_t accel;
+static adxl345_sample_t accel_samples[ADXL345_FIFO_SIZE];
 
 // Callbacks
-static void clock_counter_callback(void *args) { tickCountFlag.store(true); }
+static void request_redraw(void) { EventLoop::GetInstance().post(EVENT_DISPLAY); }
+
+static void frame_done(void *arg) {
+  // Called from the SPI interrupt, a frame refused while this one was sent is published by the next Menu::update()
+  if(Menu::GetInstance().isFramePending()) {
+    request_redraw();
+  }
+}
+
+static void accel_watermark(void *arg) { EventLoop::GetInstance().post(EVENT_ACCEL); }
+
+static void read_accel(void *args) {
+  // One batch per watermark interrupt, the FIFO is drained below the watermark which releases the interrupt line
+  size_t count = adxl345_read_fifo(accel, accel_samples, ADXL345_FIFO_SIZE);
+  StepCounter::GetInstance().process(accel_samples, count);
+}
+
+static void report_stats(void *args) {
+  const EventLoopStats &stats = EventLoop::GetInstance().getStats();
+  ESP_LOGI(TAG, "idle %" PRIu32 "%%, events %" PRIu32 ", latency avg %" PRIu32 " us max %" PRIu32 " us", stats.idlePercent(), stats.events,
+           (0 == stats.events) ? 0 : static_cast<uint32_t>(stats.latencyUs / stats.events), stats.maxLatencyUs);
+  const StepCounterStats &steps = StepCounter::GetInstance().getStats();
+  ESP_LOGI(TAG, "step detector %" PRIu32 " cycles/sample (budget %" PRIu32 "), longest batch %" PRIu32 " cycles", steps.cyclesPerSample(),
+           static_cast<uint32_t>(STEP_CYCLES_PER_SAMPLE_BUDGET), steps.maxBatchCycles);
+#ifdef CONFIG_PEDOMETER_STATIC_ALLOCATION
+  ESP_LOGI(TAG, "heap allocations after init %" PRIu32, HeapGuard::GetInstance().getViolations());
+#endif
+}
+
+// Scheduled timers
+static ScheduledTimer stats_report(&report_stats);
 
 extern "C" void app_main(void) {
 
@@ -34,7 +87,7 @@ extern "C" void app_main(void) {
   /* Configure OLED and related SPI */
   esp_err_t ret;
 
-  spi_bus_config_t buscfg;
+  spi_bus_config_t buscfg = {};
   buscfg.miso_io_num = SPI_PIN_MISO;
   buscfg.mosi_io_num = SPI_PIN_MOSI;
   buscfg.sclk_io_num = SPI_PIN_CLK;
@@ -45,13 +98,15 @@ extern "C" void app_main(void) {
   buscfg.data6_io_num = -1;
   buscfg.data7_io_num = -1;
   buscfg.data_io_default_level = 0;
-  ;
+  buscfg.max_transfer_sz = OLED_UNIT_BUF_LEN; // Single page of the video buffer per transaction
 
-  spi_device_interface_config_t devcfg;
+  spi_device_interface_config_t devcfg = {};
   devcfg.clock_speed_hz = SPI_CLOCK_HZ;
   devcfg.mode = 0;
   devcfg.spics_io_num = SPI_PIN_CS;
-  devcfg.queue_size = 7;
+  devcfg.queue_size = OLED_ASYNC_TRANS_NUM;
+  devcfg.pre_cb = oled_spi_pre_transfer_cb;
+  devcfg.post_cb = oled_spi_post_transfer_cb;
 
   // Initialize the SPI bus
   ret = spi_bus_initialize(SPI_CH_HOST, &buscfg, SPI_DMA_CH_AUTO);
@@ -73,33 +128,76 @@ extern "C" void app_main(void) {
   ext_spi.dc = SPI_PIN_DC;
   ext_spi.res = SPI_PIN_RST;
 
-  // Timer initialization
-  const esp_timer_create_args_t clock_counter_args = {.callback = &clock_counter_callback, .name = "system_clock"};
-
-  esp_timer_handle_t clock_counter;
-  ESP_ERROR_CHECK(esp_timer_create(&clock_counter_args, &clock_counter));
+  // Event loop of the main task, events are posted by timers, interrupts and other tasks
+  EventLoop &eventLoop = EventLoop::GetInstance();
+  eventLoop.init();
+
+  /* Configure ADXL345 and related I2C */
+  i2c_master_bus_config_t i2c_buscfg = {};
+  i2c_buscfg.i2c_port = I2C_CH_PORT;
+  i2c_buscfg.sda_io_num = I2C_PIN_SDA;
+  i2c_buscfg.scl_io_num = I2C_PIN_SCL;
+  i2c_buscfg.clk_source = I2C_CLK_SRC_DEFAULT;
+  i2c_buscfg.glitch_ignore_cnt = 7;
+  i2c_buscfg.flags.enable_internal_pullup = true;
+
+  i2c_device_config_t accelcfg = {};
+  accelcfg.dev_addr_length = I2C_ADDR_BIT_LEN_7;
+  accelcfg.device_address = ADXL345_I2C_ADDR;
+  accelcfg.scl_speed_hz = ADXL345_I2C_CLOCK_HZ;
+
+  ret = i2c_new_master_bus(&i2c_buscfg, &i2c_bus);
+  ESP_ERROR_CHECK(ret);
+  ret = i2c_master_bus_add_device(i2c_bus, &accelcfg, &accel.i2c);
+  ESP_ERROR_CHECK(ret);
+  accel.int1 = ACCEL_PIN_INT1;
+
+  // The sensor streams into its FIFO, the main task wakes once per watermark instead of once per sample
+  eventLoop.setHandler(EVENT_ACCEL, &read_accel);
+  if(adxl345_init(accel, ADXL345_WATERMARK)) {
+    adxl345_int_start(accel, &accel_watermark, nullptr);
+  } else {
+    ESP_LOGE(TAG, "ADXL345 not found");
+  }
 
-  // Start the timers
-  ESP_ERROR_CHECK(esp_timer_start_periodic(clock_counter, TIMER_IRQ_PERIOD));
+  // Scheduler of deferred and periodic work, driven by one esp_timer armed for the next deadline
+  TimerWheel::GetInstance().init();
+  TimerWheel::GetInstance().start(stats_report, esp_timer_get_time(), STATS_REPORT_PERIOD_US, STATS_REPORT_PERIOD_US);
 
   // SystemData initialization
-  SystemData::GetInstance()->init();
+  SystemData::GetInstance().init();
 
-  // ClockCounter initialization
-  ClockCounter::GetInstance()->init();
+  // StepCounter initialization, steps of the accelerometer batches are added to DATA_STEPS
+  StepCounter::GetInstance().init();
 
-  // OLED initialization
+  // ClockCounter initialization, the clock publishes the time at second boundaries from its own timer
+  ClockCounter::getInstance().init(esp_timer_get_time());
+
+  // OLED initialization, afterwards frames are sent by the render task and the main task never waits for the SPI bus
   oled_init(ext_spi);
+  oled_async_start(ext_spi, &frame_done, nullptr);
 
   // Menu instance initialization
-  Menu::GetInstance().init(ext_spi);
+  Menu::GetInstance().init();
+  Menu::GetInstance().setRedrawRequest(&request_redraw);
+
+#ifdef CONFIG_PEDOMETER_STATIC_ALLOCATION
+  // Static allocation mode, every heap allocation from now on is trapped by the heap guard
+  HeapGuard::report(RAM_BUDGET);
+#ifdef CONFIG_PEDOMETER_HEAP_GUARD_ABORT
+  HeapGuard::GetInstance().arm(true);
+#else
+  HeapGuard::GetInstance().arm(false);
+#endif
+#endif
 
   // ########################## INITIALIZATION ENDS ##########################
 
   while(1) {
-    if(tickCountFlag) {
-      tickCountFlag.store(false);
-      ClockCounter::GetInstance()->processTick();
-    }
+    // The task sleeps until an event comes or until the frame scheduler can draw pending changes
+    eventLoop.dispatch(Menu::GetInstance().getFrameDelayUs(esp_timer_get_time()));
+
+    // Widgets bound to changed data fields are redrawn at a capped frame rate
+    Menu::GetInstance().update(esp_timer_get_time());
   }
 }
@@ -0,0 +1,187 @@
+#include "gait_generator.hpp"
+#include "trace_file.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace pedometer;
+
+// Samples generated between two resynchronizations of the oscillators with the phases, float rotations drift slowly
+enum : size_t { GAIT_BLOCK = 4096 };
+static constexpr float LSB_PER_G = 256.0f;
+static constexpr double TWO_PI = 6.283185307179586;
+static constexpr double BOUNCE_HZ = 1.5;
+static constexpr double SECONDS_PER_DAY = 24 * 3600;
+
+// Sine and cosine of a phase advanced by a rotation every sample
+struct Oscillator {
+  float c;
+  float s;
+  float dc;
+  float ds;
+
+  Oscillator(double phase, double increment)
+      : c(static_cast<float>(std::cos(TWO_PI * phase))), s(static_cast<float>(std::sin(TWO_PI * phase))),
+        dc(static_cast<float>(std::cos(TWO_PI * increment))), ds(static_cast<float>(std::sin(TWO_PI * increment))) {}
+
+  void advance(void) {
+    float next = c * dc - s * ds;
+    s = s * dc + c * ds;
+    c = next;
+  }
+};
+
+// Advances the phase by the samples, returns the number of completed periods
+static uint32_t advancePhase(double &phase, double increment, size_t count) {
+  double end = phase + increment * count;
+  double periods = std::floor(end);
+  phase = end - periods;
+  return static_cast<uint32_t>(periods);
+}
+
+static int16_t toSample(float value) { return static_cast<int16_t>(std::lrint(std::min(32767.0f, std::max(-32768.0f, value)))); }
+
+GaitGenerator::GaitGenerator(const GaitParams &params) : mParams(params), mRandom(params.seed | 1) {
+  if(0 == params.sampleRateHz || params.noiseG < 0) {
+    throw std::invalid_argument("Invalid gait generator parameters.");
+  }
+  // Device orientation: roll around x after pitch around y
+  double pitch = params.pitchDeg * TWO_PI / 360;
+  double roll = params.rollDeg * TWO_PI / 360;
+  double cp = std::cos(pitch), sp = std::sin(pitch), cr = std::cos(roll), sr = std::sin(roll);
+  const double rotation[3][3] = {{cp, 0, sp}, {sr * sp, cr, -sr * cp}, {-cr * sp, sr, cr * cp}};
+  for(int row = 0; row < 3; row++) {
+    for(int col = 0; col < 3; col++) {
+      mRotation[row][col] = static_cast<float>(rotation[row][col]);
+    }
+  }
+}
+
+float GaitGenerator::uniform(void) {
+  mRandom ^= mRandom << 13;
+  mRandom ^= mRandom >> 17;
+  mRandom ^= mRandom << 5;
+  return static_cast<float>(mRandom >> 8) * (1.0f / 16777216.0f);
+}
+
+uint32_t GaitGenerator::generate(const GaitSegment &segment, TraceSample *samples, size_t count) {
+  const double rate = mParams.sampleRateHz;
+  const bool isWalking = SEGMENT_WALK == segment.kind;
+  const bool isDriving = SEGMENT_VEHICLE == segment.kind;
+  const float step = isWalking ? static_cast<float>(segment.amplitudeG) * LSB_PER_G : 0.0f;
+  const float arm = isWalking ? static_cast<float>(segment.armSwingG) * LSB_PER_G : 0.0f;
+  const float vibration = isDriving ? static_cast<float>(segment.vibrationG) * LSB_PER_G : 0.0f;
+  // Sum of four uniform numbers has the variance 1/3
+  const float noise = static_cast<float>(mParams.noiseG) * LSB_PER_G * std::sqrt(3.0f);
+  const double stepIncrement = isWalking ? segment.cadenceHz / rate : 0.0;
+  const double armIncrement = stepIncrement / 2;
+  const double vibrationIncrement = isDriving ? segment.vibrationHz / rate : 0.0;
+  const double bounceIncrement = isDriving ? BOUNCE_HZ / rate : 0.0;
+  const float(&r)[3][3] = mRotation;
+
+  uint32_t steps = 0;
+  for(size_t first = 0; first < count; first += GAIT_BLOCK) {
+    size_t blockCount = std::min<size_t>(GAIT_BLOCK, count - first);
+    Oscillator stepOsc(mStepPhase, stepIncrement);
+    Oscillator armOsc(mArmPhase, armIncrement);
+    Oscillator vibrationOsc(mVibrationPhase, vibrationIncrement);
+    Oscillator bounceOsc(mBouncePhase, bounceIncrement);
+    for(size_t i = first; i < first + blockCount; i++) {
+      // Body frame: x sideways, y forward, z up; the second harmonic of the step is sin(2a) = 2 sin(a) cos(a)
+      float vertical = step * (stepOsc.s + 0.4f * stepOsc.s * stepOsc.c) + vibration * (vibrationOsc.s + bounceOsc.s);
+      float x = arm * armOsc.s;
+      float y = 0.5f * arm * armOsc.c;
+      float z = LSB_PER_G + vertical;
+      samples[i].x = toSample(r[0][0] * x + r[0][1] * y + r[0][2] * z + noise * (uniform() + uniform() + uniform() + uniform() - 2.0f));
+      samples[i].y = toSample(r[1][0] * x + r[1][1] * y + r[1][2] * z + noise * (uniform() + uniform() + uniform() + uniform() - 2.0f));
+      samples[i].z = toSample(r[2][0] * x + r[2][1] * y + r[2][2] * z + noise * (uniform() + uniform() + uniform() + uniform() - 2.0f));
+      stepOsc.advance();
+      armOsc.advance();
+      vibrationOsc.advance();
+      bounceOsc.advance();
+    }
+    // One step per period of the step swing
+    steps += advancePhase(mStepPhase, stepIncrement, blockCount);
+    advancePhase(mArmPhase, armIncrement, blockCount);
+    advancePhase(mVibrationPhase, vibrationIncrement, blockCount);
+    advancePhase(mBouncePhase, bounceIncrement, blockCount);
+  }
+  return steps;
+}
+
+uint64_t GaitGenerator::write(TraceWriter &writer, const std::vector<GaitSegment> &segments) {
+  std::vector<TraceSample> block(GAIT_BLOCK);
+  uint64_t samples = 0;
+  for(const GaitSegment &segment : segments) {
+    uint64_t remaining = segmentSamples(segment, mParams.sampleRateHz);
+    while(0 != remaining) {
+      size_t count = static_cast<size_t>(std::min<uint64_t>(GAIT_BLOCK, remaining));
+      uint32_t steps = generate(segment, block.data(), count);
+      writer.append(block.data(), count, steps);
+      remaining -= count;
+      samples += count;
+    }
+  }
+  return samples;
+}
+
+uint64_t pedometer::segmentSamples(const GaitSegment &segment, uint16_t sampleRateHz) {
+  return static_cast<uint64_t>(std::llround(std::max(0.0, segment.seconds) * sampleRateHz));
+}
+
+std::vector<GaitSegment> pedometer::simulatedDays(uint32_t days, uint32_t seed) {
+  std::mt19937 random(seed);
+  auto between = [&random](double min, double max) { return std::uniform_real_distribution<double>(min, max)(random); };
+  // Whole seconds, so the days have exactly 24 h of samples at any rate
+  auto wholeSeconds = [&between](double min, double max) { return std::round(between(min, max)); };
+  auto idle = [](double seconds) {
+    GaitSegment segment;
+    segment.seconds = seconds;
+    return segment;
+  };
+  auto walk = [&between](double seconds, double minCadenceHz, double maxCadenceHz) {
+    GaitSegment segment;
+    segment.kind = SEGMENT_WALK;
+    segment.seconds = seconds;
+    segment.cadenceHz = between(minCadenceHz, maxCadenceHz);
+    segment.amplitudeG = between(0.18, 0.35) * segment.cadenceHz / 1.8;
+    segment.armSwingG = between(0.05, 0.15);
+    return segment;
+  };
+  auto drive = [&between](double seconds) {
+    GaitSegment segment;
+    segment.kind = SEGMENT_VEHICLE;
+    segment.seconds = seconds;
+    segment.vibrationHz = between(8, 20);
+    segment.vibrationG = between(0.01, 0.04);
+    return segment;
+  };
+
+  std::vector<GaitSegment> segments;
+  for(uint32_t day = 0; day < days; day++) {
+    std::vector<GaitSegment> schedule = {
+        idle(wholeSeconds(6.5 * 3600, 8.5 * 3600)), // Sleep
+        walk(wholeSeconds(5 * 60, 15 * 60), 1.6, 2.0),
+        drive(wholeSeconds(20 * 60, 40 * 60)),      // Commute
+        walk(wholeSeconds(3 * 60, 8 * 60), 1.7, 2.1),
+        idle(wholeSeconds(3.5 * 3600, 4.5 * 3600)), // Desk work
+        walk(wholeSeconds(10 * 60, 20 * 60), 1.6, 2.0),
+        idle(wholeSeconds(3 * 3600, 4 * 3600)),
+        walk(wholeSeconds(3 * 60, 8 * 60), 1.7, 2.1),
+        drive(wholeSeconds(20 * 60, 40 * 60)),
+        walk(wholeSeconds(15 * 60, 45 * 60), 2.0, 2.6), // Brisk evening walk
+    };
+    // The evening at home fills the rest of the day
+    double daySeconds = 0;
+    for(const GaitSegment &segment : schedule) {
+      daySeconds += segment.seconds;
+    }
+    schedule.push_back(idle(SECONDS_PER_DAY - daySeconds));
+    segments.insert(segments.end(), schedule.begin(), schedule.end());
+  }
+  return segments;
+}
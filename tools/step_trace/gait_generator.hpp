@@ -0,0 +1,98 @@
+#ifndef GAIT_GENERATOR_H
+#define GAIT_GENERATOR_H
+
+#include "trace_file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pedometer {
+
+  // Activity of a segment of a synthetic trace, only walking has steps
+  enum SegmentKind : uint8_t { SEGMENT_IDLE, SEGMENT_WALK, SEGMENT_VEHICLE };
+
+  /**
+   * @brief Segment of a synthetic trace, accelerations are in g.
+   */
+  struct GaitSegment {
+    SegmentKind kind = SEGMENT_IDLE;
+    double seconds = 0;
+    double cadenceHz = 1.8;   // Steps per second of walking
+    double amplitudeG = 0.25; // Vertical swing of one step
+    double armSwingG = 0.1;   // Sideways swing of the arm, one period per two steps
+    double vibrationHz = 12;  // Vibration of a vehicle, a slow bounce at 1.5 Hz comes with it
+    double vibrationG = 0.03;
+  };
+
+  /**
+   * @brief Parameters of the generator shared by all segments.
+   */
+  struct GaitParams {
+    uint16_t sampleRateHz = TRACE_DEFAULT_RATE_HZ;
+    double noiseG = 0.02; // Standard deviation of the sensor noise on every axis
+    double pitchDeg = 0;  // Orientation of the device against the body
+    double rollDeg = 0;
+    uint32_t seed = 1;
+  };
+
+  /**
+   * @brief Class that generates synthetic accelerometer samples with labelled steps.
+   *
+   * The body frame signal (gravity, step swing with its second harmonic, arm swing, vehicle vibration) is rotated by
+   * the device orientation and noise is added, samples are in 256 LSB/g like the ADXL345 FIFO. Oscillators run as
+   * rotations, so the inner loop has no trigonometric calls. A step is labelled on every period of the step swing.
+   * Segments continue in phase, the same parameters and segments always give the same trace.
+   */
+  class GaitGenerator {
+  private:
+    GaitParams mParams;
+    float mRotation[3][3];
+    uint32_t mRandom;
+    double mStepPhase = 0; // Phases in periods -> 0 - 1
+    double mArmPhase = 0;
+    double mVibrationPhase = 0;
+    double mBouncePhase = 0;
+
+    // Uniform random number -> 0 - 1, xorshift32
+    float uniform(void);
+
+  public:
+    /**
+     * @brief Creates the generator.
+     * @note Throws std::invalid_argument if the sample rate is 0 or the noise is negative.
+     */
+    explicit GaitGenerator(const GaitParams &params = GaitParams());
+
+    /**
+     * @brief Generates the next samples of the segment.
+     * @param segment activity of the samples
+     * @param samples destination
+     * @param count number of samples
+     * @return number of steps labelled in the samples
+     */
+    uint32_t generate(const GaitSegment &segment, TraceSample *samples, size_t count);
+
+    /**
+     * @brief Generates all segments into the trace in blocks, returns the number of samples.
+     * @note Throws std::runtime_error if the write fails.
+     */
+    uint64_t write(TraceWriter &writer, const std::vector<GaitSegment> &segments);
+
+    /**
+     * @brief Returns the parameters of the generator.
+     */
+    const GaitParams &getParams(void) const { return mParams; }
+  };
+
+  /**
+   * @brief Returns the segments of simulated days: sleep, walks, commutes in a vehicle and desk work, 24 h per day.
+   */
+  std::vector<GaitSegment> simulatedDays(uint32_t days, uint32_t seed);
+
+  /**
+   * @brief Returns the number of samples of the segment at the sample rate.
+   */
+  uint64_t segmentSamples(const GaitSegment &segment, uint16_t sampleRateHz);
+} // namespace pedometer
+
+#endif // GAIT_GENERATOR_H
@@ -0,0 +1,84 @@
+#include "gait_generator.hpp"
+#include "trace_file.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace pedometer;
+
+// Writes a synthetic trace with known steps: simulated days of sleep, walks, commutes and desk work, or a single walk.
+// The output is the binary trace format of step_replay and step_tuner.
+
+static void usage(void) {
+  std::printf("usage: gait_generator (--days <days> | --walk <seconds> [--cadence <hz>]) [--seed <seed>] [--rate <hz>] [--noise <g>]\n"
+              "                      [--pitch <deg>] [--roll <deg>] <output.trc>\n"
+              "step_replay and step_tuner accept only traces at the accelerometer rate, the default.\n");
+}
+
+int main(int argc, char **argv) {
+  uint32_t days = 0;
+  double walkSeconds = 0;
+  double cadenceHz = GaitSegment().cadenceHz;
+  GaitParams params;
+  std::string path;
+  for(int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if("--days" == arg && i + 1 < argc) {
+      days = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if("--walk" == arg && i + 1 < argc) {
+      walkSeconds = std::strtod(argv[++i], nullptr);
+    } else if("--cadence" == arg && i + 1 < argc) {
+      cadenceHz = std::strtod(argv[++i], nullptr);
+    } else if("--seed" == arg && i + 1 < argc) {
+      params.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if("--rate" == arg && i + 1 < argc) {
+      params.sampleRateHz = static_cast<uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if("--noise" == arg && i + 1 < argc) {
+      params.noiseG = std::strtod(argv[++i], nullptr);
+    } else if("--pitch" == arg && i + 1 < argc) {
+      params.pitchDeg = std::strtod(argv[++i], nullptr);
+    } else if("--roll" == arg && i + 1 < argc) {
+      params.rollDeg = std::strtod(argv[++i], nullptr);
+    } else if('-' == arg[0] || !path.empty()) {
+      usage();
+      return EXIT_FAILURE;
+    } else {
+      path = arg;
+    }
+  }
+  if(path.empty() || ((0 == days) == (0 >= walkSeconds))) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  std::vector<GaitSegment> segments;
+  if(0 != days) {
+    segments = simulatedDays(days, params.seed);
+  } else {
+    GaitSegment walk;
+    walk.kind = SEGMENT_WALK;
+    walk.seconds = walkSeconds;
+    walk.cadenceHz = cadenceHz;
+    segments.push_back(walk);
+  }
+
+  try {
+    GaitGenerator generator(params);
+    TraceWriter writer(path, params.sampleRateHz);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t samples = generator.write(writer, segments);
+    writer.close();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    TraceFile trace(path);
+    std::printf("%s: %zu segments, %llu samples, %u steps in %.2f s, %.1f Msamples/s\n", path.c_str(), segments.size(),
+                static_cast<unsigned long long>(samples), trace.view().groundTruthSteps, seconds, samples / seconds / 1e6);
+  } catch(const std::exception &error) {
+    std::fprintf(stderr, "%s\n", error.what());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+#include "gait_generator.hpp"
+#include "replay.hpp"
+#include "trace_file.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace pedometer;
+
+static GaitSegment segment(SegmentKind kind, double seconds) {
+  GaitSegment segment;
+  segment.kind = kind;
+  segment.seconds = seconds;
+  return segment;
+}
+
+static TraceData generateTrace(const GaitParams &params, const std::vector<GaitSegment> &segments) {
+  GaitGenerator generator(params);
+  TraceData trace;
+  trace.sampleRateHz = params.sampleRateHz;
+  for(const GaitSegment &segment : segments) {
+    size_t first = trace.samples.size();
+    trace.samples.resize(first + segmentSamples(segment, params.sampleRateHz));
+    trace.groundTruthSteps += generator.generate(segment, trace.samples.data() + first, trace.samples.size() - first);
+  }
+  return trace;
+}
+
+// -------------------------------------------------------------------------------
+// ------------------------ GaitGenerator class unit test ------------------------
+// -------------------------------------------------------------------------------
+TEST(GaitGeneratorTest, InvalidParamsTest) {
+  GaitParams params;
+  params.sampleRateHz = 0;
+  EXPECT_THROW(GaitGenerator generator(params), std::invalid_argument);
+  params = GaitParams();
+  params.noiseG = -1;
+  EXPECT_THROW(GaitGenerator generator(params), std::invalid_argument);
+}
+
+TEST(GaitGeneratorTest, LabelledStepsTest) {
+  // One step per period of the cadence, also when the walk is split into calls of any size
+  GaitSegment walk = segment(SEGMENT_WALK, 100);
+  walk.cadenceHz = 1.7;
+  EXPECT_EQ(generateTrace(GaitParams(), {walk}).groundTruthSteps, 170u);
+
+  GaitGenerator generator;
+  std::vector<TraceSample> samples(10000);
+  uint32_t steps = 0;
+  for(size_t first = 0; first < samples.size(); first += 333) {
+    steps += generator.generate(walk, samples.data() + first, std::min<size_t>(333, samples.size() - first));
+  }
+  EXPECT_EQ(steps, 170u);
+
+  EXPECT_EQ(generateTrace(GaitParams(), {segment(SEGMENT_IDLE, 60), segment(SEGMENT_VEHICLE, 60)}).groundTruthSteps, 0u);
+}
+
+TEST(GaitGeneratorTest, OrientationTest) {
+  // At rest the magnitude is 1 g in any orientation
+  for(double pitch : {0.0, 30.0, 90.0, -120.0}) {
+    for(double roll : {0.0, 45.0, 180.0}) {
+      GaitParams params;
+      params.pitchDeg = pitch;
+      params.rollDeg = roll;
+      params.noiseG = 0;
+      TraceData trace = generateTrace(params, {segment(SEGMENT_IDLE, 1)});
+      for(const TraceSample &sample : trace.samples) {
+        double magnitude = std::sqrt(sample.x * sample.x + sample.y * sample.y + sample.z * sample.z);
+        EXPECT_NEAR(magnitude, 256, 2) << pitch << " " << roll;
+      }
+    }
+  }
+  GaitParams params;
+  params.noiseG = 0;
+  TraceSample flat = generateTrace(params, {segment(SEGMENT_IDLE, 1)}).samples[0];
+  EXPECT_EQ(flat.x, 0);
+  EXPECT_EQ(flat.y, 0);
+  EXPECT_EQ(flat.z, 256);
+}
+
+TEST(GaitGeneratorTest, NoiseTest) {
+  GaitParams params;
+  params.noiseG = 0.05;
+  TraceData trace = generateTrace(params, {segment(SEGMENT_IDLE, 600)});
+  double sum = 0;
+  double squares = 0;
+  for(const TraceSample &sample : trace.samples) {
+    sum += sample.x;
+    squares += sample.x * sample.x;
+  }
+  double mean = sum / trace.samples.size();
+  EXPECT_NEAR(mean, 0, 0.5);
+  EXPECT_NEAR(std::sqrt(squares / trace.samples.size() - mean * mean), 0.05 * 256, 0.5);
+}
+
+TEST(GaitGeneratorTest, DeterministicTest) {
+  std::vector<GaitSegment> segments = simulatedDays(1, 7);
+  segments.resize(4);
+  GaitParams params;
+  params.seed = 3;
+  TraceData first = generateTrace(params, segments);
+  TraceData second = generateTrace(params, segments);
+  ASSERT_EQ(first.samples.size(), second.samples.size());
+  EXPECT_EQ(first.groundTruthSteps, second.groundTruthSteps);
+  EXPECT_EQ(0, std::memcmp(first.samples.data(), second.samples.data(), first.samples.size() * sizeof(TraceSample)));
+
+  params.seed = 4;
+  TraceData other = generateTrace(params, segments);
+  EXPECT_NE(0, std::memcmp(first.samples.data(), other.samples.data(), first.samples.size() * sizeof(TraceSample)));
+}
+
+TEST(GaitGeneratorTest, SimulatedDaysTest) {
+  std::vector<GaitSegment> segments = simulatedDays(7, 1);
+  double seconds = 0;
+  double walkSeconds = 0;
+  for(const GaitSegment &segment : segments) {
+    EXPECT_GT(segment.seconds, 0);
+    seconds += segment.seconds;
+    walkSeconds += (SEGMENT_WALK == segment.kind) ? segment.seconds : 0;
+  }
+  EXPECT_NEAR(seconds, 7 * 24 * 3600, 1e-3);
+  EXPECT_GT(walkSeconds, 7 * 30 * 60);
+  EXPECT_LT(walkSeconds, 7 * 2 * 3600);
+}
+
+TEST(GaitGeneratorTest, DetectorTest) {
+  // The detector counts the walks of a generated day, the segments between them add no steps
+  std::vector<GaitSegment> segments = simulatedDays(1, 2);
+  for(GaitSegment &segment : segments) {
+    segment.seconds = std::min(segment.seconds, 600.0);
+  }
+  TraceData trace = generateTrace(GaitParams(), segments);
+  ReplayResult result = replay(trace.view());
+  EXPECT_GT(result.groundTruthSteps, 1000u);
+  EXPECT_LT(result.errorPercent(), 3.0);
+}
+
+TEST(GaitGeneratorTest, WriteTest) {
+  const std::string path = testing::TempDir() + "gait_generator_test.trc";
+  std::vector<GaitSegment> segments = {segment(SEGMENT_IDLE, 30), segment(SEGMENT_WALK, 95.5), segment(SEGMENT_VEHICLE, 30)};
+  GaitParams params;
+  params.sampleRateHz = 200;
+  {
+    GaitGenerator generator(params);
+    TraceWriter writer(path, params.sampleRateHz);
+    EXPECT_EQ(generator.write(writer, segments), 31100u);
+    writer.close();
+  }
+  TraceData expected = generateTrace(params, segments);
+  {
+    TraceFile file(path);
+    TraceView view = file.view();
+    EXPECT_EQ(view.sampleRateHz, 200u);
+    EXPECT_EQ(view.groundTruthSteps, expected.groundTruthSteps);
+    ASSERT_EQ(view.sampleCount, expected.samples.size());
+    EXPECT_EQ(0, std::memcmp(view.samples, expected.samples.data(), view.sampleCount * sizeof(TraceSample)));
+  }
+  std::remove(path.c_str());
+}
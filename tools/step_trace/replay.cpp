@@ -0,0 +1,32 @@
+#include "replay.hpp"
+#include "adxl345_config.h"
+#include "step_detector.hpp"
+#include "trace_file.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+using namespace pedometer;
+
+void pedometer::checkSampleRate(const TraceView &trace) {
+  if(ADXL345_SAMPLE_RATE_HZ != trace.sampleRateHz) {
+    throw std::runtime_error(trace.name + ": sample rate " + std::to_string(trace.sampleRateHz) + " Hz, the detector runs at " +
+                             std::to_string(ADXL345_SAMPLE_RATE_HZ) + " Hz");
+  }
+}
+
+ReplayResult pedometer::replay(const TraceView &trace, const StepDetectorParams &params) {
+  checkSampleRate(trace);
+  StepDetector detector(params);
+  ReplayResult result = {0, trace.groundTruthSteps, trace.sampleCount, 0};
+  // Same batches as the firmware drains from the FIFO on every watermark interrupt
+  auto start = std::chrono::steady_clock::now();
+  for(size_t i = 0; i < trace.sampleCount; i += ADXL345_WATERMARK) {
+    result.detectedSteps += detector.process(&trace.samples[i], std::min<size_t>(ADXL345_WATERMARK, trace.sampleCount - i));
+  }
+  result.ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  return result;
+}
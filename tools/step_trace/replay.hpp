@@ -0,0 +1,55 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "step_detector.hpp"
+#include "trace_file.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace pedometer {
+
+  /**
+   * @brief Result of a trace replayed through the step detector.
+   */
+  struct ReplayResult {
+    uint32_t detectedSteps;
+    uint32_t groundTruthSteps;
+    uint64_t samples;
+    uint64_t ns; // Time spent in the detector
+
+    /**
+     * @brief Returns the step count error in percent of the ground truth, at least one step, so idle traces count too.
+     */
+    double errorPercent(void) const {
+      double difference = (detectedSteps > groundTruthSteps) ? detectedSteps - groundTruthSteps : groundTruthSteps - detectedSteps;
+      return 100.0 * difference / std::max<uint32_t>(groundTruthSteps, 1);
+    }
+
+    /**
+     * @brief Returns the detector time per sample in nanoseconds.
+     */
+    double nsPerSample(void) const { return (0 == samples) ? 0.0 : static_cast<double>(ns) / samples; }
+
+    /**
+     * @brief Returns the processed samples per second of detector time.
+     */
+    double samplesPerSecond(void) const { return (0 == ns) ? 0.0 : 1e9 * samples / ns; }
+  };
+
+  /**
+   * @brief Checks that the trace was sampled at the rate of the accelerometer (ADXL345_SAMPLE_RATE_HZ), the filters and
+   *        the minimum step interval of the detector are given in samples of that rate.
+   * @note Throws std::runtime_error if the sample rate differs.
+   */
+  void checkSampleRate(const TraceView &trace);
+
+  /**
+   * @brief Replays the trace through a new step detector in batches of the accelerometer FIFO watermark.
+   * @note Throws std::invalid_argument if the parameters aren't valid, std::runtime_error if the sample rate of the trace
+   *       isn't the rate of the detector.
+   */
+  ReplayResult replay(const TraceView &trace, const StepDetectorParams &params = StepDetectorParams());
+} // namespace pedometer
+
+#endif // REPLAY_H
@@ -0,0 +1,106 @@
+#include "replay.hpp"
+#include "step_counter_config.hpp"
+#include "step_detector.hpp"
+#include "trace_file.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace pedometer;
+
+// Replays accelerometer traces through the step detector and reports the accuracy against the labelled steps with the
+// cost per sample. With limits the exit status fails when a trace exceeds them, so the tool is a regression gate of
+// both. Build with -DCMAKE_BUILD_TYPE=Release for meaningful throughput. With several runs the fastest one is reported, a
+// short trace is easily slowed down by a single preemption.
+
+static void usage(void) {
+  std::printf("usage: step_replay [--max-error <percent>] [--max-ns-per-sample <ns>] [--runs <n>] [--magnitude isqrt|ambm] trace...\n"
+              "       step_replay --import <in.csv> <out.trc>\n"
+              "Traces are binary (.trc) or CSV (x,y,z[,step] per line).\n");
+}
+
+static bool isCsv(const std::string &path) { return path.size() >= 4 && 0 == path.compare(path.size() - 4, 4, ".csv"); }
+
+int main(int argc, char **argv) {
+  double maxError = -1;
+  double maxNsPerSample = -1;
+  int runs = 1;
+  StepDetectorParams params;
+  std::vector<std::string> paths;
+  for(int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if("--import" == arg && i + 2 < argc) {
+      try {
+        TraceData trace = importCsv(argv[i + 1]);
+        writeTrace(argv[i + 2], trace.view());
+        std::printf("%s: %zu samples, %u steps -> %s\n", argv[i + 1], trace.samples.size(), trace.groundTruthSteps, argv[i + 2]);
+        return EXIT_SUCCESS;
+      } catch(const std::runtime_error &error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return EXIT_FAILURE;
+      }
+    } else if("--max-error" == arg && i + 1 < argc) {
+      maxError = std::atof(argv[++i]);
+    } else if("--max-ns-per-sample" == arg && i + 1 < argc) {
+      maxNsPerSample = std::atof(argv[++i]);
+    } else if("--runs" == arg && i + 1 < argc) {
+      runs = std::max(1, std::atoi(argv[++i]));
+    } else if("--magnitude" == arg && i + 1 < argc) {
+      params.magnitude = (0 == std::strcmp(argv[++i], "ambm")) ? MAGNITUDE_ALPHA_MAX_BETA_MIN : MAGNITUDE_ISQRT;
+    } else if('-' == arg[0]) {
+      usage();
+      return EXIT_FAILURE;
+    } else {
+      paths.push_back(arg);
+    }
+  }
+  if(paths.empty()) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  bool isPassed = true;
+  ReplayResult total = {};
+  std::printf("%-40s %10s %7s %8s %7s %10s %8s\n", "trace", "samples", "truth", "detected", "error%", "Msamples/s", "ns/sample");
+  for(const std::string &path : paths) {
+    ReplayResult result;
+    try {
+      // Binary traces are used in place, CSV traces are imported first
+      auto fastest = [&](const TraceView &trace) {
+        ReplayResult best = replay(trace, params);
+        for(int run = 1; run < runs; run++) {
+          best.ns = std::min(best.ns, replay(trace, params).ns);
+        }
+        return best;
+      };
+      if(isCsv(path)) {
+        TraceData trace = importCsv(path);
+        result = fastest(trace.view());
+      } else {
+        TraceFile trace(path);
+        result = fastest(trace.view());
+      }
+    } catch(const std::runtime_error &error) {
+      std::fprintf(stderr, "%s\n", error.what());
+      isPassed = false;
+      continue;
+    }
+    bool isFailed = (maxError >= 0 && result.errorPercent() > maxError) || (maxNsPerSample >= 0 && result.nsPerSample() > maxNsPerSample);
+    std::printf("%-40s %10llu %7u %8u %7.2f %10.1f %8.2f%s\n", path.c_str(), static_cast<unsigned long long>(result.samples),
+                result.groundTruthSteps, result.detectedSteps, result.errorPercent(), result.samplesPerSecond() / 1e6, result.nsPerSample(),
+                isFailed ? "  FAIL" : "");
+    isPassed = isPassed && !isFailed;
+    total.detectedSteps += result.detectedSteps;
+    total.groundTruthSteps += result.groundTruthSteps;
+    total.samples += result.samples;
+    total.ns += result.ns;
+  }
+  std::printf("%-40s %10llu %7u %8u %7.2f %10.1f %8.2f\n", "total", static_cast<unsigned long long>(total.samples), total.groundTruthSteps,
+              total.detectedSteps, total.errorPercent(), total.samplesPerSecond() / 1e6, total.nsPerSample());
+  return isPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,149 @@
+#include "adxl345_config.h"
+#include "replay.hpp"
+#include "step_detector.hpp"
+#include "trace_file.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace pedometer;
+
+// Temporary file of a test, removed at the end of the test
+class TempFile {
+public:
+  std::string path;
+  explicit TempFile(const char *name) : path(std::string(::testing::TempDir()) + name) {}
+  ~TempFile(void) { std::remove(path.c_str()); }
+};
+
+static std::vector<TraceSample> ramp(size_t count) {
+  std::vector<TraceSample> samples;
+  for(size_t i = 0; i < count; i++) {
+    samples.push_back(TraceSample{static_cast<int16_t>(i), static_cast<int16_t>(-static_cast<int>(i)), static_cast<int16_t>(256 + i % 100)});
+  }
+  return samples;
+}
+
+// -------------------------------------------------------------------------------
+// ---------------------------- Trace format unit test ---------------------------
+// -------------------------------------------------------------------------------
+TEST(TraceFileTest, RoundTripTest) {
+  TempFile file("round_trip.trc");
+  std::vector<TraceSample> samples = ramp(1000);
+  {
+    TraceWriter writer(file.path, 50);
+    writer.append(samples.data(), 600, 3);
+    writer.append(&samples[600], 400, 4);
+    writer.close();
+  }
+  TraceFile trace(file.path);
+  EXPECT_EQ(trace.getHeader().version, TRACE_VERSION);
+  TraceView view = trace.view();
+  EXPECT_EQ(view.sampleRateHz, 50);
+  EXPECT_EQ(view.groundTruthSteps, 7u);
+  ASSERT_EQ(view.sampleCount, samples.size());
+  for(size_t i = 0; i < samples.size(); i++) {
+    EXPECT_EQ(view.samples[i].x, samples[i].x);
+    EXPECT_EQ(view.samples[i].y, samples[i].y);
+    EXPECT_EQ(view.samples[i].z, samples[i].z);
+  }
+
+  // The mapping moves with the object
+  TraceFile moved(std::move(trace));
+  EXPECT_EQ(moved.view().samples[999].x, 999);
+}
+
+TEST(TraceFileTest, InvalidTraceTest) {
+  EXPECT_THROW(TraceFile("/nonexistent/trace.trc"), std::runtime_error);
+
+  TempFile file("invalid.trc");
+  std::ofstream(file.path) << "not a trace file at all, just text";
+  EXPECT_THROW(TraceFile{file.path}, std::runtime_error);
+
+  // Truncated samples
+  std::vector<TraceSample> samples = ramp(10);
+  writeTrace(file.path, TraceView{"", 100, 0, samples.data(), samples.size()});
+  EXPECT_NO_THROW(TraceFile{file.path});
+  std::FILE *truncated = std::fopen(file.path.c_str(), "r+b");
+  ASSERT_NE(truncated, nullptr);
+  ASSERT_EQ(0, ::ftruncate(fileno(truncated), sizeof(TraceHeader) + 9 * sizeof(TraceSample) + 1));
+  std::fclose(truncated);
+  EXPECT_THROW(TraceFile{file.path}, std::runtime_error);
+}
+
+TEST(TraceFileTest, CsvImportTest) {
+  TempFile csv("import.csv");
+  std::ofstream(csv.path) << "# rate=25\n"
+                          << "# comment\n"
+                          << "1,2,3\n"
+                          << "-4,-5,-6,1\n"
+                          << "\n"
+                          << "7,8,9,0\n"
+                          << "10,11,12,1\n";
+  TraceData trace = importCsv(csv.path);
+  EXPECT_EQ(trace.sampleRateHz, 25);
+  EXPECT_EQ(trace.groundTruthSteps, 2u);
+  ASSERT_EQ(trace.samples.size(), 4u);
+  EXPECT_EQ(trace.samples[1].x, -4);
+  EXPECT_EQ(trace.samples[3].z, 12);
+
+  // Imported trace converts to the same binary trace
+  TempFile binary("import.trc");
+  writeTrace(binary.path, trace.view());
+  TraceFile converted(binary.path);
+  EXPECT_EQ(converted.view().groundTruthSteps, 2u);
+  EXPECT_EQ(converted.view().samples[2].y, 8);
+
+  std::ofstream(csv.path) << "1,2,3\n1,2\n";
+  EXPECT_THROW(importCsv(csv.path), std::runtime_error);
+  std::ofstream(csv.path) << "1,2,40000\n";
+  EXPECT_THROW(importCsv(csv.path), std::runtime_error);
+}
+
+// -------------------------------------------------------------------------------
+// -------------------------------- Replay test ----------------------------------
+// -------------------------------------------------------------------------------
+TEST(ReplayTest, ReplayMatchesDetectorTest) {
+  // Walking at 2 steps/s for 30 s
+  TraceData trace;
+  for(int i = 0; i < 3000; i++) {
+    double swing = 64 * std::sin(2 * M_PI * 2.0 * i / 100);
+    trace.samples.push_back(TraceSample{0, static_cast<int16_t>(0.6 * (256 + swing)), static_cast<int16_t>(0.8 * (256 + swing))});
+  }
+  trace.groundTruthSteps = 60;
+
+  StepDetector detector;
+  uint32_t steps = detector.process(trace.samples.data(), trace.samples.size());
+  ReplayResult result = replay(trace.view());
+  EXPECT_EQ(result.detectedSteps, steps);
+  EXPECT_EQ(result.samples, trace.samples.size());
+  EXPECT_LE(result.errorPercent(), 100.0 * 2 / 60);
+  EXPECT_GT(result.samplesPerSecond(), 0.0);
+
+  // Idle traces count false steps against one step
+  ReplayResult idle = {3, 0, 100, 1};
+  EXPECT_DOUBLE_EQ(idle.errorPercent(), 300.0);
+}
+
+TEST(ReplayTest, SampleRateTest) {
+  // The detector parameters are in samples at the accelerometer rate, other rates would be replayed with wrong timing
+  TraceData trace;
+  trace.name = "walk_50hz";
+  trace.samples.assign(1000, TraceSample{0, 0, 256});
+  trace.sampleRateHz = 50;
+  EXPECT_THROW(checkSampleRate(trace.view()), std::runtime_error);
+  EXPECT_THROW(replay(trace.view()), std::runtime_error);
+  trace.sampleRateHz = 200;
+  EXPECT_THROW(replay(trace.view()), std::runtime_error);
+
+  trace.sampleRateHz = ADXL345_SAMPLE_RATE_HZ;
+  EXPECT_NO_THROW(checkSampleRate(trace.view()));
+  EXPECT_EQ(replay(trace.view()).detectedSteps, 0u);
+}
@@ -0,0 +1,108 @@
+#include "step_counter_config.hpp"
+#include "step_detector.hpp"
+#include "replay.hpp"
+#include "trace_file.hpp"
+#include "tuner.hpp"
+#include "work_stealing_pool.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace pedometer;
+
+// Sweeps the step detector parameters over a trace corpus on all cores and prints the Pareto front of the step error
+// against the cost per sample. The cost of a configuration is the cost of its magnitude method, measured single-threaded
+// after the sweep. The corpus is loaded once, binary traces are mapped and shared by all workers. Build with
+// -DCMAKE_BUILD_TYPE=Release for meaningful costs.
+
+static void usage(void) {
+  std::printf("usage: step_tuner [--random <configs>] [--seed <seed>] [--threads <threads>] trace...\n"
+              "Without --random all combinations of the grid are evaluated.\n");
+}
+
+static bool isCsv(const std::string &path) { return path.size() >= 4 && 0 == path.compare(path.size() - 4, 4, ".csv"); }
+
+static void printResult(const char *label, const TunerResult &result) {
+  const StepDetectorParams &params = result.params;
+  std::printf("%-8s %7.2f %9.2f %-5s %3u %3u %3u %3u %5u %6u %6u\n", label, result.errorPercent(), result.nsPerSample(),
+              (MAGNITUDE_ISQRT == params.magnitude) ? "isqrt" : "ambm", params.lowPassShift, params.highPassShift, params.envelopeShift,
+              params.decayShift, params.thresholdRatio, params.minThreshold, params.minInterval);
+}
+
+int main(int argc, char **argv) {
+  size_t randomConfigs = 0;
+  uint32_t seed = 1;
+  size_t threads = 0;
+  std::vector<std::string> paths;
+  for(int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if("--random" == arg && i + 1 < argc) {
+      randomConfigs = std::strtoul(argv[++i], nullptr, 10);
+    } else if("--seed" == arg && i + 1 < argc) {
+      seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if("--threads" == arg && i + 1 < argc) {
+      threads = std::strtoul(argv[++i], nullptr, 10);
+    } else if('-' == arg[0]) {
+      usage();
+      return EXIT_FAILURE;
+    } else {
+      paths.push_back(arg);
+    }
+  }
+  if(paths.empty()) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  // Corpus: mapped binary traces and imported CSV traces, views point into them
+  std::vector<std::unique_ptr<TraceFile>> files;
+  std::vector<TraceData> imported;
+  imported.reserve(paths.size());
+  std::vector<TraceView> traces;
+  uint64_t samples = 0;
+  try {
+    for(const std::string &path : paths) {
+      if(isCsv(path)) {
+        imported.push_back(importCsv(path));
+        traces.push_back(imported.back().view());
+      } else {
+        files.push_back(std::make_unique<TraceFile>(path));
+        traces.push_back(files.back()->view());
+      }
+      // Traces are checked before the sweep, the workers can't report errors
+      checkSampleRate(traces.back());
+      samples += traces.back().sampleCount;
+    }
+  } catch(const std::runtime_error &error) {
+    std::fprintf(stderr, "%s\n", error.what());
+    return EXIT_FAILURE;
+  }
+
+  std::vector<StepDetectorParams> configs = (0 == randomConfigs) ? gridSearch() : randomSearch(randomConfigs, seed);
+  WorkStealingPool pool(threads);
+  auto start = std::chrono::steady_clock::now();
+  std::vector<TunerResult> results = sweep(pool, configs, traces);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::printf("%zu configs x %zu traces (%llu samples) on %zu threads in %.2f s, %.1f Msamples/s, %llu tasks stolen\n\n", configs.size(),
+              traces.size(), static_cast<unsigned long long>(samples), pool.size(), seconds, configs.size() * samples / seconds / 1e6,
+              static_cast<unsigned long long>(pool.getStolen()));
+
+  // Costs of the sweep were measured while all workers ran, the costs of the magnitude methods are measured alone
+  MagnitudeCosts costs = measureCosts(traces);
+  std::vector<TunerResult> defaults = {evaluate(StepDetectorParams(), traces)};
+  applyCosts(results, costs);
+  applyCosts(defaults, costs);
+
+  std::printf("%-8s %7s %9s %-5s %3s %3s %3s %3s %5s %6s %6s\n", "", "error%", "ns/sample", "mag", "lp", "hp", "env", "dec", "ratio", "minThr",
+              "minInt");
+  printResult("default", defaults[0]);
+  for(const TunerResult &result : paretoFront(results)) {
+    printResult("pareto", result);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+#include "trace_file.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+using namespace pedometer;
+
+static std::runtime_error fileError(const std::string &path, const char *what) {
+  return std::runtime_error(path + ": " + what + ((0 != errno) ? std::string(" (") + std::strerror(errno) + ")" : std::string()));
+}
+
+TraceFile::TraceFile(const std::string &path) : mPath(path) {
+  errno = 0;
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if(fd < 0) {
+    throw fileError(path, "can't open the trace");
+  }
+  struct stat info;
+  if(0 != ::fstat(fd, &info)) {
+    ::close(fd);
+    throw fileError(path, "can't read the trace size");
+  }
+  mSize = static_cast<size_t>(info.st_size);
+  if(mSize < sizeof(TraceHeader)) {
+    ::close(fd);
+    errno = 0;
+    throw fileError(path, "trace is shorter than its header");
+  }
+  void *data = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps the file referenced
+  ::close(fd);
+  if(MAP_FAILED == data) {
+    throw fileError(path, "can't map the trace");
+  }
+  mData = static_cast<const uint8_t *>(data);
+  // Samples are read once from the start to the end
+  ::madvise(data, mSize, MADV_SEQUENTIAL);
+
+  errno = 0;
+  const TraceHeader &header = getHeader();
+  const char *error = nullptr;
+  if(0 != std::memcmp(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC))) {
+    error = "not a trace file";
+  } else if(TRACE_VERSION != header.version) {
+    error = "unsupported trace version";
+  } else if(0 == header.sampleRateHz) {
+    error = "invalid sample rate";
+  } else if(header.sampleCount != (mSize - sizeof(TraceHeader)) / sizeof(TraceSample) ||
+            0 != (mSize - sizeof(TraceHeader)) % sizeof(TraceSample)) {
+    error = "sample count doesn't match the trace size";
+  }
+  if(nullptr != error) {
+    ::munmap(data, mSize);
+    throw fileError(path, error);
+  }
+}
+
+TraceFile::TraceFile(TraceFile &&other) noexcept : mPath(std::move(other.mPath)), mData(other.mData), mSize(other.mSize) {
+  other.mData = nullptr;
+  other.mSize = 0;
+}
+
+TraceFile::~TraceFile(void) {
+  if(nullptr != mData) {
+    ::munmap(const_cast<uint8_t *>(mData), mSize);
+  }
+}
+
+TraceView TraceFile::view(void) const {
+  const TraceHeader &header = getHeader();
+  return TraceView{mPath, header.sampleRateHz, header.groundTruthSteps, reinterpret_cast<const TraceSample *>(mData + sizeof(TraceHeader)),
+                   static_cast<size_t>(header.sampleCount)};
+}
+
+TraceWriter::TraceWriter(const std::string &path, uint16_t sampleRateHz) {
+  errno = 0;
+  if(0 == sampleRateHz) {
+    throw fileError(path, "invalid sample rate");
+  }
+  mFile = std::fopen(path.c_str(), "wb");
+  if(nullptr == mFile) {
+    throw fileError(path, "can't create the trace");
+  }
+  std::memcpy(mHeader.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  mHeader.version = TRACE_VERSION;
+  mHeader.sampleRateHz = sampleRateHz;
+  // The header is written again with the final counts by close()
+  if(1 != std::fwrite(&mHeader, sizeof(mHeader), 1, mFile)) {
+    std::fclose(mFile);
+    mFile = nullptr;
+    throw fileError(path, "can't write the trace header");
+  }
+}
+
+TraceWriter::~TraceWriter(void) {
+  if(nullptr != mFile) {
+    try {
+      close();
+    } catch(const std::runtime_error &) {
+      // Errors are reported only by an explicit close()
+    }
+  }
+}
+
+void TraceWriter::append(const TraceSample *samples, size_t count, uint32_t steps) {
+  if(nullptr == mFile) {
+    throw std::runtime_error("Trace is already closed.");
+  }
+  if(count != std::fwrite(samples, sizeof(TraceSample), count, mFile)) {
+    throw std::runtime_error("Can't write the trace samples.");
+  }
+  mHeader.sampleCount += count;
+  mHeader.groundTruthSteps += steps;
+}
+
+void TraceWriter::close(void) {
+  if(nullptr == mFile) {
+    return;
+  }
+  std::FILE *file = mFile;
+  mFile = nullptr;
+  bool isWritten = 0 == std::fseek(file, 0, SEEK_SET) && 1 == std::fwrite(&mHeader, sizeof(mHeader), 1, file);
+  if(0 != std::fclose(file) || !isWritten) {
+    throw std::runtime_error("Can't write the trace header.");
+  }
+}
+
+TraceData pedometer::importCsv(const std::string &path) {
+  errno = 0;
+  std::FILE *file = std::fopen(path.c_str(), "r");
+  if(nullptr == file) {
+    throw fileError(path, "can't open the CSV trace");
+  }
+  TraceData trace;
+  trace.name = path;
+  char line[128];
+  uint32_t lineNumber = 0;
+  while(nullptr != std::fgets(line, sizeof(line), file)) {
+    lineNumber++;
+    if('#' == line[0]) {
+      unsigned rate;
+      if(1 == std::sscanf(line, "# rate=%u", &rate) && rate > 0 && rate <= UINT16_MAX) {
+        trace.sampleRateHz = static_cast<uint16_t>(rate);
+      }
+      continue;
+    }
+    if('\n' == line[0] || '\r' == line[0]) {
+      continue;
+    }
+    int x, y, z, step = 0;
+    int fields = std::sscanf(line, "%d,%d,%d,%d", &x, &y, &z, &step);
+    if(fields < 3 || x < INT16_MIN || x > INT16_MAX || y < INT16_MIN || y > INT16_MAX || z < INT16_MIN || z > INT16_MAX) {
+      std::fclose(file);
+      errno = 0;
+      throw fileError(path, ("invalid sample on line " + std::to_string(lineNumber)).c_str());
+    }
+    trace.samples.push_back(TraceSample{static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z)});
+    trace.groundTruthSteps += (0 != step) ? 1 : 0;
+  }
+  std::fclose(file);
+  return trace;
+}
+
+void pedometer::writeTrace(const std::string &path, const TraceView &trace) {
+  TraceWriter writer(path, trace.sampleRateHz);
+  writer.append(trace.samples, trace.sampleCount, trace.groundTruthSteps);
+  writer.close();
+}
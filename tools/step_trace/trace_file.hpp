@@ -0,0 +1,143 @@
+#ifndef TRACE_FILE_H
+#define TRACE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace pedometer {
+
+  // Binary trace: TraceHeader followed by sampleCount samples, little endian
+  inline constexpr char TRACE_MAGIC[4] = {'S', 'T', 'R', 'C'};
+  enum : uint16_t { TRACE_VERSION = 1, TRACE_DEFAULT_RATE_HZ = 100 };
+
+  /**
+   * @brief Header of a binary trace file.
+   */
+  struct TraceHeader {
+    char magic[4];             // TRACE_MAGIC
+    uint16_t version;          // TRACE_VERSION
+    uint16_t sampleRateHz;     // Rate of the samples
+    uint32_t groundTruthSteps; // Labelled steps of the whole trace
+    uint32_t reserved;         // 0
+    uint64_t sampleCount;      // Number of samples after the header
+  };
+  static_assert(24 == sizeof(TraceHeader), "Trace header must not have padding.");
+
+  /**
+   * @brief Accelerometer sample of a trace, raw values in 256 LSB/g like the ADXL345 FIFO.
+   */
+  struct TraceSample {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+  };
+  static_assert(6 == sizeof(TraceSample), "Trace sample must not have padding.");
+
+  /**
+   * @brief Samples of a trace with its labels, the samples are owned by a TraceFile or a TraceData.
+   */
+  struct TraceView {
+    std::string name;
+    uint16_t sampleRateHz;
+    uint32_t groundTruthSteps;
+    const TraceSample *samples;
+    size_t sampleCount;
+  };
+
+  /**
+   * @brief Trace held in memory, e.g. imported from CSV.
+   */
+  struct TraceData {
+    std::string name;
+    uint16_t sampleRateHz = TRACE_DEFAULT_RATE_HZ;
+    uint32_t groundTruthSteps = 0;
+    std::vector<TraceSample> samples;
+
+    TraceView view(void) const { return TraceView{name, sampleRateHz, groundTruthSteps, samples.data(), samples.size()}; }
+  };
+
+  /**
+   * @brief Class that maps a binary trace file read-only into memory.
+   *
+   * Samples are used in place from the page cache, long traces are neither copied nor parsed.
+   */
+  class TraceFile {
+  private:
+    std::string mPath;
+    const uint8_t *mData = nullptr;
+    size_t mSize = 0;
+
+    TraceFile(const TraceFile &) = delete;
+    TraceFile &operator=(const TraceFile &) = delete;
+
+  public:
+    /**
+     * @brief Maps the trace file.
+     * @note Throws std::runtime_error if the file can't be mapped or isn't a valid trace.
+     */
+    explicit TraceFile(const std::string &path);
+    TraceFile(TraceFile &&other) noexcept;
+    ~TraceFile(void);
+
+    /**
+     * @brief Returns the header of the trace.
+     */
+    const TraceHeader &getHeader(void) const { return *reinterpret_cast<const TraceHeader *>(mData); }
+
+    /**
+     * @brief Returns the samples of the trace.
+     */
+    TraceView view(void) const;
+  };
+
+  /**
+   * @brief Class that writes a binary trace, samples are appended in blocks.
+   */
+  class TraceWriter {
+  private:
+    std::FILE *mFile = nullptr;
+    TraceHeader mHeader = {};
+
+    TraceWriter(const TraceWriter &) = delete;
+    TraceWriter &operator=(const TraceWriter &) = delete;
+
+  public:
+    /**
+     * @brief Creates the trace file.
+     * @note Throws std::runtime_error if the file can't be created.
+     */
+    TraceWriter(const std::string &path, uint16_t sampleRateHz);
+    ~TraceWriter(void);
+
+    /**
+     * @brief Appends samples and their labelled steps.
+     * @note Throws std::runtime_error if the write fails.
+     */
+    void append(const TraceSample *samples, size_t count, uint32_t steps);
+
+    /**
+     * @brief Writes the final header and closes the file, called by the destructor if not called before.
+     * @note Throws std::runtime_error if the write fails.
+     */
+    void close(void);
+  };
+
+  /**
+   * @brief Reads a CSV trace: one sample per line as x,y,z[,step], where step 1 labels a step on the sample.
+   *
+   * Empty lines and lines starting with '#' are skipped, a "# rate=<Hz>" comment sets the sample rate.
+   * @note Throws std::runtime_error if the file can't be read or a line isn't valid.
+   */
+  TraceData importCsv(const std::string &path);
+
+  /**
+   * @brief Writes the trace as a binary trace file.
+   * @note Throws std::runtime_error if the file can't be written.
+   */
+  void writeTrace(const std::string &path, const TraceView &trace);
+} // namespace pedometer
+
+#endif // TRACE_FILE_H
@@ -0,0 +1,126 @@
+#include "tuner.hpp"
+#include "replay.hpp"
+#include "step_detector.hpp"
+#include "trace_file.hpp"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace pedometer;
+
+// Tuned values, the defaults of the firmware are among them
+static constexpr MagnitudeMethod MAGNITUDES[] = {MAGNITUDE_ISQRT, MAGNITUDE_ALPHA_MAX_BETA_MIN};
+static constexpr uint8_t LOW_PASS_SHIFTS[] = {1, 2, 3};
+static constexpr uint8_t HIGH_PASS_SHIFTS[] = {4, 5, 6, 7};
+static constexpr uint8_t ENVELOPE_SHIFTS[] = {1, 2, 3};
+static constexpr uint8_t THRESHOLD_RATIOS[] = {64, 96, 128, 160, 192};
+static constexpr uint16_t MIN_THRESHOLDS[] = {6, 12, 20};
+static constexpr uint16_t MIN_INTERVALS[] = {20, 25, 30, 35};
+
+std::vector<StepDetectorParams> pedometer::gridSearch(void) {
+  std::vector<StepDetectorParams> configs;
+  StepDetectorParams params;
+  for(MagnitudeMethod magnitude : MAGNITUDES) {
+    params.magnitude = magnitude;
+    for(uint8_t lowPassShift : LOW_PASS_SHIFTS) {
+      params.lowPassShift = lowPassShift;
+      for(uint8_t highPassShift : HIGH_PASS_SHIFTS) {
+        params.highPassShift = highPassShift;
+        for(uint8_t envelopeShift : ENVELOPE_SHIFTS) {
+          params.envelopeShift = envelopeShift;
+          for(uint8_t thresholdRatio : THRESHOLD_RATIOS) {
+            params.thresholdRatio = thresholdRatio;
+            for(uint16_t minThreshold : MIN_THRESHOLDS) {
+              params.minThreshold = minThreshold;
+              for(uint16_t minInterval : MIN_INTERVALS) {
+                params.minInterval = minInterval;
+                configs.push_back(params);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  return configs;
+}
+
+std::vector<StepDetectorParams> pedometer::randomSearch(size_t count, uint32_t seed) {
+  std::mt19937 random(seed);
+  auto between = [&random](int min, int max) { return std::uniform_int_distribution<int>(min, max)(random); };
+  std::vector<StepDetectorParams> configs;
+  while(configs.size() < count) {
+    StepDetectorParams params;
+    params.magnitude = MAGNITUDES[between(0, 1)];
+    params.lowPassShift = static_cast<uint8_t>(between(LOW_PASS_SHIFTS[0], LOW_PASS_SHIFTS[2]));
+    params.highPassShift = static_cast<uint8_t>(between(HIGH_PASS_SHIFTS[0], HIGH_PASS_SHIFTS[3]));
+    params.envelopeShift = static_cast<uint8_t>(between(ENVELOPE_SHIFTS[0], ENVELOPE_SHIFTS[2]));
+    params.thresholdRatio = static_cast<uint8_t>(between(THRESHOLD_RATIOS[0], THRESHOLD_RATIOS[4]));
+    params.minThreshold = static_cast<uint16_t>(between(MIN_THRESHOLDS[0], MIN_THRESHOLDS[2]));
+    params.minInterval = static_cast<uint16_t>(between(MIN_INTERVALS[0], MIN_INTERVALS[3]));
+    if(params.isValid()) {
+      configs.push_back(params);
+    }
+  }
+  return configs;
+}
+
+TunerResult pedometer::evaluate(const StepDetectorParams &params, const std::vector<TraceView> &traces) {
+  TunerResult result = {params, 0, 0, 0, 0};
+  for(const TraceView &trace : traces) {
+    ReplayResult replayed = replay(trace, params);
+    result.groundTruthSteps += replayed.groundTruthSteps;
+    result.stepErrors += (replayed.detectedSteps > replayed.groundTruthSteps) ? replayed.detectedSteps - replayed.groundTruthSteps
+                                                                              : replayed.groundTruthSteps - replayed.detectedSteps;
+    result.samples += replayed.samples;
+    result.ns += replayed.ns;
+  }
+  return result;
+}
+
+std::vector<TunerResult> pedometer::sweep(WorkStealingPool &pool, const std::vector<StepDetectorParams> &configs,
+                                          const std::vector<TraceView> &traces) {
+  std::vector<TunerResult> results(configs.size());
+  // Every task writes only its own result, the traces are shared read-only
+  for(size_t i = 0; i < configs.size(); i++) {
+    pool.submit([&results, &configs, &traces, i] { results[i] = evaluate(configs[i], traces); });
+  }
+  pool.wait();
+  return results;
+}
+
+MagnitudeCosts pedometer::measureCosts(const std::vector<TraceView> &traces) {
+  MagnitudeCosts costs;
+  for(MagnitudeMethod magnitude : MAGNITUDES) {
+    StepDetectorParams params;
+    params.magnitude = magnitude;
+    costs[magnitude] = UINT64_MAX;
+    for(uint8_t run = 0; run < TUNER_TIMING_RUNS; run++) {
+      costs[magnitude] = std::min(costs[magnitude], evaluate(params, traces).ns);
+    }
+  }
+  return costs;
+}
+
+void pedometer::applyCosts(std::vector<TunerResult> &results, const MagnitudeCosts &costs) {
+  for(TunerResult &result : results) {
+    result.ns = costs[result.params.magnitude];
+  }
+}
+
+std::vector<TunerResult> pedometer::paretoFront(std::vector<TunerResult> results) {
+  std::stable_sort(results.begin(), results.end(), [](const TunerResult &a, const TunerResult &b) {
+    return (a.nsPerSample() != b.nsPerSample()) ? a.nsPerSample() < b.nsPerSample() : a.stepErrors < b.stepErrors;
+  });
+  // From the cheapest, a configuration is kept only if it is more accurate than all cheaper ones
+  std::vector<TunerResult> front;
+  for(const TunerResult &result : results) {
+    if(front.empty() || result.stepErrors < front.back().stepErrors) {
+      front.push_back(result);
+    }
+  }
+  return front;
+}
@@ -0,0 +1,86 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+#include "step_detector.hpp"
+#include "trace_file.hpp"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pedometer {
+
+  // Timing runs per magnitude method, the fastest run is kept
+  enum : uint8_t { TUNER_TIMING_RUNS = 5 };
+
+  /**
+   * @brief Detector time over the trace corpus in nanoseconds, indexed by MagnitudeMethod.
+   */
+  using MagnitudeCosts = std::array<uint64_t, MAGNITUDE_METHOD_NUM>;
+
+  /**
+   * @brief Result of one detector configuration over the whole trace corpus.
+   */
+  struct TunerResult {
+    StepDetectorParams params;
+    uint32_t groundTruthSteps;
+    uint32_t stepErrors; // Sum of the step count errors of the traces, errors of two traces don't cancel out
+    uint64_t samples;
+    uint64_t ns;         // Time spent in the detector, see applyCosts()
+
+    /**
+     * @brief Returns the step errors in percent of the ground truth, at least one step.
+     */
+    double errorPercent(void) const { return 100.0 * stepErrors / std::max<uint32_t>(groundTruthSteps, 1); }
+
+    /**
+     * @brief Returns the detector time per sample in nanoseconds.
+     */
+    double nsPerSample(void) const { return (0 == samples) ? 0.0 : static_cast<double>(ns) / samples; }
+  };
+
+  /**
+   * @brief Returns all combinations of the tuned parameter values.
+   */
+  std::vector<StepDetectorParams> gridSearch(void);
+
+  /**
+   * @brief Returns random valid parameters from the same ranges as the grid, reproducible by the seed.
+   */
+  std::vector<StepDetectorParams> randomSearch(size_t count, uint32_t seed);
+
+  /**
+   * @brief Replays all traces with the parameters, every call uses its own detector.
+   */
+  TunerResult evaluate(const StepDetectorParams &params, const std::vector<TraceView> &traces);
+
+  /**
+   * @brief Evaluates every configuration in a task of the pool, results are in the order of the configurations.
+   */
+  std::vector<TunerResult> sweep(WorkStealingPool &pool, const std::vector<StepDetectorParams> &configs, const std::vector<TraceView> &traces);
+
+  /**
+   * @brief Measures the detector time of every magnitude method over the traces on the calling thread, the fastest of
+   *        TUNER_TIMING_RUNS runs. The pool should be idle.
+   */
+  MagnitudeCosts measureCosts(const std::vector<TraceView> &traces);
+
+  /**
+   * @brief Sets the detector time of the results to the measured time of their magnitude method.
+   *
+   * The filters and the peak detection do the same work for any shifts and thresholds, only the magnitude method
+   * changes the cost per sample. Times measured by sweep() while all workers run mostly show the scheduling, with the
+   * costs of the methods the Pareto front is the same in every run.
+   */
+  void applyCosts(std::vector<TunerResult> &results, const MagnitudeCosts &costs);
+
+  /**
+   * @brief Returns the configurations no other configuration beats in both error and cost, from the cheapest. Of equal
+   *        configurations the first one is kept.
+   */
+  std::vector<TunerResult> paretoFront(std::vector<TunerResult> results);
+} // namespace pedometer
+
+#endif // TUNER_H
@@ -0,0 +1,169 @@
+#include "step_detector.hpp"
+#include "trace_file.hpp"
+#include "tuner.hpp"
+#include "work_stealing_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace pedometer;
+
+// Walking trace with the given cadence for 20 s
+static TraceData walkTrace(double cadenceHz) {
+  TraceData trace;
+  for(int i = 0; i < 2000; i++) {
+    double swing = 64 * std::sin(2 * M_PI * cadenceHz * i / 100);
+    trace.samples.push_back(TraceSample{0, static_cast<int16_t>(0.6 * (256 + swing)), static_cast<int16_t>(0.8 * (256 + swing))});
+  }
+  trace.groundTruthSteps = static_cast<uint32_t>(std::lround(20 * cadenceHz));
+  return trace;
+}
+
+static TunerResult result(uint32_t stepErrors, uint64_t ns) { return TunerResult{StepDetectorParams(), 100, stepErrors, 1000, ns}; }
+
+// -------------------------------------------------------------------------------
+// ------------------------ WorkStealingPool class unit test ---------------------
+// -------------------------------------------------------------------------------
+TEST(WorkStealingPoolTest, RunsAllTasksTest) {
+  WorkStealingPool pool(4);
+  EXPECT_EQ(pool.size(), 4u);
+  std::atomic<uint32_t> done{0};
+  for(int i = 0; i < 1000; i++) {
+    pool.submit([&done] { done++; });
+  }
+  pool.wait();
+  EXPECT_EQ(done.load(), 1000u);
+
+  // The pool is reusable after wait()
+  pool.submit([&done] { done++; });
+  pool.wait();
+  EXPECT_EQ(done.load(), 1001u);
+}
+
+TEST(WorkStealingPoolTest, StealingTest) {
+  // Tasks submitted by a task stay in its worker's queue, the idle workers have to steal them
+  WorkStealingPool pool(4);
+  std::atomic<uint32_t> done{0};
+  pool.submit([&pool, &done] {
+    for(int i = 0; i < 64; i++) {
+      pool.submit([&done] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        done++;
+      });
+    }
+  });
+  pool.wait();
+  EXPECT_EQ(done.load(), 64u);
+  EXPECT_GT(pool.getStolen(), 0u);
+}
+
+TEST(WorkStealingPoolTest, DestructorWaitsTest) {
+  std::atomic<uint32_t> done{0};
+  {
+    WorkStealingPool pool(2);
+    for(int i = 0; i < 10; i++) {
+      pool.submit([&done] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        done++;
+      });
+    }
+  }
+  EXPECT_EQ(done.load(), 10u);
+}
+
+// -------------------------------------------------------------------------------
+// --------------------------------- Tuner test ----------------------------------
+// -------------------------------------------------------------------------------
+TEST(TunerTest, SearchTest) {
+  std::vector<StepDetectorParams> grid = gridSearch();
+  EXPECT_EQ(grid.size(), 2u * 3 * 4 * 3 * 5 * 3 * 4);
+  bool hasDefault = false;
+  for(const StepDetectorParams &params : grid) {
+    EXPECT_TRUE(params.isValid());
+    StepDetectorParams defaults;
+    hasDefault = hasDefault || (params.magnitude == defaults.magnitude && params.lowPassShift == defaults.lowPassShift &&
+                                params.highPassShift == defaults.highPassShift && params.envelopeShift == defaults.envelopeShift &&
+                                params.thresholdRatio == defaults.thresholdRatio && params.minThreshold == defaults.minThreshold &&
+                                params.minInterval == defaults.minInterval);
+  }
+  EXPECT_TRUE(hasDefault);
+
+  std::vector<StepDetectorParams> first = randomSearch(100, 7);
+  std::vector<StepDetectorParams> second = randomSearch(100, 7);
+  ASSERT_EQ(first.size(), 100u);
+  for(size_t i = 0; i < first.size(); i++) {
+    EXPECT_TRUE(first[i].isValid());
+    EXPECT_EQ(first[i].thresholdRatio, second[i].thresholdRatio);
+    EXPECT_EQ(first[i].minInterval, second[i].minInterval);
+  }
+}
+
+TEST(TunerTest, SweepMatchesSequentialTest) {
+  // Thousands of detector instances on all workers count the same as one by one
+  TraceData slow = walkTrace(1.5);
+  TraceData fast = walkTrace(2.4);
+  std::vector<TraceView> traces = {slow.view(), fast.view()};
+  std::vector<StepDetectorParams> configs = randomSearch(2000, 3);
+  WorkStealingPool pool(4);
+  std::vector<TunerResult> results = sweep(pool, configs, traces);
+  ASSERT_EQ(results.size(), configs.size());
+  for(size_t i = 0; i < configs.size(); i += 97) {
+    TunerResult expected = evaluate(configs[i], traces);
+    EXPECT_EQ(results[i].stepErrors, expected.stepErrors) << i;
+    EXPECT_EQ(results[i].samples, 4000u);
+    EXPECT_EQ(results[i].groundTruthSteps, 30u + 48u);
+  }
+}
+
+TEST(TunerTest, ParetoFrontTest) {
+  // Cost 1000 ns / 1000 samples = 1 ns/sample
+  std::vector<TunerResult> front = paretoFront({result(10, 2000), result(20, 1000), result(5, 4000), result(10, 3000), result(30, 1500),
+                                                result(5, 5000), result(2, 6000)});
+  ASSERT_EQ(front.size(), 4u);
+  EXPECT_EQ(front[0].stepErrors, 20u);
+  EXPECT_EQ(front[1].stepErrors, 10u);
+  EXPECT_EQ(front[1].ns, 2000u);
+  EXPECT_EQ(front[2].stepErrors, 5u);
+  EXPECT_EQ(front[2].ns, 4000u);
+  EXPECT_EQ(front[3].stepErrors, 2u);
+}
+
+TEST(TunerTest, CostsTest) {
+  TraceData trace = walkTrace(1.8);
+  std::vector<TraceView> traces = {trace.view()};
+  MagnitudeCosts costs = measureCosts(traces);
+  EXPECT_GT(costs[MAGNITUDE_ISQRT], 0u);
+  EXPECT_GT(costs[MAGNITUDE_ALPHA_MAX_BETA_MIN], 0u);
+
+  // Every configuration costs what its magnitude method costs, whatever the timing of the sweep was
+  std::vector<StepDetectorParams> configs = randomSearch(200, 5);
+  WorkStealingPool pool(4);
+  std::vector<TunerResult> results = sweep(pool, configs, traces);
+  applyCosts(results, costs);
+  for(const TunerResult &result : results) {
+    EXPECT_EQ(result.ns, costs[result.params.magnitude]);
+  }
+
+  // The front has the first most accurate configuration of each method that is more accurate than the cheaper methods
+  std::vector<TunerResult> front = paretoFront(results);
+  ASSERT_GE(front.size(), 1u);
+  ASSERT_LE(front.size(), static_cast<size_t>(MAGNITUDE_METHOD_NUM));
+  for(const TunerResult &entry : front) {
+    const TunerResult *best = nullptr;
+    for(const TunerResult &result : results) {
+      if(result.params.magnitude == entry.params.magnitude && (nullptr == best || result.stepErrors < best->stepErrors)) {
+        best = &result;
+      }
+    }
+    ASSERT_NE(best, nullptr);
+    EXPECT_EQ(entry.stepErrors, best->stepErrors);
+    EXPECT_EQ(entry.params.thresholdRatio, best->params.thresholdRatio);
+    EXPECT_EQ(entry.params.minInterval, best->params.minInterval);
+    EXPECT_EQ(entry.params.lowPassShift, best->params.lowPassShift);
+    EXPECT_EQ(entry.params.highPassShift, best->params.highPassShift);
+  }
+}
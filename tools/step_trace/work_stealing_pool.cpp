@@ -0,0 +1,107 @@
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+using namespace pedometer;
+
+thread_local size_t WorkStealingPool::sWorkerIndex = SIZE_MAX;
+
+WorkStealingPool::WorkStealingPool(size_t threads) {
+  if(0 == threads) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for(size_t i = 0; i < threads; i++) {
+    mWorkers.push_back(std::make_unique<Worker>());
+  }
+  for(size_t i = 0; i < threads; i++) {
+    mThreads.emplace_back(&WorkStealingPool::run, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool(void) {
+  wait();
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mIsStopping = true;
+  }
+  mWakeUp.notify_all();
+  for(std::thread &thread : mThreads) {
+    thread.join();
+  }
+}
+
+void WorkStealingPool::submit(Task task) {
+  // Tasks of a worker stay local, the other ones are spread round robin
+  size_t index = (sWorkerIndex < mWorkers.size()) ? sWorkerIndex : mNextWorker.fetch_add(1, std::memory_order_relaxed) % mWorkers.size();
+  mPending.fetch_add(1, std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(mWorkers[index]->mutex);
+    mWorkers[index]->tasks.push_back(std::move(task));
+  }
+  mQueued.fetch_add(1, std::memory_order_release);
+  // The lock orders the notification with a worker checking the queues before sleeping
+  { std::lock_guard<std::mutex> lock(mMutex); }
+  mWakeUp.notify_one();
+}
+
+void WorkStealingPool::wait(void) {
+  std::unique_lock<std::mutex> lock(mMutex);
+  mDone.wait(lock, [this] { return 0 == mPending.load(std::memory_order_acquire); });
+}
+
+bool WorkStealingPool::popOwn(size_t index, Task &task) {
+  Worker &worker = *mWorkers[index];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if(worker.tasks.empty()) {
+    return false;
+  }
+  task = std::move(worker.tasks.back());
+  worker.tasks.pop_back();
+  mQueued.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool WorkStealingPool::steal(size_t index, Task &task) {
+  // Victims are visited from the next worker, so thieves don't all start at the same queue
+  for(size_t i = 1; i < mWorkers.size(); i++) {
+    Worker &victim = *mWorkers[(index + i) % mWorkers.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if(!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      mQueued.fetch_sub(1, std::memory_order_relaxed);
+      mStolen.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::run(size_t index) {
+  sWorkerIndex = index;
+  Task task;
+  while(true) {
+    if(popOwn(index, task) || steal(index, task)) {
+      task();
+      task = nullptr;
+      if(1 == mPending.fetch_sub(1, std::memory_order_acq_rel)) {
+        { std::lock_guard<std::mutex> lock(mMutex); }
+        mDone.notify_all();
+      }
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mMutex);
+    if(mIsStopping) {
+      return;
+    }
+    // A task queued after the failed search is counted before its submitter takes the lock, so the wake-up isn't lost
+    mWakeUp.wait(lock, [this] { return mIsStopping || mQueued.load(std::memory_order_acquire) > 0; });
+    if(mIsStopping) {
+      return;
+    }
+  }
+}
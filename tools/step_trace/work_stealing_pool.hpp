@@ -0,0 +1,87 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pedometer {
+
+  /**
+   * @brief Thread pool where every worker has its own task queue and idle workers steal from the others.
+   *
+   * A worker takes its newest task first, so tasks submitted by a task run while their data are hot, and thieves take
+   * the oldest task of another worker, which is usually the largest remaining piece of work. Submitting from outside
+   * of the pool spreads the tasks round robin.
+   */
+  class WorkStealingPool {
+  public:
+    using Task = std::function<void(void)>;
+
+  private:
+    struct Worker {
+      std::mutex mutex;
+      std::deque<Task> tasks;
+    };
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::vector<std::thread> mThreads;
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    std::condition_variable mDone;
+    std::atomic<size_t> mPending{0}; // Submitted tasks that haven't finished
+    std::atomic<size_t> mQueued{0};  // Submitted tasks that haven't started
+    std::atomic<uint64_t> mStolen{0};
+    std::atomic<size_t> mNextWorker{0};
+    bool mIsStopping = false;
+
+    // Index of the worker running on the calling thread, SIZE_MAX outside of the pool
+    static thread_local size_t sWorkerIndex;
+
+    void run(size_t index);
+    bool popOwn(size_t index, Task &task);
+    bool steal(size_t index, Task &task);
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  public:
+    /**
+     * @brief Starts the workers, 0 starts one per hardware thread.
+     */
+    explicit WorkStealingPool(size_t threads = 0);
+
+    /**
+     * @brief Waits for the queued tasks and stops the workers.
+     */
+    ~WorkStealingPool(void);
+
+    /**
+     * @brief Queues the task, may be called from any thread including the tasks.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Waits until all submitted tasks, including the tasks they submitted, have finished.
+     */
+    void wait(void);
+
+    /**
+     * @brief Returns the number of workers.
+     */
+    size_t size(void) const { return mWorkers.size(); }
+
+    /**
+     * @brief Returns the number of tasks a worker took from the queues of other workers.
+     */
+    uint64_t getStolen(void) const { return mStolen.load(std::memory_order_relaxed); }
+  };
+} // namespace pedometer
+
+#endif // WORK_STEALING_POOL_H
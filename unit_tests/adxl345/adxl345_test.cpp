@@ -0,0 +1,109 @@
+#include "adxl345.h"
+#include "adxl345_regs.h"
+#include <cstdint>
+#include <gtest/gtest.h>
+
+// Simulated sensor, the driver talks to it through the host port
+class Adxl345Test : public ::testing::Test {
+protected:
+  adxl345_sim_t sim;
+  adxl345_handle_t dev{&sim};
+
+  void SetUp(void) override { adxl345_sim_init(&sim); }
+
+  // Feeds samples with distinct values, sample i is (i, -i, 256 + i)
+  void pushSamples(int first, int count) {
+    for(int i = first; i < first + count; i++) {
+      adxl345_sim_push(&sim, static_cast<int16_t>(i), static_cast<int16_t>(-i), static_cast<int16_t>(ADXL345_LSB_PER_G + i));
+    }
+  }
+};
+
+// -------------------------------------------------------------------------------
+// ---------------------------- ADXL345 driver test ------------------------------
+// -------------------------------------------------------------------------------
+TEST_F(Adxl345Test, InitTest) {
+  ASSERT_TRUE(adxl345_init(dev, ADXL345_WATERMARK));
+  EXPECT_EQ(sim.regs[ADXL345_REG_POWER_CTL], ADXL345_POWER_CTL_MEASURE);
+  EXPECT_EQ(sim.regs[ADXL345_REG_BW_RATE], ADXL345_BW_RATE_100HZ);
+  EXPECT_EQ(sim.regs[ADXL345_REG_DATA_FORMAT], ADXL345_DATA_FORMAT_FULL_RES | ADXL345_DATA_FORMAT_RANGE_4G);
+  EXPECT_EQ(sim.regs[ADXL345_REG_FIFO_CTL], ADXL345_FIFO_MODE_STREAM | ADXL345_WATERMARK);
+  EXPECT_EQ(sim.regs[ADXL345_REG_INT_ENABLE], ADXL345_INT_WATERMARK);
+  EXPECT_EQ(sim.regs[ADXL345_REG_INT_MAP], 0);
+  EXPECT_EQ(adxl345_fifo_entries(dev), 0);
+
+  // Wrong device on the bus
+  adxl345_sim_init(&sim);
+  sim.devid = 0x00;
+  EXPECT_FALSE(adxl345_init(dev, ADXL345_WATERMARK));
+  EXPECT_EQ(sim.regs[ADXL345_REG_POWER_CTL], 0);
+}
+
+TEST_F(Adxl345Test, WatermarkTest) {
+  ASSERT_TRUE(adxl345_init(dev, ADXL345_WATERMARK));
+  pushSamples(0, ADXL345_WATERMARK - 1);
+  EXPECT_FALSE(adxl345_sim_int1(&sim));
+  pushSamples(ADXL345_WATERMARK - 1, 1);
+  EXPECT_TRUE(adxl345_sim_int1(&sim));
+
+  // Draining the batch releases the interrupt line
+  adxl345_sample_t samples[ADXL345_FIFO_SIZE];
+  EXPECT_EQ(adxl345_read_fifo(dev, samples, ADXL345_FIFO_SIZE), static_cast<size_t>(ADXL345_WATERMARK));
+  EXPECT_FALSE(adxl345_sim_int1(&sim));
+  EXPECT_EQ(adxl345_fifo_entries(dev), 0);
+}
+
+TEST_F(Adxl345Test, BatchReadTest) {
+  ASSERT_TRUE(adxl345_init(dev, ADXL345_WATERMARK));
+  pushSamples(0, ADXL345_WATERMARK);
+  adxl345_sim_reset_stats(&sim);
+
+  // Oldest samples first, the values are sign extended from the little endian registers
+  adxl345_sample_t samples[ADXL345_FIFO_SIZE];
+  ASSERT_EQ(adxl345_read_fifo(dev, samples, ADXL345_FIFO_SIZE), static_cast<size_t>(ADXL345_WATERMARK));
+  for(int i = 0; i < ADXL345_WATERMARK; i++) {
+    EXPECT_EQ(samples[i].x, i);
+    EXPECT_EQ(samples[i].y, -i);
+    EXPECT_EQ(samples[i].z, ADXL345_LSB_PER_G + i);
+  }
+  // One status read and one multi-byte read of the data registers per entry, no per-register transfers
+  EXPECT_EQ(sim.transfers, 1u + ADXL345_WATERMARK);
+  EXPECT_EQ(sim.bytes_read, 1u + ADXL345_WATERMARK * ADXL345_SAMPLE_BYTES);
+
+  // Empty FIFO costs only the status read
+  adxl345_sim_reset_stats(&sim);
+  EXPECT_EQ(adxl345_read_fifo(dev, samples, ADXL345_FIFO_SIZE), 0u);
+  EXPECT_EQ(sim.transfers, 1u);
+}
+
+TEST_F(Adxl345Test, PartialReadTest) {
+  ASSERT_TRUE(adxl345_init(dev, ADXL345_WATERMARK));
+  pushSamples(0, 10);
+  adxl345_sample_t samples[4];
+  ASSERT_EQ(adxl345_read_fifo(dev, samples, 4), 4u);
+  EXPECT_EQ(samples[3].x, 3);
+  EXPECT_EQ(adxl345_fifo_entries(dev), 6);
+  ASSERT_EQ(adxl345_read_fifo(dev, samples, 4), 4u);
+  EXPECT_EQ(samples[0].x, 4);
+}
+
+TEST_F(Adxl345Test, OverrunTest) {
+  ASSERT_TRUE(adxl345_init(dev, ADXL345_WATERMARK));
+  // Stream mode keeps the newest 32 samples when the FIFO isn't drained in time
+  pushSamples(0, ADXL345_FIFO_SIZE + 8);
+  EXPECT_EQ(sim.overruns, 8u);
+  EXPECT_EQ(adxl345_fifo_entries(dev), ADXL345_FIFO_SIZE);
+  adxl345_sample_t samples[ADXL345_FIFO_SIZE];
+  ASSERT_EQ(adxl345_read_fifo(dev, samples, ADXL345_FIFO_SIZE), static_cast<size_t>(ADXL345_FIFO_SIZE));
+  EXPECT_EQ(samples[0].x, 8);
+  EXPECT_EQ(samples[ADXL345_FIFO_SIZE - 1].x, ADXL345_FIFO_SIZE + 7);
+}
+
+TEST_F(Adxl345Test, StandbyTest) {
+  // Samples aren't collected before the measurement mode
+  pushSamples(0, 5);
+  EXPECT_EQ(adxl345_fifo_entries(dev), 0);
+  ASSERT_TRUE(adxl345_init(dev, ADXL345_WATERMARK));
+  pushSamples(0, 5);
+  EXPECT_EQ(adxl345_fifo_entries(dev), 5);
+}
@@ -0,0 +1,142 @@
+#include "clock_counter.hpp"
+#include "clock_counter_config.hpp"
+#include "system_data.hpp"
+#include "system_data_config.hpp"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <tuple>
+
+using namespace pedometer;
+
+// Monotonic time of the tests in microseconds
+static constexpr uint64_t seconds(uint64_t value) { return value * CLOCK_US_PER_SECOND; }
+
+// Time in the system data
+static std::tuple<uint8_t, uint8_t, uint8_t> publishedTime(void) {
+  return SystemData::GetInstance().read<DATA_HOURS, DATA_MINUTES, DATA_SECONDS>();
+}
+
+class CountingObserver : public DataObserver {
+public:
+  int notifications = 0;
+  uint32_t lastFields = 0;
+  void onDataChanged(uint32_t fields) override {
+    notifications++;
+    lastFields = fields;
+  }
+};
+
+// -------------------------------------------------------------------------------
+// ------------------------- ClockCounter class unit test ------------------------
+// -------------------------------------------------------------------------------
+TEST(ClockCounterTest, InitializationTest) {
+  SystemData &data = SystemData::GetInstance();
+  data.init();
+  data.write<DATA_HOURS, DATA_MINUTES, DATA_SECONDS>(8, 15, 0);
+
+  // Clock continues from the time in the system data
+  ClockCounter &clock = ClockCounter::getInstance();
+  clock.init(seconds(3));
+  EXPECT_EQ(clock.getTime(seconds(3)), std::make_tuple(8, 15, 0));
+  EXPECT_EQ(clock.getTime(seconds(4) - 1), std::make_tuple(8, 15, 0));
+  EXPECT_EQ(clock.getTime(seconds(65)), std::make_tuple(8, 16, 2));
+  EXPECT_THROW(clock.init(seconds(3)), std::runtime_error);
+}
+
+TEST(ClockCounterTest, SetTimeTest) {
+  SystemData &data = SystemData::GetInstance();
+  data.init();
+  ClockCounter &clock = ClockCounter::getInstance();
+  clock.init(0);
+
+  // Time is published when it is set, the second boundaries follow the setting
+  clock.setTime(12, 34, 56, seconds(10) + 250000);
+  EXPECT_EQ(publishedTime(), std::make_tuple(12, 34, 56));
+  EXPECT_EQ(clock.getSecondsOfDay(seconds(10) + 250000), 12u * 3600 + 34 * 60 + 56);
+  EXPECT_EQ(clock.getTime(seconds(11) + 249999), std::make_tuple(12, 34, 56));
+  EXPECT_EQ(clock.getTime(seconds(11) + 250000), std::make_tuple(12, 34, 57));
+
+  EXPECT_THROW(clock.setTime(24, 0, 0, 0), std::out_of_range);
+  EXPECT_THROW(clock.setTime(0, 60, 0, 0), std::out_of_range);
+  EXPECT_THROW(clock.setTime(0, 0, 60, 0), std::out_of_range);
+  EXPECT_EQ(publishedTime(), std::make_tuple(12, 34, 56));
+}
+
+TEST(ClockCounterTest, UpdateTest) {
+  SystemData &data = SystemData::GetInstance();
+  data.init();
+  ClockCounter &clock = ClockCounter::getInstance();
+  clock.init(0);
+  clock.setTime(10, 0, 0, seconds(100));
+  CountingObserver observer;
+  data.subscribe(DATA_SECONDS, &observer);
+  data.subscribe(DATA_HOURS, &observer);
+
+  // Update returns the time to the next second boundary and notifies only when the time changes
+  EXPECT_EQ(clock.update(seconds(100) + 300000), 700000u);
+  EXPECT_EQ(observer.notifications, 0);
+  EXPECT_EQ(clock.update(seconds(101)), seconds(1));
+  EXPECT_EQ(observer.notifications, 1);
+  EXPECT_EQ(observer.lastFields, dataMask(DATA_SECONDS));
+  EXPECT_EQ(data.get<DATA_SECONDS>(), 1);
+
+  // Late or missed updates don't lose time
+  EXPECT_EQ(clock.update(seconds(100 + 3 * 3600 + 25) + 999999), 1u);
+  EXPECT_EQ(publishedTime(), std::make_tuple(13, 0, 25));
+  EXPECT_EQ(observer.notifications, 2);
+  EXPECT_EQ(observer.lastFields, dataMask(DATA_HOURS) | dataMask(DATA_SECONDS));
+  data.unsubscribe(DATA_SECONDS, &observer);
+  data.unsubscribe(DATA_HOURS, &observer);
+}
+
+TEST(ClockCounterTest, MidnightTest) {
+  SystemData &data = SystemData::GetInstance();
+  data.init();
+  ClockCounter &clock = ClockCounter::getInstance();
+  clock.init(0);
+  clock.setTime(23, 59, 59, seconds(5));
+  clock.update(seconds(6));
+  EXPECT_EQ(publishedTime(), std::make_tuple(0, 0, 0));
+
+  // Time of day wraps around after any number of days of uptime
+  EXPECT_EQ(clock.getTime(seconds(6 + 3 * CLOCK_SECONDS_PER_DAY + 61)), std::make_tuple(0, 1, 1));
+
+  // Time set before the current time of day is still ahead of the monotonic time
+  clock.setTime(0, 0, 0, seconds(2 * CLOCK_SECONDS_PER_DAY));
+  EXPECT_EQ(clock.getSecondsOfDay(seconds(2 * CLOCK_SECONDS_PER_DAY + 1)), 1u);
+}
+
+TEST(ClockCounterTest, MidnightResetsStepsTest) {
+  SystemData &data = SystemData::GetInstance();
+  data.init();
+  ClockCounter &clock = ClockCounter::getInstance();
+  clock.init(0);
+  clock.setTime(23, 0, 0, 0);
+  data.set<DATA_STEPS>(6000);
+  EXPECT_EQ(data.get<DATA_PACE>(), 6000u / (23 * 60));
+
+  // Steps of the day are kept until midnight
+  clock.update(seconds(3599));
+  EXPECT_EQ(data.get<DATA_STEPS>(), 6000u);
+
+  // The first update of the new day resets the steps, the pace starts again
+  clock.update(seconds(3600));
+  EXPECT_EQ(publishedTime(), std::make_tuple(0, 0, 0));
+  EXPECT_EQ(data.get<DATA_STEPS>(), 0u);
+  EXPECT_EQ(data.get<DATA_PACE>(), 0u);
+  data.add<DATA_STEPS>(120);
+  clock.update(seconds(3600 + 120));
+  EXPECT_EQ(data.get<DATA_PACE>(), 60u);
+
+  // A late update in the next day still resets the steps once
+  clock.update(seconds(3600 + CLOCK_SECONDS_PER_DAY + 5));
+  EXPECT_EQ(data.get<DATA_STEPS>(), 0u);
+  data.add<DATA_STEPS>(10);
+  clock.update(seconds(3600 + CLOCK_SECONDS_PER_DAY + 6));
+  EXPECT_EQ(data.get<DATA_STEPS>(), 10u);
+
+  // Setting the time, also back before midnight, doesn't start a new day
+  clock.setTime(23, 59, 0, seconds(3600 + CLOCK_SECONDS_PER_DAY + 7));
+  clock.setTime(0, 1, 0, seconds(3600 + CLOCK_SECONDS_PER_DAY + 8));
+  EXPECT_EQ(data.get<DATA_STEPS>(), 10u);
+}
@@ -0,0 +1,101 @@
+#include "event_loop.hpp"
+#include "event_loop_config.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <thread>
+
+using namespace pedometer;
+
+// Benchmark of the blocking event loop against the busy polled flag of the previous main loop. A timer thread posts an
+// event every EVENT_PERIOD_US, the main thread handles it. Idle time is the part of the wall time the main thread didn't
+// use the CPU. Build with -DCMAKE_BUILD_TYPE=Release to get meaningful numbers.
+
+enum : uint32_t { EVENTS = 500, EVENT_PERIOD_US = 2000 };
+
+// CPU time of the calling thread in microseconds
+static uint64_t threadCpuUs(void) {
+  timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return static_cast<uint64_t>(time.tv_sec) * 1000000 + time.tv_nsec / 1000;
+}
+
+struct Result {
+  uint64_t wallUs;
+  uint64_t cpuUs;
+  uint64_t latencyUs;
+  uint64_t maxLatencyUs;
+};
+
+static void report(const char *name, const Result &result) {
+  std::printf("%-12s idle %5.1f %%  latency avg %6.1f us  max %6llu us\n", name,
+              100.0 * static_cast<double>(result.wallUs - std::min(result.cpuUs, result.wallUs)) / static_cast<double>(result.wallUs),
+              static_cast<double>(result.latencyUs) / EVENTS, static_cast<unsigned long long>(result.maxLatencyUs));
+}
+
+// Posts the events in the timer thread, post() is called with the time of the post
+template <typename Post> static std::thread startTimer(Post post) {
+  return std::thread([post] {
+    for(uint32_t i = 0; i < EVENTS; i++) {
+      std::this_thread::sleep_for(std::chrono::microseconds(EVENT_PERIOD_US));
+      post(EventLoop::nowUs());
+    }
+  });
+}
+
+// Previous implementation: the timer sets a flag, the main loop polls it without blocking
+static Result pollFlag(void) {
+  static std::atomic<bool> tickFlag{false};
+  static std::atomic<uint64_t> postedUs{0};
+  Result result = {};
+  uint64_t startUs = EventLoop::nowUs();
+  uint64_t startCpuUs = threadCpuUs();
+  std::thread timer = startTimer([](uint64_t nowUs) {
+    postedUs.store(nowUs);
+    tickFlag.store(true);
+  });
+  for(uint32_t handled = 0; handled < EVENTS;) {
+    if(tickFlag) {
+      tickFlag.store(false);
+      uint64_t latencyUs = EventLoop::nowUs() - postedUs.load();
+      result.latencyUs += latencyUs;
+      result.maxLatencyUs = std::max(result.maxLatencyUs, latencyUs);
+      handled++;
+    }
+  }
+  result.cpuUs = threadCpuUs() - startCpuUs;
+  result.wallUs = EventLoop::nowUs() - startUs;
+  timer.join();
+  return result;
+}
+
+// Current implementation: the main loop blocks in EventLoop::dispatch()
+static Result eventLoop(void) {
+  EventLoop &eventLoop = EventLoop::GetInstance();
+  eventLoop.init();
+  uint64_t startUs = EventLoop::nowUs();
+  uint64_t startCpuUs = threadCpuUs();
+  std::thread timer = startTimer([&eventLoop](uint64_t) { eventLoop.post(EVENT_TIMER); });
+  for(uint32_t handled = 0; handled < EVENTS;) {
+    handled += (eventLoop.dispatch() & eventMask(EVENT_TIMER)) ? 1 : 0;
+  }
+  Result result = {};
+  result.cpuUs = threadCpuUs() - startCpuUs;
+  result.wallUs = EventLoop::nowUs() - startUs;
+  result.latencyUs = eventLoop.getStats().latencyUs;
+  result.maxLatencyUs = eventLoop.getStats().maxLatencyUs;
+  timer.join();
+  std::printf("event loop counters: idle %u %%, %u dispatches\n", static_cast<unsigned>(eventLoop.getStats().idlePercent()),
+              static_cast<unsigned>(eventLoop.getStats().dispatches));
+  return result;
+}
+
+int main(void) {
+  std::printf("%u events, one every %u us\n", static_cast<unsigned>(EVENTS), static_cast<unsigned>(EVENT_PERIOD_US));
+  report("busy flag", pollFlag());
+  report("event loop", eventLoop());
+  return 0;
+}
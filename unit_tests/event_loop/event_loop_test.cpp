@@ -0,0 +1,78 @@
+#include "event_loop.hpp"
+#include "event_loop_config.hpp"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace pedometer;
+
+// Handler recording the order of the dispatched events
+static std::vector<EventType> sDispatched;
+static void recordEvent(void *context) { sDispatched.push_back(*static_cast<EventType *>(context)); }
+
+// -------------------------------------------------------------------------------
+// -------------------------- EventLoop class unit test --------------------------
+// -------------------------------------------------------------------------------
+TEST(EventLoopTest, InitializationTest) {
+  EventLoop &eventLoop = EventLoop::GetInstance();
+  eventLoop.init();
+  EXPECT_THROW(eventLoop.init(), std::runtime_error);
+  EXPECT_THROW(eventLoop.setHandler(EVENT_TYPE_NUM, &recordEvent), std::invalid_argument);
+}
+
+TEST(EventLoopTest, DispatchTest) {
+  EventLoop &eventLoop = EventLoop::GetInstance();
+  eventLoop.init();
+  static EventType display = EVENT_DISPLAY, button = EVENT_BUTTON, accel = EVENT_ACCEL;
+  eventLoop.setHandler(EVENT_DISPLAY, &recordEvent, &display);
+  eventLoop.setHandler(EVENT_BUTTON, &recordEvent, &button);
+  eventLoop.setHandler(EVENT_ACCEL, &recordEvent, &accel);
+
+  // Nothing pending -> timeout
+  EXPECT_EQ(eventLoop.dispatch(0), 0u);
+  EXPECT_EQ(eventLoop.dispatch(1000), 0u);
+  EXPECT_TRUE(sDispatched.empty());
+
+  // Pending events are merged and dispatched once in the EventType order
+  eventLoop.post(EVENT_ACCEL);
+  eventLoop.post(EVENT_BUTTON);
+  eventLoop.post(EVENT_ACCEL);
+  eventLoop.post(EVENT_DISPLAY);
+  eventLoop.post(EVENT_TYPE_NUM);
+  EXPECT_EQ(eventLoop.dispatch(), eventMask(EVENT_DISPLAY) | eventMask(EVENT_BUTTON) | eventMask(EVENT_ACCEL));
+  EXPECT_EQ(sDispatched, (std::vector<EventType>{EVENT_DISPLAY, EVENT_BUTTON, EVENT_ACCEL}));
+  EXPECT_EQ(eventLoop.getStats().dispatches, 1u);
+  EXPECT_EQ(eventLoop.getStats().events, 3u);
+
+  // Events without a handler are only reported
+  eventLoop.post(EVENT_BLE);
+  EXPECT_EQ(eventLoop.dispatch(0), eventMask(EVENT_BLE));
+  EXPECT_EQ(sDispatched.size(), 3u);
+}
+
+TEST(EventLoopTest, WakeUpTest) {
+  enum : uint32_t { POSTS = 20, POST_PERIOD_US = 2000 };
+  EventLoop &eventLoop = EventLoop::GetInstance();
+  eventLoop.init();
+
+  // Another thread posts the events like a timer, the loop blocks between them
+  std::thread timer([&] {
+    for(uint32_t i = 0; i < POSTS; i++) {
+      std::this_thread::sleep_for(std::chrono::microseconds(POST_PERIOD_US));
+      eventLoop.post(EVENT_TIMER);
+    }
+  });
+  uint32_t events = 0;
+  while(events < POSTS) {
+    events += (eventLoop.dispatch() & eventMask(EVENT_TIMER)) ? 1 : 0;
+  }
+  timer.join();
+
+  const EventLoopStats &stats = eventLoop.getStats();
+  EXPECT_EQ(stats.events, POSTS);
+  EXPECT_GE(stats.idleUs, (POSTS - 1) * POST_PERIOD_US / 2);
+  EXPECT_GT(stats.idlePercent(), 50u);
+  EXPECT_LE(stats.latencyUs / stats.events, stats.maxLatencyUs);
+}
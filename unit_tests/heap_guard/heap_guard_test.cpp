@@ -0,0 +1,122 @@
+#include "clock_counter.hpp"
+#include "event_loop.hpp"
+#include "heap_guard.hpp"
+#include "menu.hpp"
+#include "oled_sh1106.h"
+#include "system_data.hpp"
+#include "timer_wheel.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <new>
+
+using namespace pedometer;
+
+enum : uint64_t { MS = 1000, SECOND = 1000 * MS };
+
+// The allocator hook of the host, every allocation of the test process is reported to the guard
+void *operator new(size_t size) {
+  HeapGuard::GetInstance().onAllocation(size);
+  if(void *ptr = std::malloc(0 == size ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+static void countEvent(void *context) { (*static_cast<uint32_t *>(context))++; }
+
+// Allocation the compiler can't elide: new expressions paired with delete may be removed in optimized builds
+static void *volatile sAllocation = nullptr;
+
+static void allocate(size_t size) {
+  sAllocation = ::operator new(size);
+  ::operator delete(sAllocation);
+}
+
+// -------------------------------------------------------------------------------
+// ------------------------- HeapGuard class unit test ---------------------------
+// -------------------------------------------------------------------------------
+TEST(HeapGuardTest, ArmTest) {
+  HeapGuard &guard = HeapGuard::GetInstance();
+  // Allocations before arming are allowed
+  allocate(sizeof(uint32_t));
+  EXPECT_FALSE(guard.isArmed());
+  EXPECT_EQ(guard.getViolations(), 0u);
+
+  guard.arm(false);
+  EXPECT_TRUE(guard.isArmed());
+  allocate(5 * sizeof(uint64_t));
+  EXPECT_EQ(guard.getViolations(), 1u);
+  EXPECT_EQ(guard.getLastViolationSize(), 5 * sizeof(uint64_t));
+
+  guard.disarm();
+  allocate(sizeof(uint32_t));
+  EXPECT_EQ(guard.getViolations(), 1u);
+
+  // Arming again starts a new count
+  guard.arm(false);
+  EXPECT_EQ(guard.getViolations(), 0u);
+  EXPECT_EQ(guard.getLastViolationSize(), 0u);
+  guard.disarm();
+}
+
+TEST(HeapGuardTest, AbortTest) {
+  EXPECT_DEATH(
+      {
+        HeapGuard::GetInstance().arm(true);
+        allocate(sizeof(uint32_t));
+      },
+      "");
+}
+
+TEST(HeapGuardTest, BudgetTest) {
+  static constexpr RamBudget WITHIN[] = {{"a", 10, 10}, {"b", 0, 1}};
+  static constexpr RamBudget OVER[] = {{"a", 10, 10}, {"b", 2, 1}};
+  static_assert(isWithinBudget(WITHIN), "Table should be within the budget.");
+  static_assert(!isWithinBudget(OVER), "Table should be over the budget.");
+  HeapGuard::report(OVER);
+}
+
+TEST(HeapGuardTest, SteadyStateTest) {
+  // Initialization in the order of app_main, allocations are allowed until the guard is armed
+  static oled_sim_t sim;
+  ext_spi_handle_t ext_spi{&sim};
+  uint64_t nowUs = 0;
+  uint32_t timerEvents = 0;
+  EventLoop &eventLoop = EventLoop::GetInstance();
+  eventLoop.init();
+  eventLoop.setHandler(EVENT_TIMER, &countEvent, &timerEvents);
+  TimerWheel &wheel = TimerWheel::GetInstance();
+  static uint32_t expiries = 0;
+  static ScheduledTimer periodic(&countEvent, &expiries);
+  wheel.start(periodic, nowUs, 100 * MS, 100 * MS);
+  SystemData::GetInstance().init();
+  ClockCounter::getInstance().init(nowUs);
+  oled_sim_init(&sim);
+  oled_init(ext_spi);
+  oled_async_start(ext_spi, nullptr, nullptr);
+  Menu::GetInstance().init();
+
+  HeapGuard &guard = HeapGuard::GetInstance();
+  guard.arm(false);
+
+  // Ten minutes of the main loop with a step every 10 ms, the periodic timer fires at 100 ms steps before the end
+  for(nowUs = 0; nowUs < 600 * SECOND; nowUs += 10 * MS) {
+    SystemData::GetInstance().add<DATA_STEPS>(1);
+    ClockCounter::getInstance().update(nowUs);
+    if(wheel.advance(nowUs) > 0) {
+      eventLoop.post(EVENT_TIMER);
+    }
+    eventLoop.dispatch(0);
+    Menu::GetInstance().update(nowUs);
+  }
+  guard.disarm();
+
+  EXPECT_EQ(guard.getViolations(), 0u) << "last allocation of " << guard.getLastViolationSize() << " bytes";
+  EXPECT_EQ(expiries, 5999u);
+  EXPECT_EQ(timerEvents, 5999u);
+}
@@ -0,0 +1,98 @@
+#include "menu.hpp"
+#include "menu_pages.hpp"
+#include "oled_sh1106.h"
+#include "system_data.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+#include <variant>
+
+using namespace pedometer;
+
+// Benchmark of the page dispatch: std::visit on the page layouts against the dynamic_cast chain on the page objects it
+// replaced, and of a whole menu action drawn into the simulated controller.
+// Build with -DCMAKE_BUILD_TYPE=Release to get meaningful numbers.
+
+enum : uint32_t { BENCH_ITERATIONS = 1000000, BENCH_ACTIONS = 20000 };
+
+// Previous dispatch: the active page is found in the page map and cast to every page class until the cast succeeds
+class Page {
+public:
+  uint8_t mSelected = INITIAL_SELECTION;
+  uint8_t mOptionNum = 2;
+  virtual ~Page() = default;
+};
+
+class LinkPage : public Page {};
+
+class ParamPage : public Page {};
+
+static constexpr PageItem BENCH_LINK_ITEMS[] = {linkItem("A", 3, MAIN_PAGE), linkItem("B", 4, MAIN_PAGE)};
+static constexpr PageItem BENCH_PARAM_ITEMS[] = {paramItem("STEPS", 3, DATA_STEPS), paramItem("TARGET", 4, DATA_TARGET_STEPS)};
+static constexpr PageLayout BENCH_LAYOUT[PAGE_NUM] = {linkPageLayout(BENCH_LINK_ITEMS), paramPageLayout(BENCH_PARAM_ITEMS, MAIN_PAGE)};
+
+// Keeps the compiler from removing the dispatched work
+static volatile uint32_t sSink = 0;
+
+template <typename F> static double nsPerCall(uint32_t iterations, F &&call) {
+  auto start = std::chrono::steady_clock::now();
+  for(uint32_t i = 0; i < iterations; i++) {
+    call(i);
+  }
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+}
+
+static double dynamicCastDispatch(void) {
+  Page *pages[PAGE_NUM] = {new LinkPage(), new ParamPage()};
+  double ns = nsPerCall(BENCH_ITERATIONS, [&](uint32_t i) {
+    Page *page = pages[sSink % PAGE_NUM];
+    if(LinkPage *links = dynamic_cast<LinkPage *>(page)) {
+      links->mSelected = (links->mSelected + 1) % links->mOptionNum;
+      sSink = sSink + links->mSelected + i;
+    } else if(ParamPage *params = dynamic_cast<ParamPage *>(page)) {
+      sSink = sSink + params->mSelected + i;
+    }
+  });
+  for(Page *page : pages) {
+    delete page;
+  }
+  return ns;
+}
+
+static double visitDispatch(void) {
+  uint8_t selected = INITIAL_SELECTION;
+  return nsPerCall(BENCH_ITERATIONS, [&](uint32_t i) {
+    std::visit(
+        [&](const auto &page) {
+          if constexpr(std::is_same_v<std::decay_t<decltype(page)>, LinkPageLayout>) {
+            selected = (selected + 1) % page.content.optionNum;
+            sSink = sSink + selected + i;
+          } else {
+            sSink = sSink + page.content.optionNum + i;
+          }
+        },
+        BENCH_LAYOUT[sSink % PAGE_NUM]);
+  });
+}
+
+int main() {
+  std::printf("%-32s %12s\n", "dispatch", "[ns]");
+  std::printf("%-32s %12.2f\n", "dynamic_cast chain", dynamicCastDispatch());
+  std::printf("%-32s %12.2f\n", "std::visit", visitDispatch());
+
+  // Whole action: dispatch, background copy, values and the transfer of the changed pages
+  oled_sim_t sim;
+  oled_sim_init(&sim);
+  ext_spi_handle_t ext_spi{&sim};
+  oled_init(ext_spi);
+  oled_async_start(ext_spi, nullptr, nullptr);
+  SystemData::GetInstance().init();
+  Menu::GetInstance().init();
+  double ns = nsPerCall(BENCH_ACTIONS, [&](uint32_t i) {
+    Menu::GetInstance().action((i & 1) ? MENU_ACTION_UP : MENU_ACTION_DOWN);
+  });
+  std::printf("%-32s %12.2f\n", "Menu::action with rendering", ns);
+  return 0;
+}
@@ -0,0 +1,249 @@
+#include "menu.hpp"
+#include "menu_pages.hpp"
+#include "oled_sh1106.h"
+#include "oled_sh1106_font.h"
+#include "system_data.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <new>
+#include <string>
+
+using namespace pedometer;
+
+// Simulated display controller, the menu draws through the host port of the driver
+static oled_sim_t sim;
+static ext_spi_handle_t ext_spi{&sim};
+
+static void initDisplay(void) {
+  oled_sim_init(&sim);
+  oled_init(ext_spi);
+  oled_async_start(ext_spi, nullptr, nullptr);
+}
+
+// Checks that the text is shown on the panel at the given position
+static ::testing::AssertionResult isShown(const std::string &text, uint8_t page, uint8_t col) {
+  uint8_t frame[OLED_NUM_PAGES][OLED_WIDTH];
+  oled_sim_get_frame(&sim, frame);
+  for(size_t i = 0; i < text.length(); i++) {
+    const uint8_t *glyph = oled_basic_font_lut[oled_basic_font_glyph(text[i])].c;
+    if(0 != std::memcmp(&frame[page][col + i * OLED_BASIC_FONT_COLS], glyph, OLED_BASIC_FONT_COLS)) {
+      return ::testing::AssertionFailure() << "'" << text[i] << "' of \"" << text << "\" not found at page " << int(page) << ", col "
+                                           << int(col + i * OLED_BASIC_FONT_COLS);
+    }
+  }
+  return ::testing::AssertionSuccess();
+}
+
+// The cursor shares the column with the left border, only its columns right of the border are compared
+static bool isCursorAt(uint8_t page) {
+  enum : uint8_t { FIRST_COL = 3 };
+  uint8_t frame[OLED_NUM_PAGES][OLED_WIDTH];
+  oled_sim_get_frame(&sim, frame);
+  const uint8_t *glyph = oled_basic_font_lut[oled_basic_font_glyph('<')].c;
+  return 0 == std::memcmp(&frame[page][OLED_BASIC_FONT_START_COL + FIRST_COL], &glyph[FIRST_COL], OLED_BASIC_FONT_COLS - FIRST_COL);
+}
+
+// Counts the heap allocations of the whole test process
+static size_t sAllocations = 0;
+
+void *operator new(size_t size) {
+  sAllocations++;
+  if(void *ptr = std::malloc(0 == size ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+// -------------------------------------------------------------------------------
+// ---------------------------------- Menu test ----------------------------------
+// -------------------------------------------------------------------------------
+TEST(MenuTest, InitDrawsMainPage) {
+  SystemData::GetInstance().init();
+  SystemData::GetInstance().setData(static_cast<uint32_t>(1234), DATA_STEPS);
+  initDisplay();
+  Menu::GetInstance().init();
+  oled_sim_dump_pbm(&sim, "menu_main_page.pbm");
+
+  EXPECT_TRUE(isShown("PEDOMETER", 1, 28));
+  EXPECT_TRUE(isShown("CONFIG", 3, OLED_BASIC_FONT_START_COL_OFFSET));
+  EXPECT_TRUE(isShown("1234", 5, OLED_BASIC_FONT_START_COL_OFFSET));
+  EXPECT_TRUE(isShown("STEPS:", 5, 72));
+  EXPECT_TRUE(isShown("1000", 6, OLED_BASIC_FONT_START_COL_OFFSET));
+  // Single link -> no cursor
+  EXPECT_FALSE(isCursorAt(3));
+  // Border
+  EXPECT_TRUE(oled_sim_get_pixel(&sim, 2, 2));
+  EXPECT_TRUE(oled_sim_get_pixel(&sim, 125, 61));
+  EXPECT_TRUE(oled_sim_get_pixel(&sim, 125, 50));
+  EXPECT_FALSE(oled_sim_get_pixel(&sim, 1, 1));
+
+  EXPECT_THROW(Menu::GetInstance().init(), std::runtime_error);
+}
+
+TEST(MenuTest, NavigationBetweenPages) {
+  SystemData::GetInstance().init();
+  initDisplay();
+  Menu::GetInstance().init();
+
+  Menu::GetInstance().action(MENU_ACTION_ENTER);
+  oled_sim_dump_pbm(&sim, "menu_config_page.pbm");
+  EXPECT_TRUE(isShown("CONFIG", 1, 40));
+  EXPECT_TRUE(isShown("BACK", 3, OLED_BASIC_FONT_START_COL_OFFSET));
+  EXPECT_TRUE(isShown("BACK 2", 4, OLED_BASIC_FONT_START_COL_OFFSET));
+  EXPECT_TRUE(isCursorAt(3));
+
+  // Links are selected in a loop
+  Menu::GetInstance().action(MENU_ACTION_DOWN);
+  EXPECT_TRUE(isCursorAt(4));
+  EXPECT_FALSE(isCursorAt(3));
+  Menu::GetInstance().action(MENU_ACTION_UP);
+  EXPECT_TRUE(isCursorAt(3));
+  // The left border column stays visible next to the cursor
+  EXPECT_TRUE(oled_sim_get_pixel(&sim, 2, 24));
+
+  Menu::GetInstance().action(MENU_ACTION_ENTER);
+  EXPECT_TRUE(isShown("PEDOMETER", 1, 28));
+}
+
+TEST(MenuTest, RedrawSendsOnlyChangedData) {
+  SystemData::GetInstance().init();
+  SystemData::GetInstance().setData(static_cast<uint32_t>(1234), DATA_STEPS);
+  initDisplay();
+  Menu::GetInstance().init();
+
+  oled_sim_reset_stats(&sim);
+  SystemData::GetInstance().setData(static_cast<uint32_t>(1235), DATA_STEPS);
+  // Single link on the main page -> the selection doesn't change, only the data is updated
+  Menu::GetInstance().action(MENU_ACTION_UP);
+
+  EXPECT_TRUE(isShown("1235", 5, OLED_BASIC_FONT_START_COL_OFFSET));
+  // One cursor burst and one data burst within the last digit
+  EXPECT_EQ(sim.transfers, 2u);
+  EXPECT_LE(sim.data_bytes, static_cast<uint32_t>(OLED_BASIC_FONT_COLS));
+}
+
+TEST(MenuTest, BackgroundIsCachedBetweenFrames) {
+  SystemData::GetInstance().init();
+  initDisplay();
+  Menu::GetInstance().init();
+  EXPECT_EQ(Menu::GetInstance().getDrawStats(MAIN_PAGE).backgroundBuilds, 1u);
+  EXPECT_EQ(Menu::GetInstance().getDrawStats(MAIN_PAGE).cachedFrames, 0u);
+
+  for(uint32_t steps = 1; steps <= 10; steps++) {
+    SystemData::GetInstance().setData(steps, DATA_STEPS);
+    Menu::GetInstance().action(MENU_ACTION_UP);
+  }
+  EXPECT_EQ(Menu::GetInstance().getDrawStats(MAIN_PAGE).backgroundBuilds, 1u);
+  EXPECT_EQ(Menu::GetInstance().getDrawStats(MAIN_PAGE).cachedFrames, 10u);
+  // Static objects and the dynamic overlay are both shown
+  EXPECT_TRUE(isShown("PEDOMETER", 1, 28));
+  EXPECT_TRUE(isShown("STEPS:", 5, 72));
+  EXPECT_TRUE(isShown("10", 5, OLED_BASIC_FONT_START_COL_OFFSET));
+  EXPECT_TRUE(oled_sim_get_pixel(&sim, 2, 2));
+
+  // Another page owns the background now, the main page is rasterized again when it is shown
+  Menu::GetInstance().action(MENU_ACTION_ENTER);
+  EXPECT_EQ(Menu::GetInstance().getDrawStats(CONFIG_PAGE).backgroundBuilds, 1u);
+  // Cursor movement changes the background
+  Menu::GetInstance().action(MENU_ACTION_DOWN);
+  EXPECT_EQ(Menu::GetInstance().getDrawStats(CONFIG_PAGE).backgroundBuilds, 2u);
+  EXPECT_TRUE(isCursorAt(4));
+  Menu::GetInstance().action(MENU_ACTION_ENTER);
+  EXPECT_EQ(Menu::GetInstance().getDrawStats(MAIN_PAGE).backgroundBuilds, 2u);
+  EXPECT_TRUE(isShown("PEDOMETER", 1, 28));
+  EXPECT_FALSE(isCursorAt(4));
+}
+
+// Number of redraw requests of the menu
+static int sRedrawRequests = 0;
+static void countRedrawRequest(void) { sRedrawRequests++; }
+
+TEST(MenuTest, SchedulerRedrawsOnlyChangedWidgets) {
+  SystemData::GetInstance().init();
+  initDisplay();
+  Menu::GetInstance().init();
+  Menu::GetInstance().setRedrawRequest(&countRedrawRequest);
+  uint64_t nowUs = MENU_FRAME_PERIOD_US;
+
+  // Nothing changed -> no frame
+  EXPECT_FALSE(Menu::GetInstance().update(nowUs));
+  EXPECT_EQ(Menu::GetInstance().getFrameDelayUs(nowUs), MENU_NO_FRAME);
+
+  // Data field of a widget on the page changes -> only the widget is sent
+  oled_sim_reset_stats(&sim);
+  SystemData::GetInstance().setData(static_cast<uint32_t>(98765), DATA_STEPS);
+  EXPECT_EQ(sRedrawRequests, 1);
+  EXPECT_EQ(Menu::GetInstance().getFrameDelayUs(nowUs), 0u);
+  EXPECT_TRUE(Menu::GetInstance().update(nowUs));
+  EXPECT_TRUE(isShown("98765", 5, OLED_BASIC_FONT_START_COL_OFFSET));
+  EXPECT_EQ(sim.transfers, 2u);
+  EXPECT_LE(sim.data_bytes, 5u * OLED_BASIC_FONT_COLS);
+  EXPECT_EQ(Menu::GetInstance().getDrawStats(MAIN_PAGE).backgroundBuilds, 1u);
+
+  // Frame rate is capped, the change is drawn in the next frame period
+  SystemData::GetInstance().setData(static_cast<uint32_t>(7), DATA_STEPS);
+  EXPECT_EQ(Menu::GetInstance().getFrameDelayUs(nowUs + 1), MENU_FRAME_PERIOD_US - 1u);
+  EXPECT_FALSE(Menu::GetInstance().update(nowUs + MENU_FRAME_PERIOD_US - 1));
+  EXPECT_TRUE(Menu::GetInstance().update(nowUs + MENU_FRAME_PERIOD_US));
+  // Shorter text -> the rest of the previous value is replaced by the background
+  EXPECT_TRUE(isShown("7    ", 5, OLED_BASIC_FONT_START_COL_OFFSET));
+  EXPECT_TRUE(isShown("STEPS:", 5, 72));
+
+  // Fields not shown on the page don't cause redraws
+  SystemData::GetInstance().changeValue(DATA_MINUTES, SYSTEM_INCREASE_VAL);
+  EXPECT_EQ(sRedrawRequests, 2);
+  EXPECT_EQ(Menu::GetInstance().getFrameDelayUs(nowUs + 2 * MENU_FRAME_PERIOD_US), MENU_NO_FRAME);
+  EXPECT_FALSE(Menu::GetInstance().update(nowUs + 2 * MENU_FRAME_PERIOD_US));
+}
+
+// Number of frames sent by the display
+static int sFramesDone = 0;
+static void countFrameDone(void *) { sFramesDone++; }
+
+TEST(MenuTest, PendingFrameWaitsForDisplay) {
+  SystemData::GetInstance().init();
+  initDisplay();
+  oled_async_start(ext_spi, &countFrameDone, nullptr);
+  Menu::GetInstance().init();
+  EXPECT_EQ(sFramesDone, 1);
+  EXPECT_FALSE(Menu::GetInstance().isFramePending());
+  uint64_t nowUs = MENU_FRAME_PERIOD_US;
+
+  // The previous frame is still being sent -> the new frame is drawn, but waits for the display
+  sim.frame_in_flight = true;
+  SystemData::GetInstance().setData(static_cast<uint32_t>(555), DATA_STEPS);
+  EXPECT_FALSE(Menu::GetInstance().update(nowUs));
+  EXPECT_TRUE(Menu::GetInstance().isFramePending());
+  EXPECT_FALSE(isShown("555", 5, OLED_BASIC_FONT_START_COL_OFFSET));
+  // The task doesn't poll the display, the frame done callback requests the redraw
+  EXPECT_EQ(Menu::GetInstance().getFrameDelayUs(nowUs + 1), MENU_NO_FRAME);
+  EXPECT_FALSE(Menu::GetInstance().update(nowUs + 1));
+
+  // Display is free -> the pending frame is published at once, even within the frame period
+  sim.frame_in_flight = false;
+  EXPECT_TRUE(Menu::GetInstance().update(nowUs + 2));
+  EXPECT_FALSE(Menu::GetInstance().isFramePending());
+  EXPECT_TRUE(isShown("555", 5, OLED_BASIC_FONT_START_COL_OFFSET));
+  EXPECT_EQ(sFramesDone, 2);
+}
+
+TEST(MenuTest, BootDoesNotAllocate) {
+  SystemData::GetInstance().init();
+  initDisplay();
+
+  // Pages are constant layouts, the menu and its observer subscriptions live in static memory
+  size_t allocations = sAllocations;
+  Menu::GetInstance().init();
+  Menu::GetInstance().action(MENU_ACTION_ENTER);
+  Menu::GetInstance().action(MENU_ACTION_DOWN);
+  SystemData::GetInstance().setData(static_cast<uint32_t>(4321), DATA_STEPS);
+  Menu::GetInstance().action(MENU_ACTION_ENTER);
+  Menu::GetInstance().update(MENU_FRAME_PERIOD_US);
+  EXPECT_EQ(sAllocations, allocations);
+  EXPECT_TRUE(isShown("4321", 5, OLED_BASIC_FONT_START_COL_OFFSET));
+}
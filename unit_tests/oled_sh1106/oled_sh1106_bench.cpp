@@ -0,0 +1,87 @@
+#include "oled_sh1106.h"
+#include "oled_sh1106_font.h"
+#include "oled_sh1106_gfx.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// Benchmark of the raster primitives against the per-pixel rasterization they replaced, and of the frame transfer
+// through the simulated controller.
+// Build with -DCMAKE_BUILD_TYPE=Release to get meaningful numbers.
+
+enum : uint32_t { BENCH_ITERATIONS = 20000 };
+
+// Previous implementation: every pixel is put separately with oled_put_point()
+static void putRectByPoints(oled_rect_t rect) {
+  if(OLED_SHAPE_FILLED == rect.fill) {
+    for(uint8_t col = rect.orig_x; col <= rect.end_x; col++) {
+      for(uint8_t row = rect.orig_y; row <= rect.end_y; row++) {
+        oled_put_point(oled_point_t{col, row, rect.color});
+      }
+    }
+  } else {
+    for(uint8_t col = rect.orig_x; col <= rect.end_x; col++) {
+      oled_put_point(oled_point_t{col, rect.orig_y, rect.color});
+      oled_put_point(oled_point_t{col, rect.end_y, rect.color});
+    }
+    for(uint8_t row = rect.orig_y; row <= rect.end_y; row++) {
+      oled_put_point(oled_point_t{rect.orig_x, row, rect.color});
+      oled_put_point(oled_point_t{rect.end_x, row, rect.color});
+    }
+  }
+}
+
+template <typename F> static double nsPerCall(F &&draw) {
+  auto start = std::chrono::steady_clock::now();
+  for(uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    draw();
+  }
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / BENCH_ITERATIONS;
+}
+
+static void report(const char *name, oled_rect_t rect) {
+  double points = nsPerCall([&] { putRectByPoints(rect); });
+  double spans = nsPerCall([&] { oled_put_rect(rect); });
+  std::printf("%-32s %12.1f %12.1f %9.1fx\n", name, points, spans, points / spans);
+}
+
+// Menu-like frame: border and a step counter that changes in every frame
+static void drawFrame(uint32_t steps) {
+  char text[12];
+  std::snprintf(text, sizeof(text), "%05u", static_cast<unsigned>(steps % 100000));
+  oled_clear_buf();
+  oled_put_string(text, 5, 8, OLED_BASIC_FONT_ID);
+  oled_put_rect(oled_rect_t{2, 2, 125, 61, OLED_COLOR_WHITE, OLED_SHAPE_NOT_FILLED});
+}
+
+static void reportRender(const char *name, void (*render)(ext_spi_handle_t)) {
+  oled_sim_t sim;
+  oled_sim_init(&sim);
+  ext_spi_handle_t ext_spi{&sim};
+  drawFrame(0);
+  oled_render(ext_spi);
+  oled_sim_reset_stats(&sim);
+  uint32_t steps = 0;
+  double ns = nsPerCall([&] {
+    drawFrame(++steps);
+    render(ext_spi);
+  });
+  std::printf("%-32s %12.1f %12.1f %12.1f\n", name, ns, static_cast<double>(sim.transfers) / BENCH_ITERATIONS,
+              static_cast<double>(sim.cmd_bytes + sim.data_bytes) / BENCH_ITERATIONS);
+}
+
+int main() {
+  const oled_attributes_t attr = oled_get_attributes();
+  std::printf("%-32s %12s %12s %10s\n", "shape", "points [ns]", "spans [ns]", "speedup");
+  // Border drawn on every menu page
+  report("menu border 2,2 - 125,61", oled_rect_t{2, 2, static_cast<uint8_t>(attr.last_col - 2), static_cast<uint8_t>(attr.last_row - 2),
+                                                OLED_COLOR_WHITE, OLED_SHAPE_NOT_FILLED});
+  report("filled 128x64", oled_rect_t{0, 0, attr.last_col, attr.last_row, OLED_COLOR_WHITE, OLED_SHAPE_FILLED});
+  report("filled 40x13 (unaligned)", oled_rect_t{10, 3, 49, 15, OLED_COLOR_BLACK, OLED_SHAPE_FILLED});
+
+  std::printf("\n%-32s %12s %12s %12s\n", "frame update", "time [ns]", "bursts", "bytes");
+  reportRender("oled_render", oled_render);
+  reportRender("oled_render_dirty", oled_render_dirty);
+  return 0;
+}
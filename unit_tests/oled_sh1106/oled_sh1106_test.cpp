@@ -0,0 +1,285 @@
+#include "oled_sh1106.h"
+#include "oled_sh1106_fb.h"
+#include "oled_sh1106_font.h"
+#include "oled_sh1106_gfx.h"
+#include <cstdio>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+// Reference rasterization: every pixel of the area is put separately
+static void putAreaByPoints(uint8_t firstCol, uint8_t lastCol, uint8_t firstRow, uint8_t lastRow, bool color) {
+  for(uint8_t col = firstCol; col <= lastCol; col++) {
+    for(uint8_t row = firstRow; row <= lastRow; row++) {
+      oled_put_point(oled_point_t{col, row, color});
+    }
+  }
+}
+
+static std::vector<uint8_t> snapshot(void) { return std::vector<uint8_t>(&oled_buf[0][0], &oled_buf[0][0] + sizeof(oled_buf)); }
+
+// Fills the video buffer with a pattern, so both colors are visible in the result
+static void fillPattern(void) {
+  for(uint8_t page = 0; page < OLED_NUM_PAGES; page++) {
+    for(uint8_t col = 0; col < OLED_WIDTH; col++) {
+      oled_buf[page][col] = static_cast<uint8_t>(0xA5 ^ (col * 7) ^ page);
+    }
+  }
+}
+
+// -------------------------------------------------------------------------------
+// --------------------------- Raster primitives test ----------------------------
+// -------------------------------------------------------------------------------
+TEST(OledRasterTest, VLineMatchesPoints) {
+  for(bool color : {true, false}) {
+    for(uint8_t y = 0; y < OLED_HEIGHT; y++) {
+      for(uint8_t len = 1; y + len <= OLED_HEIGHT; len += 3) {
+        fillPattern();
+        putAreaByPoints(17, 17, y, y + len - 1, color);
+        std::vector<uint8_t> expected = snapshot();
+
+        fillPattern();
+        oled_put_vline(oled_line_t{17, y, len, color});
+        EXPECT_EQ(snapshot(), expected) << "y=" << int(y) << " len=" << int(len);
+      }
+    }
+  }
+}
+
+TEST(OledRasterTest, HLineMatchesPoints) {
+  for(bool color : {true, false}) {
+    for(uint8_t y = 0; y < OLED_HEIGHT; y += 5) {
+      fillPattern();
+      putAreaByPoints(3, 120, y, y, color);
+      std::vector<uint8_t> expected = snapshot();
+
+      fillPattern();
+      oled_put_hline(oled_line_t{3, y, 118, color});
+      EXPECT_EQ(snapshot(), expected) << "y=" << int(y);
+    }
+  }
+}
+
+TEST(OledRasterTest, RectMatchesPoints) {
+  std::mt19937 rng(1234);
+  for(int i = 0; i < 500; i++) {
+    uint8_t x0 = rng() % OLED_WIDTH, x1 = rng() % OLED_WIDTH;
+    uint8_t y0 = rng() % OLED_HEIGHT, y1 = rng() % OLED_HEIGHT;
+    oled_rect_t rect{std::min(x0, x1), std::min(y0, y1), std::max(x0, x1), std::max(y0, y1), static_cast<bool>(rng() % 2),
+                     static_cast<bool>(rng() % 2)};
+
+    fillPattern();
+    if(OLED_SHAPE_FILLED == rect.fill) {
+      putAreaByPoints(rect.orig_x, rect.end_x, rect.orig_y, rect.end_y, rect.color);
+    } else {
+      putAreaByPoints(rect.orig_x, rect.end_x, rect.orig_y, rect.orig_y, rect.color);
+      putAreaByPoints(rect.orig_x, rect.end_x, rect.end_y, rect.end_y, rect.color);
+      putAreaByPoints(rect.orig_x, rect.orig_x, rect.orig_y, rect.end_y, rect.color);
+      putAreaByPoints(rect.end_x, rect.end_x, rect.orig_y, rect.end_y, rect.color);
+    }
+    std::vector<uint8_t> expected = snapshot();
+
+    fillPattern();
+    oled_put_rect(rect);
+    EXPECT_EQ(snapshot(), expected) << "rect " << int(rect.orig_x) << "," << int(rect.orig_y) << " - " << int(rect.end_x) << ","
+                                    << int(rect.end_y);
+  }
+}
+
+// -------------------------------------------------------------------------------
+// ---------------------------- Dirty tracking test ------------------------------
+// -------------------------------------------------------------------------------
+TEST(OledDirtyTest, PrimitivesMarkTouchedColumns) {
+  oled_mark_clean(oled_dirty);
+  oled_put_vline(oled_line_t{40, 5, 20, OLED_COLOR_WHITE});
+  for(uint8_t page = 0; page < OLED_NUM_PAGES; page++) {
+    if(page <= 3) {
+      EXPECT_EQ(oled_dirty[page].min_col, 40);
+      EXPECT_EQ(oled_dirty[page].max_col, 40);
+    } else {
+      EXPECT_GT(oled_dirty[page].min_col, oled_dirty[page].max_col);
+    }
+  }
+
+  oled_mark_clean(oled_dirty);
+  oled_put_string("STEPS", 5, 72, OLED_BASIC_FONT_ID);
+  EXPECT_EQ(oled_dirty[5].min_col, 72);
+  EXPECT_EQ(oled_dirty[5].max_col, 72 + 5 * OLED_BASIC_FONT_COLS - 1);
+}
+
+// -------------------------------------------------------------------------------
+// ---------------------------------- Font test ----------------------------------
+// -------------------------------------------------------------------------------
+TEST(OledFontTest, GlyphLookup) {
+  EXPECT_EQ(oled_basic_font_glyph('A'), OLED_BASIC_GLYPH_LETTER_A);
+  EXPECT_EQ(oled_basic_font_glyph('9'), OLED_BASIC_GLYPH_DIGIT_9);
+  EXPECT_EQ(oled_basic_font_glyph(' '), OLED_BASIC_GLYPH_SPACE);
+  // Characters missing in the font are replaced
+  EXPECT_EQ(oled_basic_font_glyph('a'), OLED_BASIC_GLYPH_REPLACEMENT);
+  EXPECT_EQ(oled_basic_font_glyph(static_cast<char>(0xC4)), OLED_BASIC_GLYPH_REPLACEMENT);
+}
+
+TEST(OledFontTest, StringMatchesChars) {
+  oled_clear_buf();
+  oled_put_string_n("AB1?", 4, 2, 16, OLED_BASIC_FONT_ID);
+  std::vector<uint8_t> expected(&oled_buf[2][16], &oled_buf[2][16] + 4 * OLED_BASIC_FONT_COLS);
+
+  oled_clear_buf();
+  oled_put_char('A', 2, 16, OLED_BASIC_FONT_ID);
+  oled_put_char('B', 2, 24, OLED_BASIC_FONT_ID);
+  oled_put_char('1', 2, 32, OLED_BASIC_FONT_ID);
+  oled_put_char('?', 2, 40, OLED_BASIC_FONT_ID);
+  EXPECT_EQ(std::vector<uint8_t>(&oled_buf[2][16], &oled_buf[2][16] + 4 * OLED_BASIC_FONT_COLS), expected);
+  EXPECT_EQ(0, std::memcmp(&oled_buf[2][40], &oled_basic_font_lut[OLED_BASIC_GLYPH_REPLACEMENT], OLED_BASIC_FONT_COLS));
+}
+
+// -------------------------------------------------------------------------------
+// ------------------------- Rendering (simulated display) -----------------------
+// -------------------------------------------------------------------------------
+static std::vector<uint8_t> panel(const oled_sim_t &sim) {
+  uint8_t frame[OLED_NUM_PAGES][OLED_WIDTH];
+  oled_sim_get_frame(&sim, frame);
+  return std::vector<uint8_t>(&frame[0][0], &frame[0][0] + sizeof(frame));
+}
+
+TEST(OledRenderTest, InitConfiguresDisplay) {
+  oled_sim_t sim;
+  oled_sim_init(&sim);
+  oled_init(ext_spi_handle_t{&sim});
+  EXPECT_EQ(sim.resets, 1u);
+  EXPECT_TRUE(sim.display_on);
+  EXPECT_FALSE(sim.inverted);
+  EXPECT_EQ(sim.contrast, 0xBF);
+  EXPECT_EQ(panel(sim), snapshot());
+
+  oled_sleep(ext_spi_handle_t{&sim});
+  EXPECT_FALSE(sim.display_on);
+  oled_wakeup(ext_spi_handle_t{&sim});
+  EXPECT_TRUE(sim.display_on);
+}
+
+TEST(OledRenderTest, RenderCopiesVideoBuffer) {
+  oled_sim_t sim;
+  oled_sim_init(&sim);
+  ext_spi_handle_t ext_spi{&sim};
+  fillPattern();
+  oled_render(ext_spi);
+  EXPECT_EQ(panel(sim), snapshot());
+  // Columns outside of the panel aren't written
+  EXPECT_EQ(sim.ram[0][0], 0);
+  EXPECT_EQ(sim.ram[7][OLED_SIM_RAM_COLS - 1], 0);
+  // One cursor burst and one data burst per page
+  EXPECT_EQ(sim.transfers, 2u * OLED_NUM_PAGES);
+  EXPECT_EQ(sim.data_bytes, static_cast<uint32_t>(OLED_NUM_PAGES * OLED_WIDTH));
+}
+
+TEST(OledRenderTest, RenderDirtySendsOnlyChanges) {
+  oled_sim_t sim;
+  oled_sim_init(&sim);
+  ext_spi_handle_t ext_spi{&sim};
+  oled_clear_buf();
+  oled_put_string("STEPS 1234", 5, 8, OLED_BASIC_FONT_ID);
+  oled_render(ext_spi);
+
+  oled_sim_reset_stats(&sim);
+  // Same content drawn again -> nothing is sent
+  oled_clear_buf();
+  oled_put_string("STEPS 1234", 5, 8, OLED_BASIC_FONT_ID);
+  oled_render_dirty(ext_spi);
+  EXPECT_EQ(sim.transfers, 0u);
+
+  // Only the last digit changes
+  oled_put_char('5', 5, 8 + 9 * OLED_BASIC_FONT_COLS, OLED_BASIC_FONT_ID);
+  oled_render_dirty(ext_spi);
+  EXPECT_EQ(panel(sim), snapshot());
+  EXPECT_EQ(sim.transfers, 2u);
+  EXPECT_LE(sim.data_bytes, static_cast<uint32_t>(OLED_BASIC_FONT_COLS));
+}
+
+// Number of frames reported by the frame done callback
+static int sFramesDone = 0;
+static void countFrameDone(void *arg) { (*static_cast<int *>(arg))++; }
+
+TEST(OledRenderTest, SwapBuffersPublishesChanges) {
+  oled_sim_t sim;
+  oled_sim_init(&sim);
+  ext_spi_handle_t ext_spi{&sim};
+  oled_clear_buf();
+  oled_render(ext_spi);
+  oled_async_start(ext_spi, &countFrameDone, &sFramesDone);
+
+  // Frame in flight -> nothing is published, the changes stay in the back buffer
+  oled_sim_reset_stats(&sim);
+  sim.frame_in_flight = true;
+  oled_put_string("1234", 2, 8, OLED_BASIC_FONT_ID);
+  EXPECT_FALSE(oled_swap_buffers());
+  EXPECT_EQ(sim.transfers, 0u);
+  EXPECT_EQ(sFramesDone, 0);
+
+  sim.frame_in_flight = false;
+  EXPECT_TRUE(oled_swap_buffers());
+  EXPECT_EQ(panel(sim), snapshot());
+  EXPECT_EQ(sim.transfers, 2u);
+  EXPECT_EQ(sFramesDone, 1);
+
+  // Nothing changed -> no frame
+  EXPECT_TRUE(oled_swap_buffers());
+  EXPECT_EQ(sim.transfers, 2u);
+  EXPECT_EQ(sFramesDone, 1);
+}
+
+TEST(OledRenderTest, DumpPbm) {
+  oled_sim_t sim;
+  oled_sim_init(&sim);
+  ext_spi_handle_t ext_spi{&sim};
+  oled_init(ext_spi);
+  oled_clear_buf();
+  oled_put_point(oled_point_t{0, 0, OLED_COLOR_WHITE});
+  oled_put_point(oled_point_t{9, 1, OLED_COLOR_WHITE});
+  oled_render(ext_spi);
+  ASSERT_TRUE(oled_sim_dump_pbm(&sim, "oled_render_test.pbm"));
+
+  FILE *file = std::fopen("oled_render_test.pbm", "rb");
+  ASSERT_NE(file, nullptr);
+  char data[64];
+  size_t len = std::fread(data, 1, sizeof(data), file);
+  std::fclose(file);
+  const std::string header = "P4\n128 64\n";
+  ASSERT_GE(len, header.length() + 2 * OLED_WIDTH / 8);
+  EXPECT_EQ(std::string(data, header.length()), header);
+  const uint8_t *rows = reinterpret_cast<const uint8_t *>(data) + header.length();
+  // Lit pixels are written as 0 (white), the rest as 1 (black)
+  EXPECT_EQ(rows[0], 0x7F);
+  EXPECT_EQ(rows[OLED_WIDTH / 8 + 1], 0xBF);
+}
+
+TEST(OledBitmapTest, GetAndPutRoundTrip) {
+  std::vector<uint8_t> bitmap(OLED_BITMAP_LEN);
+  fillPattern();
+  oled_get_bitmap(bitmap.data());
+  EXPECT_EQ(bitmap, snapshot());
+
+  oled_clear_buf();
+  oled_mark_clean(oled_dirty);
+  oled_put_bitmap(bitmap.data());
+  EXPECT_EQ(snapshot(), bitmap);
+  for(uint8_t page = 0; page < OLED_NUM_PAGES; page++) {
+    EXPECT_EQ(oled_dirty[page].min_col, 0);
+    EXPECT_EQ(oled_dirty[page].max_col, OLED_WIDTH - 1);
+  }
+}
+
+TEST(OledBitmapTest, PutSpan) {
+  std::vector<uint8_t> bitmap(OLED_BITMAP_LEN, 0x5A);
+  oled_clear_buf();
+  oled_mark_clean(oled_dirty);
+  oled_put_bitmap_span(bitmap.data(), 3, 10, 17);
+  for(uint8_t col = 0; col < OLED_WIDTH; col++) {
+    EXPECT_EQ(oled_buf[3][col], (col >= 10 && col <= 17) ? 0x5A : 0x00) << "col " << int(col);
+  }
+  EXPECT_EQ(oled_dirty[3].min_col, 10);
+  EXPECT_EQ(oled_dirty[3].max_col, 17);
+  EXPECT_GT(oled_dirty[2].min_col, oled_dirty[2].max_col);
+}
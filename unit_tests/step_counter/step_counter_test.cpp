@@ -0,0 +1,161 @@
+#include "step_counter.hpp"
+#include "step_counter_config.hpp"
+#include "step_detector.hpp"
+#include "system_data.hpp"
+#include <cmath>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace pedometer;
+
+enum : uint32_t { SAMPLE_RATE_HZ = 100, LSB_PER_G = 256 };
+
+struct Sample {
+  int16_t x;
+  int16_t y;
+  int16_t z;
+};
+
+static_assert(0 == isqrt(0) && 1 == isqrt(3) && 2 == isqrt(4) && 65535 == isqrt(UINT32_MAX), "isqrt doesn't round down.");
+
+// Walking: gravity split between y and z, one swing of the magnitude per step and white noise
+static std::vector<Sample> walk(double seconds, double cadenceHz, double amplitudeG, double noiseG, uint32_t seed) {
+  std::mt19937 random(seed);
+  std::normal_distribution<double> noise(0.0, noiseG * LSB_PER_G);
+  std::vector<Sample> samples;
+  for(uint32_t i = 0; i < seconds * SAMPLE_RATE_HZ; i++) {
+    double t = static_cast<double>(i) / SAMPLE_RATE_HZ;
+    double swing = amplitudeG * LSB_PER_G * std::sin(2 * M_PI * cadenceHz * t);
+    samples.push_back(Sample{static_cast<int16_t>(std::lround(noise(random))),
+                             static_cast<int16_t>(std::lround(0.6 * (LSB_PER_G + swing) + noise(random))),
+                             static_cast<int16_t>(std::lround(0.8 * (LSB_PER_G + swing) + noise(random)))});
+  }
+  return samples;
+}
+
+// Processes the samples in batches of the FIFO watermark size
+static uint32_t countSteps(StepDetector &detector, const std::vector<Sample> &samples, size_t batch = 25) {
+  uint32_t steps = 0;
+  for(size_t i = 0; i < samples.size(); i += batch) {
+    steps += detector.process(&samples[i], std::min(batch, samples.size() - i));
+  }
+  return steps;
+}
+
+// -------------------------------------------------------------------------------
+// ------------------------- Integer magnitude unit test -------------------------
+// -------------------------------------------------------------------------------
+TEST(MagnitudeTest, IsqrtTest) {
+  std::mt19937 random(1);
+  for(uint32_t i = 0; i < 100000; i++) {
+    uint32_t value = (i < 70000) ? i : random();
+    uint32_t root = isqrt(value);
+    EXPECT_LE(static_cast<uint64_t>(root) * root, value);
+    EXPECT_GT(static_cast<uint64_t>(root + 1) * (root + 1), value);
+  }
+}
+
+TEST(MagnitudeTest, AlphaMaxBetaMinTest) {
+  std::mt19937 random(2);
+  std::uniform_int_distribution<int> axis(-2048, 2047);
+  for(uint32_t i = 0; i < 100000; i++) {
+    int16_t x = static_cast<int16_t>(axis(random)), y = static_cast<int16_t>(axis(random)), z = static_cast<int16_t>(axis(random));
+    double exact = std::sqrt(static_cast<double>(x * x + y * y + z * z));
+    EXPECT_NEAR(alphaMaxBetaMin(x, y, z), exact, 0.09 * exact + 1) << x << " " << y << " " << z;
+  }
+  // Axis order doesn't matter
+  EXPECT_EQ(alphaMaxBetaMin(100, -30, 7), alphaMaxBetaMin(-7, 30, -100));
+}
+
+// -------------------------------------------------------------------------------
+// ------------------------ StepDetector class unit test -------------------------
+// -------------------------------------------------------------------------------
+TEST(StepDetectorTest, WalkingTest) {
+  for(MagnitudeMethod method : {MAGNITUDE_ISQRT, MAGNITUDE_ALPHA_MAX_BETA_MIN}) {
+    StepDetectorParams params;
+    params.magnitude = method;
+    // Slow, normal and fast walking for a minute each
+    for(double cadence : {1.2, 1.8, 2.6}) {
+      StepDetector detector(params);
+      uint32_t steps = countSteps(detector, walk(60, cadence, 0.25, 0.02, 3));
+      EXPECT_NEAR(steps, 60 * cadence, 2) << "method " << int(method) << ", cadence " << cadence;
+    }
+  }
+}
+
+TEST(StepDetectorTest, RestTest) {
+  // Sensor noise and a tilt of the device aren't steps
+  StepDetector detector;
+  std::vector<Sample> rest = walk(60, 0, 0, 0.02, 4);
+  for(size_t i = rest.size() / 2; i < rest.size(); i++) {
+    rest[i] = Sample{static_cast<int16_t>(rest[i].x + 180), static_cast<int16_t>(rest[i].y - 60), static_cast<int16_t>(rest[i].z - 80)};
+  }
+  EXPECT_LE(countSteps(detector, rest), 1u);
+}
+
+TEST(StepDetectorTest, MinIntervalTest) {
+  // Vibration at 8 Hz is limited to one step per minimum interval
+  StepDetectorParams params;
+  params.lowPassShift = 1;
+  StepDetector detector(params);
+  uint32_t steps = countSteps(detector, walk(10, 8, 0.5, 0, 5));
+  EXPECT_LE(steps, 10u * SAMPLE_RATE_HZ / params.minInterval);
+}
+
+TEST(StepDetectorTest, ReentrancyTest) {
+  // Interleaved instances count the same as separate runs, the detector has no shared state
+  std::vector<Sample> slow = walk(30, 1.5, 0.25, 0.02, 6);
+  std::vector<Sample> fast = walk(30, 2.2, 0.3, 0.02, 7);
+  StepDetector slowAlone, fastAlone, slowInterleaved, fastInterleaved;
+  uint32_t slowSteps = countSteps(slowAlone, slow);
+  uint32_t fastSteps = countSteps(fastAlone, fast);
+  uint32_t slowInterleavedSteps = 0, fastInterleavedSteps = 0;
+  for(size_t i = 0; i < slow.size(); i += 10) {
+    slowInterleavedSteps += slowInterleaved.process(&slow[i], 10);
+    fastInterleavedSteps += fastInterleaved.process(&fast[i], 10);
+  }
+  EXPECT_EQ(slowInterleavedSteps, slowSteps);
+  EXPECT_EQ(fastInterleavedSteps, fastSteps);
+
+  // Reset starts over
+  slowAlone.reset();
+  EXPECT_EQ(countSteps(slowAlone, slow), slowSteps);
+}
+
+TEST(StepDetectorTest, ParamsTest) {
+  StepDetectorParams params;
+  EXPECT_TRUE(params.isValid());
+  params.highPassShift = params.lowPassShift;
+  EXPECT_THROW(StepDetector{params}, std::invalid_argument);
+  params = StepDetectorParams();
+  params.minInterval = 0;
+  EXPECT_THROW(StepDetector{params}, std::invalid_argument);
+}
+
+// -------------------------------------------------------------------------------
+// ------------------------- StepCounter class unit test -------------------------
+// -------------------------------------------------------------------------------
+TEST(StepCounterTest, DataStepsTest) {
+  SystemData &data = SystemData::GetInstance();
+  data.init();
+  StepCounter &counter = StepCounter::GetInstance();
+  counter.init();
+  EXPECT_THROW(counter.init(), std::runtime_error);
+
+  std::vector<Sample> samples = walk(20, 2, 0.25, 0.02, 8);
+  uint32_t steps = 0;
+  for(size_t i = 0; i < samples.size(); i += 25) {
+    steps += counter.process(&samples[i], 25);
+  }
+  EXPECT_NEAR(steps, 40, 2);
+  EXPECT_EQ(data.get<DATA_STEPS>(), steps);
+
+  const StepCounterStats &stats = counter.getStats();
+  EXPECT_EQ(stats.samples, samples.size());
+  EXPECT_EQ(stats.steps, steps);
+  EXPECT_EQ(stats.batches, samples.size() / 25);
+  EXPECT_GE(stats.cycles, stats.maxBatchCycles);
+}
@@ -0,0 +1,157 @@
+#include "system_data.hpp"
+#include "system_data_config.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <variant>
+
+using namespace pedometer;
+
+// Benchmark of the flat SystemData storage against the map of variant parameters it replaced.
+// Build with -DCMAKE_BUILD_TYPE=Release to get meaningful numbers.
+// The flat storage is no longer the faster one: since its values became atomics protected by the sequence lock, every
+// write enters the critical section and bumps the versions, so get, set and change cost more than in the map. It is
+// kept for the consistent lock-free reads, the smaller footprint and the absence of heap allocations.
+
+enum : uint32_t { BENCH_ITERATIONS = 1000000 };
+
+// Heap usage of the process
+static size_t sAllocations = 0;
+static size_t sAllocatedBytes = 0;
+
+void *operator new(size_t size) {
+  sAllocations++;
+  sAllocatedBytes += size;
+  if(void *ptr = std::malloc(0 == size ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+using Value = std::variant<uint8_t, uint32_t, bool>;
+
+// Keeps the compiler from removing the work
+static volatile uint32_t sSink = 0;
+
+// Previous implementation: value and limits stored as variants, fields found in std::map
+class MapParam {
+public:
+  Value mValue, mMin, mMax;
+
+  MapParam(Value value, Value min, Value max) : mValue(std::clamp(value, min, max)), mMin(min), mMax(max) {}
+
+  Value getValue(void) const { return mValue; }
+
+  void increaseValue(void) {
+    if(std::holds_alternative<uint8_t>(mValue)) {
+      mValue = std::clamp(static_cast<uint8_t>(std::get<uint8_t>(mValue) + 1), std::get<uint8_t>(mMin), std::get<uint8_t>(mMax));
+    } else if(std::holds_alternative<uint32_t>(mValue)) {
+      mValue = std::clamp(static_cast<uint32_t>(std::get<uint32_t>(mValue) + 1), std::get<uint32_t>(mMin), std::get<uint32_t>(mMax));
+    }
+  }
+};
+
+class MapData {
+public:
+  std::map<DataField, MapParam> mData;
+
+  void init(void) {
+    mData.insert({DATA_STEPS, MapParam(static_cast<uint32_t>(0), static_cast<uint32_t>(0), static_cast<uint32_t>(SYSTEM_DATA_SCHEMA[DATA_STEPS].max))});
+    mData.insert({DATA_TARGET_STEPS, MapParam(static_cast<uint32_t>(1000), static_cast<uint32_t>(100), static_cast<uint32_t>(99999))});
+    mData.insert({DATA_HOURS, MapParam(static_cast<uint8_t>(0), static_cast<uint8_t>(0), static_cast<uint8_t>(23))});
+    mData.insert({DATA_MINUTES, MapParam(static_cast<uint8_t>(0), static_cast<uint8_t>(0), static_cast<uint8_t>(59))});
+    mData.insert({DATA_SECONDS, MapParam(static_cast<uint8_t>(0), static_cast<uint8_t>(0), static_cast<uint8_t>(59))});
+  }
+
+  Value getData(DataField dataField) const {
+    auto data = mData.find(dataField);
+    if(std::holds_alternative<uint8_t>(data->second.getValue())) {
+      return std::get<uint8_t>(data->second.getValue());
+    } else if(std::holds_alternative<uint32_t>(data->second.getValue())) {
+      return std::get<uint32_t>(data->second.getValue());
+    }
+    return std::get<bool>(data->second.getValue());
+  }
+
+  // Both writes compare the previous value to notify observers only about changes
+  void setData(Value value, DataField dataField) {
+    auto data = mData.find(dataField);
+    Value previous = data->second.getValue();
+    if(std::holds_alternative<uint8_t>(data->second.getValue())) {
+      data->second.mValue = std::clamp(Value(std::get<uint8_t>(value)), data->second.mMin, data->second.mMax);
+    } else if(std::holds_alternative<uint32_t>(data->second.getValue())) {
+      data->second.mValue = std::clamp(Value(std::get<uint32_t>(value)), data->second.mMin, data->second.mMax);
+    }
+    sSink = sSink + (previous != data->second.getValue());
+  }
+
+  void changeValue(DataField dataField) {
+    auto data = mData.find(dataField);
+    Value previous = data->second.getValue();
+    data->second.increaseValue();
+    sSink = sSink + (previous != data->second.getValue());
+  }
+};
+
+template <typename F> static double nsPerCall(F &&call) {
+  auto start = std::chrono::steady_clock::now();
+  for(uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+    call(i);
+  }
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / BENCH_ITERATIONS;
+}
+
+// Only the stored fields, the map has no derived fields and the derived fields can't be set
+static DataField field(uint32_t i) { return static_cast<DataField>(i % DATA_FIRST_DERIVED); }
+
+// Value of the type of the field in the schema
+static Value value(uint32_t i) {
+  switch(SYSTEM_DATA_SCHEMA[field(i)].type) {
+  case PARAM_UINT8:
+    return static_cast<uint8_t>(i);
+  case PARAM_UINT32:
+    return i;
+  default:
+    return static_cast<bool>(i & 1);
+  }
+}
+
+template <typename Data> static void report(const char *name, Data &data, size_t bytes, size_t allocations) {
+  double get = nsPerCall([&](uint32_t i) { sSink = sSink + std::visit([](auto raw) { return static_cast<uint32_t>(raw); }, data.getData(field(i))); });
+  double set = nsPerCall([&](uint32_t i) { data.setData(value(i), field(i)); });
+  double change = nsPerCall([&](uint32_t i) {
+    if constexpr(std::is_same_v<Data, MapData>) {
+      data.changeValue(field(i));
+    } else {
+      data.changeValue(field(i), SYSTEM_INCREASE_VAL);
+    }
+  });
+  std::printf("%-16s %10.2f %10.2f %10.2f %10zu %12zu\n", name, get, set, change, bytes, allocations);
+}
+
+int main() {
+  std::printf("%-16s %10s %10s %10s %10s %12s\n", "storage", "get [ns]", "set [ns]", "change [ns]", "bytes", "allocations");
+
+  // Storage of the fields: the map container plus its heap, the whole SystemData object (values, sequence, versions,
+  // memoized derived values and observers)
+  size_t allocations = sAllocations;
+  size_t bytes = sAllocatedBytes;
+  MapData mapData;
+  mapData.init();
+  report("std::map", mapData, sizeof(std::map<DataField, MapParam>) + sAllocatedBytes - bytes, sAllocations - allocations);
+
+  allocations = sAllocations;
+  SystemData &flatData = SystemData::GetInstance();
+  flatData.init();
+  report("flat array", flatData, sizeof(SystemData), sAllocations - allocations);
+  return 0;
+}
@@ -1,6 +1,10 @@
 #include "system_data.hpp"
 #include "system_data_config.hpp"
+#include <atomic>
 #include <gtest/gtest.h>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 using namespace pedometer;
 
@@ -118,11 +122,11 @@ TEST(SystemDataTest, InitializationTest) {
   data.init();
 
   // Checking default initailization data
-  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_STEPS_DEFAULT);
-  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_TARGET_STEPS)), SYSTEM_TARGET_STEPS_DEFAULT);
-  EXPECT_EQ(std::get<uint8_t>(data.getData(DATA_HOURS)), SYSTEM_HOURS_DEFAULT);
-  EXPECT_EQ(std::get<uint8_t>(data.getData(DATA_MINUTES)), SYSTEM_MINUTES_DEFAULT);
-  EXPECT_EQ(std::get<uint8_t>(data.getData(DATA_SECONDS)), SYSTEM_SECONDS_DEFAULT);
+  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_DATA_SCHEMA[DATA_STEPS].def);
+  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_TARGET_STEPS)), SYSTEM_DATA_SCHEMA[DATA_TARGET_STEPS].def);
+  EXPECT_EQ(std::get<uint8_t>(data.getData(DATA_HOURS)), SYSTEM_DATA_SCHEMA[DATA_HOURS].def);
+  EXPECT_EQ(std::get<uint8_t>(data.getData(DATA_MINUTES)), SYSTEM_DATA_SCHEMA[DATA_MINUTES].def);
+  EXPECT_EQ(std::get<uint8_t>(data.getData(DATA_SECONDS)), SYSTEM_DATA_SCHEMA[DATA_SECONDS].def);
 
   // Initialization should be performed only once
   EXPECT_THROW(data.init(), std::runtime_error);
@@ -147,6 +151,11 @@ TEST(SystemDataTest, SetAndGetDataTest) {
 
   data.setData(static_cast<uint8_t>(50), DATA_SECONDS);
   EXPECT_EQ(std::get<uint8_t>(data.getData(DATA_SECONDS)), 50);
+
+  // Fields out of the DataField range and values of another type are rejected
+  EXPECT_THROW(data.getData(DATA_FIELD_NUM), std::invalid_argument);
+  EXPECT_THROW(data.setData(static_cast<uint32_t>(5), DATA_SECONDS), std::invalid_argument);
+  EXPECT_EQ(std::get<uint8_t>(data.getData(DATA_SECONDS)), 50);
 }
 
 TEST(SystemDataTest, ChangeValueAndClampingTest) {
@@ -154,18 +163,292 @@ TEST(SystemDataTest, ChangeValueAndClampingTest) {
   data.init();
 
   // Decreasing value with clamping
-  data.setData(static_cast<uint32_t>(SYSTEM_STEPS_MIN + 1), DATA_STEPS);
-  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_STEPS_MIN + 1);
+  data.setData(static_cast<uint32_t>(SYSTEM_DATA_SCHEMA[DATA_STEPS].min + 1), DATA_STEPS);
+  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_DATA_SCHEMA[DATA_STEPS].min + 1);
   data.changeValue(DATA_STEPS, SYSTEM_DECREASE_VAL);
-  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_STEPS_MIN);
+  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_DATA_SCHEMA[DATA_STEPS].min);
   data.changeValue(DATA_STEPS, SYSTEM_DECREASE_VAL);
-  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_STEPS_MIN);
+  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_DATA_SCHEMA[DATA_STEPS].min);
 
   // Increasing value with clamping
-  data.setData(static_cast<uint32_t>(SYSTEM_STEPS_MAX - 1), DATA_STEPS);
-  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_STEPS_MAX - 1);
+  data.setData(static_cast<uint32_t>(SYSTEM_DATA_SCHEMA[DATA_STEPS].max - 1), DATA_STEPS);
+  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_DATA_SCHEMA[DATA_STEPS].max - 1);
   data.changeValue(DATA_STEPS, SYSTEM_INCREASE_VAL);
-  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_STEPS_MAX);
+  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_DATA_SCHEMA[DATA_STEPS].max);
   data.changeValue(DATA_STEPS, SYSTEM_INCREASE_VAL);
-  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_STEPS_MAX);
+  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_STEPS)), SYSTEM_DATA_SCHEMA[DATA_STEPS].max);
+}
+
+TEST(SystemDataTest, TypedAccessorsTest) {
+  SystemData &data = SystemData::GetInstance();
+  data.init();
+
+  // Types are taken from the schema at compile time
+  static_assert(std::is_same_v<decltype(data.get<DATA_STEPS>()), uint32_t>);
+  static_assert(std::is_same_v<decltype(data.get<DATA_SECONDS>()), uint8_t>);
+  EXPECT_EQ(data.get<DATA_TARGET_STEPS>(), SYSTEM_DATA_SCHEMA[DATA_TARGET_STEPS].def);
+
+  // Typed and variant accessors share the storage
+  data.set<DATA_HOURS>(12);
+  EXPECT_EQ(std::get<uint8_t>(data.getData(DATA_HOURS)), 12);
+  data.setData(static_cast<uint32_t>(4321), DATA_STEPS);
+  EXPECT_EQ(data.get<DATA_STEPS>(), 4321u);
+
+  // Values are clamped to the schema limits
+  data.set<DATA_HOURS>(30);
+  EXPECT_EQ(data.get<DATA_HOURS>(), SYSTEM_DATA_SCHEMA[DATA_HOURS].max);
+  data.set<DATA_TARGET_STEPS>(0);
+  EXPECT_EQ(data.get<DATA_TARGET_STEPS>(), SYSTEM_DATA_SCHEMA[DATA_TARGET_STEPS].min);
+}
+
+// -------------------------------------------------------------------------------
+// ------------------------- SystemData observers unit test ----------------------
+// -------------------------------------------------------------------------------
+class CountingObserver : public DataObserver {
+public:
+  int notifications = 0;
+  uint32_t lastFields = 0;
+  void onDataChanged(uint32_t fields) override {
+    notifications++;
+    lastFields = fields;
+  }
+};
+
+TEST(SystemDataTest, ObserversTest) {
+  SystemData &data = SystemData::GetInstance();
+  data.init();
+  CountingObserver steps, minutes;
+  data.subscribe(DATA_STEPS, &steps);
+  data.subscribe(DATA_MINUTES, &minutes);
+
+  // Only observers of the changed field are notified
+  data.setData(static_cast<uint32_t>(10), DATA_STEPS);
+  EXPECT_EQ(steps.notifications, 1);
+  EXPECT_EQ(minutes.notifications, 0);
+  data.changeValue(DATA_MINUTES, SYSTEM_INCREASE_VAL);
+  EXPECT_EQ(minutes.notifications, 1);
+  EXPECT_EQ(minutes.lastFields, dataMask(DATA_MINUTES));
+
+  // Writes that don't change the value aren't notified
+  data.setData(static_cast<uint32_t>(10), DATA_STEPS);
+  data.setData(static_cast<uint32_t>(SYSTEM_DATA_SCHEMA[DATA_STEPS].max), DATA_STEPS);
+  data.changeValue(DATA_STEPS, SYSTEM_INCREASE_VAL);
+  EXPECT_EQ(steps.notifications, 2);
+
+  data.unsubscribe(DATA_STEPS, &steps);
+  data.changeValue(DATA_STEPS, SYSTEM_DECREASE_VAL);
+  EXPECT_EQ(steps.notifications, 2);
+  data.unsubscribe(DATA_MINUTES, &minutes);
+
+  // Observers are kept in a fixed array
+  CountingObserver observers[SYSTEM_MAX_OBSERVERS];
+  for(CountingObserver &observer : observers) {
+    data.subscribe(DATA_HOURS, &observer);
+  }
+  EXPECT_THROW(data.subscribe(DATA_HOURS, &steps), std::length_error);
+  data.unsubscribe(DATA_HOURS, &observers[0]);
+  data.changeValue(DATA_HOURS, SYSTEM_INCREASE_VAL);
+  EXPECT_EQ(observers[0].notifications, 0);
+  EXPECT_EQ(observers[SYSTEM_MAX_OBSERVERS - 1].notifications, 1);
+}
+
+TEST(SystemDataTest, SnapshotAndTransactionTest) {
+  SystemData &data = SystemData::GetInstance();
+  data.init();
+  CountingObserver clock;
+  data.subscribe(DATA_HOURS, &clock);
+  data.subscribe(DATA_MINUTES, &clock);
+  data.subscribe(DATA_SECONDS, &clock);
+  data.write<DATA_HOURS, DATA_MINUTES, DATA_SECONDS>(23, 59, 59);
+  EXPECT_EQ(clock.notifications, 1);
+
+  // Snapshot contains only the requested fields
+  DataSnapshot snapshot = data.snapshot(dataMask(DATA_HOURS) | dataMask(DATA_SECONDS));
+  EXPECT_EQ(snapshot.getFields(), dataMask(DATA_HOURS) | dataMask(DATA_SECONDS));
+  EXPECT_EQ(snapshot.get<DATA_HOURS>(), 23);
+  EXPECT_EQ(snapshot.get<DATA_SECONDS>(), 59);
+
+  // Staged values aren't visible before the commit
+  DataTransaction rollover = data.transaction();
+  rollover.set<DATA_HOURS>(0).set<DATA_MINUTES>(0).set<DATA_SECONDS>(0);
+  EXPECT_EQ(rollover.get<DATA_MINUTES>(), 0);
+  EXPECT_EQ(data.get<DATA_MINUTES>(), 59);
+  EXPECT_EQ(clock.notifications, 1);
+
+  // Commit publishes all fields with one notification
+  EXPECT_EQ(rollover.commit(), dataMask(DATA_HOURS) | dataMask(DATA_MINUTES) | dataMask(DATA_SECONDS));
+  EXPECT_EQ(clock.notifications, 2);
+  EXPECT_EQ(clock.lastFields, dataMask(DATA_HOURS) | dataMask(DATA_MINUTES) | dataMask(DATA_SECONDS));
+  snapshot = data.snapshot();
+  EXPECT_EQ(snapshot.get<DATA_HOURS>(), 0);
+  EXPECT_EQ(snapshot.get<DATA_MINUTES>(), 0);
+  EXPECT_EQ(snapshot.get<DATA_SECONDS>(), 0);
+  EXPECT_EQ(snapshot.get<DATA_TARGET_STEPS>(), SYSTEM_DATA_SCHEMA[DATA_TARGET_STEPS].def);
+
+  // Unchanged fields aren't notified, staged values are clamped
+  DataTransaction update = data.transaction();
+  EXPECT_EQ(update.set<DATA_HOURS>(0).set<DATA_MINUTES>(75).commit(), dataMask(DATA_MINUTES));
+  EXPECT_EQ(clock.lastFields, dataMask(DATA_MINUTES));
+  EXPECT_EQ(data.get<DATA_MINUTES>(), SYSTEM_DATA_SCHEMA[DATA_MINUTES].max);
+  EXPECT_EQ(update.commit(), 0u);
+  EXPECT_EQ(clock.notifications, 3);
+
+  data.unsubscribe(DATA_HOURS, &clock);
+  data.unsubscribe(DATA_MINUTES, &clock);
+  data.unsubscribe(DATA_SECONDS, &clock);
+}
+
+// -------------------------------------------------------------------------------
+// ------------------------ SystemData concurrency unit test ---------------------
+// -------------------------------------------------------------------------------
+TEST(SystemDataTest, VersionsTest) {
+  SystemData &data = SystemData::GetInstance();
+  data.init();
+  DataChangeTracker display(data);
+  DataChangeTracker storage(data);
+  uint32_t version = data.getVersion();
+  EXPECT_EQ(display.peek(), 0u);
+
+  // Version is increased only by writes that change a value
+  data.set<DATA_STEPS>(SYSTEM_DATA_SCHEMA[DATA_STEPS].def);
+  EXPECT_EQ(data.getVersion(), version);
+  data.set<DATA_STEPS>(10);
+  EXPECT_EQ(data.getVersion(), version + 1);
+  EXPECT_EQ(data.getFieldVersion(DATA_STEPS), version + 1);
+  EXPECT_EQ(data.changedSince(version), withDerived(dataMask(DATA_STEPS)));
+  EXPECT_EQ(data.changedSince(version + 1), 0u);
+  EXPECT_THROW(data.getFieldVersion(DATA_FIELD_NUM), std::invalid_argument);
+
+  // Transaction changes all its fields in one version
+  data.transaction().set<DATA_HOURS>(5).set<DATA_MINUTES>(30).commit();
+  EXPECT_EQ(data.getVersion(), version + 2);
+  EXPECT_EQ(data.getFieldVersion(DATA_HOURS), data.getFieldVersion(DATA_MINUTES));
+  EXPECT_EQ(data.changedSince(version + 1), dataMask(DATA_HOURS) | dataMask(DATA_MINUTES) | dataMask(DATA_PACE));
+  DataSnapshot snapshot = data.snapshot();
+  EXPECT_EQ(snapshot.getVersion(), version + 2);
+
+  // Peek keeps the dirty fields, poll clears them only for its own consumer
+  uint32_t dirty = withDerived(dataMask(DATA_STEPS) | dataMask(DATA_HOURS) | dataMask(DATA_MINUTES));
+  EXPECT_EQ(display.peek(), dirty);
+  EXPECT_EQ(display.poll(), dirty);
+  EXPECT_EQ(display.poll(), 0u);
+  EXPECT_EQ(storage.peek(), dirty);
+  data.add<DATA_STEPS>(1);
+  EXPECT_EQ(display.poll(), withDerived(dataMask(DATA_STEPS)));
+  EXPECT_EQ(storage.poll(), dirty);
+  EXPECT_EQ(storage.poll(), 0u);
+  EXPECT_EQ(snapshot.getVersion() + 1, data.getVersion());
+}
+
+TEST(SystemDataTest, DerivedFieldsTest) {
+  SystemData &data = SystemData::GetInstance();
+  data.init();
+  EXPECT_EQ(data.get<DATA_GOAL_PERCENT>(), 0u);
+  EXPECT_EQ(data.get<DATA_REMAINING_STEPS>(), SYSTEM_DATA_SCHEMA[DATA_TARGET_STEPS].def);
+
+  // Derived fields follow their inputs
+  data.write<DATA_STEPS, DATA_TARGET_STEPS>(250, 1000);
+  EXPECT_EQ(data.get<DATA_GOAL_PERCENT>(), 25u);
+  EXPECT_EQ(data.get<DATA_REMAINING_STEPS>(), 750u);
+  EXPECT_EQ(std::get<uint32_t>(data.getData(DATA_REMAINING_STEPS)), 750u);
+  EXPECT_EQ(data.get<DATA_PACE>(), 250u);
+  data.write<DATA_HOURS, DATA_MINUTES>(0, 5);
+  EXPECT_EQ(data.get<DATA_PACE>(), 50u);
+  EXPECT_EQ(data.get<DATA_GOAL_PERCENT>(), 25u);
+  data.set<DATA_STEPS>(1500);
+  EXPECT_EQ(data.get<DATA_GOAL_PERCENT>(), 100u);
+  EXPECT_EQ(data.get<DATA_REMAINING_STEPS>(), 0u);
+  EXPECT_EQ(data.getFieldVersion(DATA_GOAL_PERCENT), data.getFieldVersion(DATA_STEPS));
+  EXPECT_EQ(data.getFieldVersion(DATA_PACE), data.getVersion());
+
+  // Derived fields can't be written
+  EXPECT_THROW(data.setData(static_cast<uint32_t>(10), DATA_GOAL_PERCENT), std::invalid_argument);
+  EXPECT_THROW(data.changeValue(DATA_REMAINING_STEPS, SYSTEM_INCREASE_VAL), std::invalid_argument);
+
+  // Snapshot derives the values from its own consistent inputs
+  DataSnapshot snapshot = data.snapshot(dataMask(DATA_REMAINING_STEPS));
+  EXPECT_EQ(snapshot.getFields(), dataMask(DATA_REMAINING_STEPS));
+  EXPECT_EQ(snapshot.get<DATA_REMAINING_STEPS>(), 0u);
+
+  // Observers of derived fields are notified when the inputs change, not when unrelated fields do
+  CountingObserver goal;
+  data.subscribe(DATA_GOAL_PERCENT, &goal);
+  data.set<DATA_SECONDS>(30);
+  EXPECT_EQ(goal.notifications, 0);
+  data.set<DATA_TARGET_STEPS>(3000);
+  EXPECT_EQ(goal.notifications, 1);
+  EXPECT_EQ(goal.lastFields, dataMask(DATA_GOAL_PERCENT));
+  EXPECT_EQ(data.get<DATA_GOAL_PERCENT>(), 50u);
+  data.unsubscribe(DATA_GOAL_PERCENT, &goal);
+}
+
+TEST(SystemDataTest, ConcurrentAccessTest) {
+  enum : uint32_t { INCREMENTS = 20000, THREADS = 2 };
+  SystemData &data = SystemData::GetInstance();
+  data.init();
+  std::atomic<bool> done{false};
+  std::atomic<uint32_t> tornReads{0};
+  std::atomic<uint32_t> consistentReads{0};
+  std::vector<std::thread> threads;
+
+  // Writers keep hours, minutes and seconds equal, a reader seeing different values would have read a torn time
+  for(uint32_t i = 0; i < THREADS; i++) {
+    threads.emplace_back([&, i] {
+      for(uint8_t k = static_cast<uint8_t>(i); !done.load(); k = (k + 1) % (SYSTEM_DATA_SCHEMA[DATA_HOURS].max + 1)) {
+        if(0 == i) {
+          data.write<DATA_HOURS, DATA_MINUTES, DATA_SECONDS>(k, k, k);
+        } else {
+          data.transaction(0).set<DATA_HOURS>(k).set<DATA_MINUTES>(k).set<DATA_SECONDS>(k).commit();
+        }
+      }
+    });
+  }
+  for(uint32_t i = 0; i < THREADS; i++) {
+    threads.emplace_back([&] {
+      uint32_t lastSteps = 0;
+      uint32_t lastRemaining = UINT32_MAX;
+      while(!done.load()) {
+        auto [hours, minutes, seconds] = data.read<DATA_HOURS, DATA_MINUTES, DATA_SECONDS>();
+        DataSnapshot snapshot = data.snapshot();
+        uint32_t steps = data.get<DATA_STEPS>();
+        // Memoized derived value never goes back to an older version
+        uint32_t remaining = data.get<DATA_REMAINING_STEPS>();
+        if(hours != minutes || minutes != seconds || steps < lastSteps || remaining > lastRemaining ||
+           snapshot.get<DATA_HOURS>() != snapshot.get<DATA_SECONDS>()) {
+          tornReads++;
+        } else {
+          consistentReads++;
+        }
+        lastSteps = steps;
+        lastRemaining = remaining;
+      }
+    });
+  }
+
+  // Step increments as they would come from the step detection ISR
+  std::vector<std::thread> incrementers;
+  for(uint32_t i = 0; i < THREADS; i++) {
+    incrementers.emplace_back([&] {
+      for(uint32_t n = 0; n < INCREMENTS; n++) {
+        data.add<DATA_STEPS>(1);
+      }
+    });
+  }
+  for(std::thread &thread : incrementers) {
+    thread.join();
+  }
+  done.store(true);
+  for(std::thread &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(tornReads.load(), 0u);
+  EXPECT_GT(consistentReads.load(), 0u);
+  EXPECT_EQ(data.get<DATA_STEPS>(), THREADS * INCREMENTS);
+  // Memo published by the racing readers matches the value computed from the stored fields
+  EXPECT_EQ(data.get<DATA_PACE>(), data.snapshot().get<DATA_PACE>());
+
+  // The sum saturates at the maximum
+  data.add<DATA_STEPS>(SYSTEM_DATA_SCHEMA[DATA_STEPS].max);
+  EXPECT_EQ(data.get<DATA_STEPS>(), SYSTEM_DATA_SCHEMA[DATA_STEPS].max);
 }
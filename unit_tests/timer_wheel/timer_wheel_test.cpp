@@ -0,0 +1,197 @@
+#include "timer_wheel.hpp"
+#include "timer_wheel_config.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace pedometer;
+
+enum : uint64_t { MS = 1000, SECOND = 1000 * MS, HOUR = 3600 * SECOND, DAY = 24 * HOUR };
+
+// Virtual clock of the tests, the wheel is advanced to every deadline like the esp_timer would do
+class VirtualClock {
+public:
+  TimerWheel wheel;
+  uint64_t nowUs = 0;
+
+  // Moves the clock to the given time through all deadlines on the way, returns the number of fired timers
+  uint32_t runUntil(uint64_t timeUs) {
+    uint32_t fired = 0;
+    while(wheel.getNextDeadlineUs() <= timeUs) {
+      nowUs = std::max(nowUs, wheel.getNextDeadlineUs());
+      fired += wheel.advance(nowUs);
+    }
+    nowUs = timeUs;
+    return fired + wheel.advance(nowUs);
+  }
+};
+
+// Timer recording the times of its expiries
+struct Expiries {
+  VirtualClock *clock;
+  std::vector<uint64_t> timesUs;
+};
+
+static void recordExpiry(void *context) {
+  Expiries &expiries = *static_cast<Expiries *>(context);
+  expiries.timesUs.push_back(expiries.clock->nowUs);
+}
+
+// -------------------------------------------------------------------------------
+// ------------------------- TimerWheel class unit test --------------------------
+// -------------------------------------------------------------------------------
+TEST(TimerWheelTest, OneShotTest) {
+  VirtualClock clock;
+  Expiries expiries{&clock, {}};
+  ScheduledTimer timer(&recordExpiry, &expiries);
+  EXPECT_EQ(clock.wheel.getNextDeadlineUs(), TIMER_WHEEL_NO_DEADLINE);
+
+  // Delay is rounded up to whole ticks, the timer never expires early
+  clock.nowUs = 5 * SECOND + 300;
+  clock.wheel.start(timer, clock.nowUs, 50 * MS);
+  EXPECT_TRUE(timer.isActive());
+  EXPECT_EQ(clock.wheel.getActiveCount(), 1u);
+  EXPECT_EQ(clock.wheel.advance(5 * SECOND + 50 * MS), 0u);
+  EXPECT_EQ(clock.runUntil(6 * SECOND), 1u);
+  EXPECT_EQ(expiries.timesUs, std::vector<uint64_t>{5 * SECOND + 51 * MS});
+  EXPECT_FALSE(timer.isActive());
+  EXPECT_EQ(clock.wheel.getActiveCount(), 0u);
+  EXPECT_EQ(clock.wheel.getNextDeadlineUs(), TIMER_WHEEL_NO_DEADLINE);
+}
+
+TEST(TimerWheelTest, CancelAndRestartTest) {
+  VirtualClock clock;
+  Expiries expiries{&clock, {}};
+  ScheduledTimer first(&recordExpiry, &expiries), second(&recordExpiry, &expiries);
+  clock.wheel.start(first, 0, 10 * MS);
+  clock.wheel.start(second, 0, 10 * MS);
+
+  // Cancelled timer doesn't fire, cancelling twice is ignored
+  clock.wheel.cancel(first);
+  clock.wheel.cancel(first);
+  EXPECT_EQ(clock.wheel.getActiveCount(), 1u);
+
+  // Restart moves an active timer
+  clock.wheel.start(second, 5 * MS, 20 * MS);
+  EXPECT_EQ(clock.wheel.getActiveCount(), 1u);
+  EXPECT_EQ(clock.runUntil(SECOND), 1u);
+  EXPECT_EQ(expiries.timesUs, std::vector<uint64_t>{25 * MS});
+
+  EXPECT_THROW(clock.wheel.start(first, SECOND, (TIMER_WHEEL_MAX_TICKS + 1) * TIMER_WHEEL_TICK_US), std::out_of_range);
+  EXPECT_FALSE(first.isActive());
+}
+
+TEST(TimerWheelTest, PeriodicTest) {
+  VirtualClock clock;
+  Expiries expiries{&clock, {}};
+  ScheduledTimer keyRepeat(&recordExpiry, &expiries);
+  clock.wheel.start(keyRepeat, 0, 300 * MS, 100 * MS);
+  EXPECT_EQ(clock.runUntil(650 * MS), 4u);
+  EXPECT_EQ(expiries.timesUs, (std::vector<uint64_t>{300 * MS, 400 * MS, 500 * MS, 600 * MS}));
+
+  // Missed periods are skipped instead of firing in a burst
+  clock.nowUs = 1050 * MS;
+  EXPECT_EQ(clock.wheel.advance(clock.nowUs), 1u);
+  EXPECT_EQ(clock.runUntil(1200 * MS), 1u);
+  EXPECT_EQ(expiries.timesUs.back(), 1150 * MS);
+
+  // Deadline may come earlier than the expiry when timers move down a level, but never later
+  EXPECT_LE(clock.wheel.getNextDeadlineUs(), 1250 * MS);
+  clock.wheel.cancel(keyRepeat);
+  EXPECT_EQ(clock.runUntil(2 * SECOND), 0u);
+}
+
+TEST(TimerWheelTest, LongDelaysTest) {
+  VirtualClock clock;
+  Expiries expiries{&clock, {}};
+  ScheduledTimer screenOff(&recordExpiry, &expiries), midnight(&recordExpiry, &expiries), week(&recordExpiry, &expiries);
+  clock.nowUs = 123 * MS;
+  clock.wheel.start(screenOff, clock.nowUs, 30 * SECOND);
+  clock.wheel.start(midnight, clock.nowUs, 13 * HOUR + 17 * SECOND);
+  clock.wheel.start(week, clock.nowUs, 7 * DAY);
+
+  // Timers of the higher levels move down and expire at their exact tick
+  EXPECT_EQ(clock.runUntil(8 * DAY), 3u);
+  EXPECT_EQ(expiries.timesUs, (std::vector<uint64_t>{30 * SECOND + 123 * MS, 13 * HOUR + 17 * SECOND + 123 * MS, 7 * DAY + 123 * MS}));
+}
+
+TEST(TimerWheelTest, CallbacksChangeTimersTest) {
+  struct Context {
+    TimerWheel *wheel;
+    ScheduledTimer *other;
+    ScheduledTimer *self;
+    int calls;
+  };
+  TimerWheel wheel;
+  Context context{&wheel, nullptr, nullptr, 0};
+  // Callback cancels the other timer expiring in the same tick and restarts itself at once
+  auto callback = [](void *arg) {
+    Context &ctx = *static_cast<Context *>(arg);
+    ctx.calls++;
+    ctx.wheel->cancel(*ctx.other);
+    ctx.wheel->start(*ctx.self, 10 * MS, 0);
+  };
+  ScheduledTimer first(callback, &context), second(callback, &context);
+  context.self = &first;
+  context.other = &second;
+  wheel.start(first, 0, 10 * MS);
+  wheel.start(second, 0, 10 * MS);
+
+  // Only one of the timers fires, the restarted one waits for the next advance
+  EXPECT_EQ(wheel.advance(10 * MS), 1u);
+  EXPECT_EQ(context.calls, 1);
+  EXPECT_EQ(wheel.getNextDeadlineUs(), 10 * MS);
+  EXPECT_EQ(wheel.getActiveCount(), 1u);
+}
+
+TEST(TimerWheelTest, RandomScheduleTest) {
+  enum : uint32_t { TIMERS = 200, OPERATIONS = 20000 };
+  VirtualClock clock;
+  std::mt19937 random(12345);
+  struct Entry {
+    VirtualClock *clock;
+    uint64_t expiryUs;
+    int fired;
+    bool late;
+  };
+  std::array<Entry, TIMERS> entries;
+  // Timers can't be moved, the deque constructs them in place
+  std::deque<ScheduledTimer> timers;
+  auto onExpiry = [](void *arg) {
+    Entry &entry = *static_cast<Entry *>(arg);
+    entry.fired++;
+    entry.late |= entry.clock->nowUs != entry.expiryUs;
+  };
+  for(uint32_t i = 0; i < TIMERS; i++) {
+    entries[i] = Entry{&clock, 0, 0, false};
+    timers.emplace_back(onExpiry, &entries[i]);
+  }
+
+  // Random starts and cancels with delays from one tick to days, compared with the expected expiries
+  int expected = 0;
+  for(uint32_t n = 0; n < OPERATIONS; n++) {
+    uint32_t i = random() % TIMERS;
+    if(random() % 4 == 0) {
+      expected -= timers[i].isActive() ? 1 : 0;
+      clock.wheel.cancel(timers[i]);
+    } else {
+      uint64_t delayUs = (random() % 2) ? (random() % 5000) * MS : static_cast<uint64_t>(random() % 100000) * SECOND;
+      expected += timers[i].isActive() ? 0 : 1;
+      clock.wheel.start(timers[i], clock.nowUs, delayUs);
+      entries[i].expiryUs = (clock.nowUs + delayUs + TIMER_WHEEL_TICK_US - 1) / TIMER_WHEEL_TICK_US * TIMER_WHEEL_TICK_US;
+    }
+    EXPECT_EQ(clock.wheel.getActiveCount(), static_cast<uint32_t>(expected));
+    expected -= static_cast<int>(clock.runUntil(clock.nowUs + (random() % 2000) * MS));
+  }
+  expected -= static_cast<int>(clock.runUntil(clock.nowUs + 200 * DAY));
+  EXPECT_EQ(expected, 0);
+  EXPECT_EQ(clock.wheel.getActiveCount(), 0u);
+  for(const Entry &entry : entries) {
+    EXPECT_FALSE(entry.late);
+  }
+}